@@ -0,0 +1,46 @@
+# Code size of the url builder, the QueryBuilder path against the
+# stringstream one it replaced. Run by the open_meteo_code_size target:
+#
+#   cmake -DNM=nm -DLEGACY=<objects> -DCURRENT=<objects> -P code_size.cmake
+#
+# Sums the sizes nm reports for the code of each path. The legacy path also
+# links the libstdc++ stream classes, which a static firmware image pays for
+# and these numbers leave out.
+
+# Sum of the symbol sizes of `objects` whose name matches `pattern`.
+function(symbol_bytes objects pattern result)
+  set(total 0)
+  foreach(object ${objects})
+    execute_process(
+      COMMAND ${NM} -S -C --defined-only ${object}
+      OUTPUT_VARIABLE symbols
+      RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+      message(FATAL_ERROR "${NM} failed on ${object}")
+    endif()
+    string(REPLACE "\n" ";" symbols "${symbols}")
+    foreach(line ${symbols})
+      if(line MATCHES "^[0-9a-f]+ ([0-9a-f]+) [TtWw] (.*)$")
+        set(size ${CMAKE_MATCH_1})
+        if(CMAKE_MATCH_2 MATCHES "${pattern}")
+          math(EXPR total "${total} + 0x${size}")
+        endif()
+      endif()
+    endforeach()
+  endforeach()
+  set(${result} ${total} PARENT_SCOPE)
+endfunction()
+
+set(query_objects)
+foreach(object ${CURRENT})
+  if(object MATCHES "/(om_query|open_meteo)\\.cpp\\.o(bj)?$")
+    list(APPEND query_objects ${object})
+  endif()
+endforeach()
+
+symbol_bytes("${LEGACY}" "." legacy)
+symbol_bytes("${query_objects}"
+  "QueryBuilder|paramsToString|timeParams_to_args|OM_SDK::add\\(" current)
+math(EXPR change "${current} - ${legacy}")
+message("url builder code, stringstream: ${legacy} bytes")
+message("url builder code, QueryBuilder: ${current} bytes (${change})")
@@ -0,0 +1,672 @@
+// Host benchmarks of the request building, decoding and accessor paths.
+//
+//   open_meteo_bench [--filter text] [--min-time seconds] [--json file]
+//                    [response.fb ...]
+//
+// Every benchmark reports ns/op, heap allocations/op and allocated bytes/op.
+// Request building runs through the stringstream builder it replaced too.
+// Responses of 1 KB to 1 MB are synthesized with the flatbuffers builders;
+// recorded API responses (raw size-prefixed bodies) given as arguments are
+// verified and decoded too, and mutated copies show what each verification
+// mode catches. Snapshot encoding reports its compression ratio next to the
+// timings. The fetch pool backfills from a local stand-in server, reporting
+// jobs per second for each pool size, and the query planner how many
+// requests and bytes merging saves there. The request budget runs against a
+// simulated server on a simulated clock, so its numbers are exact and
+// repeatable. --json writes the results for comparing library versions.
+#include "om_accessor.hpp"
+#include "om_aggregate.hpp"
+#include "om_budget.hpp"
+#include "om_endpoint.hpp"
+#include "om_fetch_pool.hpp"
+#include "om_internal.hpp"
+#include "om_legacy_query.hpp"
+#include "om_planner.hpp"
+#include "om_query.hpp"
+#include "om_response.hpp"
+#include "om_snapshot.hpp"
+#include "open_meteo.hpp"
+#include "stand_in_server.hpp"
+#include "synthetic_response.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef OPEN_METEO_BENCH_VERSION
+#define OPEN_METEO_BENCH_VERSION "unknown"
+#endif
+
+using namespace OM_SDK;
+
+namespace {
+
+// Fetch pool workers and stand-in servers allocate on their own threads.
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> allocated_bytes{0};
+
+void count_allocation(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Every allocation goes through malloc. glibc lets the executable interpose
+// it; elsewhere only operator new is counted.
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+  count_allocation(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  count_allocation(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  count_allocation(size);
+  return __libc_realloc(ptr, size);
+}
+}
+#else
+#include <new>
+
+void *operator new(size_t size) {
+  count_allocation(size);
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+namespace {
+
+// Keeps the compiler from dropping a result.
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double ns_per_op;
+  double allocs_per_op;
+  double bytes_per_op;
+};
+
+class Runner {
+public:
+  Runner(double min_seconds, const char *filter)
+      : _min_seconds(min_seconds), _filter(filter) {}
+
+  bool selected(const std::string &name) const {
+    return !_filter || name.find(_filter) != std::string::npos;
+  }
+
+  // Runs `body` in doubling batches until one takes min_seconds.
+  template <typename Body> void run(const std::string &name, Body &&body) {
+    if (!selected(name))
+      return;
+    body();
+    uint64_t iterations = 1;
+    while (true) {
+      const size_t allocations_before =
+          allocations.load(std::memory_order_relaxed);
+      const size_t bytes_before =
+          allocated_bytes.load(std::memory_order_relaxed);
+      const auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < iterations; ++i)
+        body();
+      const double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+      if (seconds >= _min_seconds || iterations >= (uint64_t(1) << 40)) {
+        const double allocs =
+            allocations.load(std::memory_order_relaxed) - allocations_before;
+        const double bytes =
+            allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+        Result result = {name, iterations, seconds * 1e9 / iterations,
+                         allocs / iterations, bytes / iterations};
+        printf("%-36s %12.1f ns/op %8.2f allocs/op %10.1f B/op\n",
+               result.name.c_str(), result.ns_per_op, result.allocs_per_op,
+               result.bytes_per_op);
+        _results.push_back(std::move(result));
+        return;
+      }
+      iterations *= 2;
+    }
+  }
+
+  // A measured quantity that is not a timing, e.g. a compression ratio.
+  void report(const std::string &name, double value) {
+    if (!selected(name))
+      return;
+    printf("%-36s %12.3f\n", name.c_str(), value);
+    _metrics.emplace_back(name, value);
+  }
+
+  const std::vector<Result> &results() const { return _results; }
+  const std::vector<std::pair<std::string, double>> &metrics() const {
+    return _metrics;
+  }
+
+private:
+  double _min_seconds;
+  const char *_filter;
+  std::vector<Result> _results;
+  std::vector<std::pair<std::string, double>> _metrics;
+};
+
+bool read_file(const char *path, std::vector<uint8_t> *output) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+  uint8_t chunk[4096];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    output->insert(output->end(), chunk, chunk + read);
+  fclose(file);
+  return !output->empty();
+}
+
+const char *mode_name(VerifyMode mode) {
+  return mode == verify_full     ? "full"
+         : mode == verify_header ? "header"
+                                 : "off";
+}
+
+// Verification of corrupted bodies: how many are caught and at what cost.
+void bench_mutations(Runner *runner, const std::vector<uint8_t> &body) {
+  if (body.size() < 8)
+    return;
+  const std::vector<std::vector<uint8_t>> mutated = mutations(body, 256);
+  for (const VerifyMode mode : {verify_header, verify_full}) {
+    VerifyOptions options;
+    options.mode = mode;
+    size_t rejected = 0;
+    for (const std::vector<uint8_t> &payload : mutated)
+      rejected += !VerifyMessages(payload.data(), payload.size(), options);
+    printf("mutated/%s rejects %zu of %zu\n", mode_name(mode), rejected,
+           mutated.size());
+    runner->run(std::string("verify_mutated/") + mode_name(mode), [&] {
+      for (const std::vector<uint8_t> &payload : mutated) {
+        const bool valid =
+            VerifyMessages(payload.data(), payload.size(), options);
+        keep(valid);
+      }
+    });
+  }
+}
+
+// Snapshots of every variable in the response, then of the next two days
+// every third hour as a display node would get them.
+void bench_snapshot(Runner *runner, const std::string &name,
+                    const WeatherResponse &response) {
+  TimeParamSet all;
+  for (int param = undefined + 1; param < max_params; ++param)
+    all.insert((TimeParam)param);
+  SnapshotSelection full;
+  full.current = full.hourly = full.daily = full.minutely_15 = all;
+  SnapshotSelection display = full;
+  display.minutely_15 = TimeParamSet();
+  display.stride = 3;
+  display.max_steps = 16;
+  std::vector<uint8_t> blob(response.size() + 256);
+  for (const auto &variant : {std::make_pair("full", full),
+                              std::make_pair("display", display)}) {
+    const std::string suffix = name + "/" + variant.first;
+    const size_t size = EncodeSnapshot(response.get(), variant.second,
+                                       blob.data(), blob.size());
+    if (!size)
+      continue;
+    runner->report("snapshot_ratio/" + suffix, double(response.size()) / size);
+    runner->run("snapshot_encode/" + suffix, [&] {
+      const size_t written = EncodeSnapshot(response.get(), variant.second,
+                                            blob.data(), blob.size());
+      keep(written);
+    });
+    runner->run("snapshot_decode/" + suffix, [&] {
+      Snapshot snapshot;
+      const bool decoded = snapshot.decode(blob.data(), size);
+      keep(decoded);
+    });
+  }
+}
+
+void bench_response(Runner *runner, const std::string &name,
+                    const std::vector<uint8_t> &body) {
+  for (const VerifyMode mode : {verify_header, verify_full}) {
+    VerifyOptions options;
+    options.mode = mode;
+    runner->run("verify/" + name + "/" + mode_name(mode), [&] {
+      const bool valid = VerifyMessages(body.data(), body.size(), options);
+      keep(valid);
+    });
+  }
+  // Copy into a fresh buffer and decode, like a request reading the body.
+  runner->run("load/" + name, [&] {
+    WeatherResponse response;
+    if (response.reserve(body.size())) {
+      memcpy(response.tail(), body.data(), body.size());
+      response.commit(body.size());
+    }
+    keep(response.get());
+  });
+  WeatherResponse response;
+  if (!response.reserve(body.size()))
+    return;
+  memcpy(response.tail(), body.data(), body.size());
+  response.commit(body.size());
+  if (!response)
+    return;
+  runner->run("index/" + name, [&] {
+    ResponseIndex index(response.get());
+    keep(index);
+  });
+  bench_snapshot(runner, name, response);
+}
+
+// The walk over variables() an application does without an index.
+const openmeteo_sdk::VariableWithValues *
+find_linear(const openmeteo_sdk::VariablesWithTime *section,
+            const SyntheticSeries &series) {
+  for (const auto *variable : *section->variables()) {
+    if (variable->variable() == series.variable &&
+        variable->altitude() == series.altitude &&
+        variable->aggregation() == openmeteo_sdk::Aggregation_none &&
+        variable->ensemble_member() == 0)
+      return variable;
+  }
+  return nullptr;
+}
+
+// Every hourly variable looked up through the index and by walking
+// variables(). Building the index is timed on its own.
+void bench_lookup(Runner *runner, const WeatherResponse &response) {
+  const ResponseIndex index(response.get());
+  runner->run("lookup/index_build", [&] {
+    const SectionIndex built(response->hourly());
+    keep(built);
+  });
+  runner->run("lookup/values", [&] {
+    for (const SyntheticSeries &series : synthetic_hourly) {
+      const Span<float> values = index.hourly().values(series.param);
+      keep(values);
+    }
+  });
+  runner->run("lookup/linear_walk", [&] {
+    for (const SyntheticSeries &series : synthetic_hourly) {
+      const auto *variable = find_linear(response->hourly(), series);
+      const Span<float> values(variable->values()->data(),
+                               variable->values()->size());
+      keep(values);
+    }
+  });
+  runner->run("lookup/missing", [&] {
+    const Span<float> values = index.hourly().values(uv_index);
+    keep(values);
+  });
+  const auto *variables = response->hourly()->variables();
+  runner->run("lookup/time_param_of", [&] {
+    for (const auto *variable : *variables) {
+      const TimeParam param = TimeParamOf(variable);
+      keep(param);
+    }
+  });
+  runner->run("lookup/time_axis", [&] {
+    int64_t last = 0;
+    for (int64_t time : index.hourly().time())
+      last = time;
+    keep(last);
+  });
+}
+
+void bench_aggregate(Runner *runner, const WeatherResponse &response) {
+  const ResponseIndex index(response.get());
+  const Span<float> values = index.hourly().values(temperature_2m);
+  const std::string size = std::to_string(values.size());
+  std::vector<float> sums(values.size());
+  std::vector<Summary> days(values.size() / 24 + 1);
+  runner->run("aggregate/summarize/" + size, [&] {
+    const Summary summary = Summarize(values);
+    keep(summary);
+  });
+  runner->run("aggregate/summarize_scalar/" + size, [&] {
+    const Summary summary = SummarizeScalar(values.data(), values.size());
+    keep(summary);
+  });
+  runner->run("aggregate/count_above/" + size, [&] {
+    const size_t count = CountAbove(values.data(), values.size(), 8.f);
+    keep(count);
+  });
+  runner->run("aggregate/windows_24/" + size, [&] {
+    const size_t count = SummarizeWindows(values.data(), values.size(), 24,
+                                          days.data(), days.size());
+    keep(count);
+  });
+  runner->run("aggregate/rolling_sum_24/" + size, [&] {
+    const size_t count = RollingSum(values.data(), values.size(), 24,
+                                    sums.data(), sums.size());
+    keep(count);
+  });
+  runner->run("aggregate/crossings/" + size, [&] {
+    const size_t count = Crossings(values.data(), values.size(), 8.f);
+    keep(count);
+  });
+}
+
+void bench_params(Runner *runner) {
+  static char timezone[] = "Europe/Berlin";
+  static openmeteo_sdk::Model models[] = {openmeteo_sdk::Model_icon_d2,
+                                          openmeteo_sdk::Model_undefined};
+  struct Mix {
+    const char *name;
+    OpenMeteoParams params;
+  };
+  Mix mixes[4] = {};
+  mixes[0].name = "minimal";
+  mixes[0].params.latitude = 52.52f;
+  mixes[0].params.longitude = 13.41f;
+
+  mixes[1].name = "hourly";
+  mixes[1].params = mixes[0].params;
+  mixes[1].params.hourly_set = {temperature_2m, relative_humidity_2m,
+                                precipitation, weather_code, wind_speed_10m,
+                                wind_direction_10m};
+
+  mixes[2].name = "all_sections";
+  mixes[2].params = mixes[1].params;
+  mixes[2].params.current_set = {temperature_2m, weather_code, is_day};
+  mixes[2].params.daily_set = {temperature_2m_max, temperature_2m_min,
+                               precipitation_sum, sunrise, sunset};
+  mixes[2].params.minutely_15_set = {precipitation, temperature_2m};
+  mixes[2].params.timezone = timezone;
+  mixes[2].params.temperature_unit = fahrenheit;
+  mixes[2].params.wind_speed_unit = kmh;
+  mixes[2].params.forecast_days = 7;
+  mixes[2].params.past_days = 2;
+
+  mixes[3].name = "date_range";
+  mixes[3].params = mixes[1].params;
+  mixes[3].params.start_date = 1700000000;
+  mixes[3].params.end_date = 1700000000 + 30 * 86400;
+  mixes[3].params.models = models;
+  mixes[3].params.cell_selection = nearest;
+
+  StaticQueryBuilder<CONFIG_OPEN_METEO_MAX_URL_LENGTH> query;
+  for (Mix &mix : mixes) {
+    runner->run(std::string("validate_params/") + mix.name, [&] {
+      OpenMeteoParams params = mix.params;
+      validateParams(&params);
+      keep(params);
+    });
+    validateParams(&mix.params);
+    runner->run(std::string("params_to_string/") + mix.name, [&] {
+      query.clear();
+      const bool fits = paramsToString(&mix.params, &query);
+      keep(fits);
+    });
+    runner->run(std::string("params_to_sstream/") + mix.name, [&] {
+      const std::string url = legacy::paramsToString(&mix.params);
+      keep(url);
+    });
+    query.clear();
+    paramsToString(&mix.params, &query);
+    if (legacy::paramsToString(&mix.params) != query.c_str())
+      fprintf(stderr, "%s: urls differ from the stringstream builder\n",
+              mix.name);
+  }
+}
+
+// A year of hourly archive for 16 sites, 64 jobs, from a stand-in server
+// answering after 20 ms, with pools of 1 to 16 connections.
+void bench_fetch_pool(Runner *runner, const std::vector<uint8_t> &body) {
+  StandInServer server(body, 20);
+  const int port = server.start();
+  if (!port) {
+    fprintf(stderr, "stand-in server did not start\n");
+    return;
+  }
+  const std::string base_url = server.base_url();
+  Location sites[16];
+  for (size_t i = 0; i < 16; ++i)
+    sites[i] = {45.f + i * 0.25f, 7.f + i * 0.25f};
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m, precipitation};
+  params.start_date = 1672574400; // 2023-01-01
+  params.end_date = params.start_date + 364 * 86400;
+  for (const size_t connections : {1, 2, 4, 8, 16}) {
+    const std::string name =
+        "fetch_pool/" + std::to_string(connections) + "/jobs_per_s";
+    if (!runner->selected(name))
+      continue;
+    FetchPoolOptions options;
+    options.connections = connections;
+    options.base_url = base_url.c_str();
+    FetchPool pool(options);
+    const size_t failed =
+        pool.run(archive_endpoint, params, sites, 16, nullptr);
+    const FetchPoolStats &stats = pool.stats();
+    if (failed)
+      printf("fetch_pool/%zu: %zu of %zu jobs failed\n", connections, failed,
+             stats.jobs);
+    const double seconds = std::max<int64_t>(stats.elapsed_us, 1) / 1e6;
+    runner->report(name, stats.jobs / seconds);
+  }
+}
+
+// 2000 calls against a simulated server allowing 600 per clock minute and
+// answering 429 with Retry-After past that, on a simulated clock, without
+// and with a budget at the server's limit. A full bucket plus its refill
+// still overshoots the first window, the Retry-After then lines the two up.
+void bench_budget(Runner *runner) {
+  for (const bool budgeted : {false, true}) {
+    const std::string name =
+        std::string("budget/") + (budgeted ? "600_per_min/" : "none/");
+    if (!runner->selected(name))
+      continue;
+    int64_t now_ms = 0;
+    BudgetLimits limits;
+    limits.per_hour = limits.per_day = 1e6f;
+    limits.max_wait_ms = 3600000;
+    RequestBudget budget(
+        limits, [&now_ms] { return now_ms; },
+        [&now_ms](int64_t ms) { now_ms += ms; });
+    int64_t window = 0;
+    size_t served = 0;
+    size_t throttled = 0;
+    for (size_t i = 0; i < 2000; ++i) {
+      if (budgeted && !budget.acquire(1.f))
+        break;
+      if (now_ms / 60000 != window) {
+        window = now_ms / 60000;
+        served = 0;
+      }
+      if (served < 600) {
+        ++served;
+        budget.on_response(200);
+      } else {
+        ++throttled;
+        budget.on_response(429, (60000 - now_ms % 60000 + 999) / 1000);
+      }
+      now_ms += 50; // Time the request took.
+    }
+    runner->report(name + "simulated_s", now_ms / 1e3);
+    runner->report(name + "throttled", throttled);
+  }
+
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m, precipitation};
+  params.start_date = 1672574400; // 2023-01-01
+  params.end_date = params.start_date + 364 * 86400;
+  runner->report("budget/weight/archive_year",
+                 QueryWeight(archive_endpoint, params));
+
+  BudgetLimits unlimited;
+  unlimited.per_minute = unlimited.per_hour = unlimited.per_day = 1e30f;
+  RequestBudget budget(unlimited);
+  runner->run("budget/try_acquire", [&] { keep(budget.try_acquire(1.f)); });
+}
+
+// Three subsystems asking for different variables and days at each of 8
+// sites, planned together and fetched from a stand-in server.
+void bench_planner(Runner *runner, const std::vector<uint8_t> &body) {
+  if (!runner->selected("planner/"))
+    return;
+  StandInServer server(body, 0);
+  const int port = server.start();
+  if (!port) {
+    fprintf(stderr, "stand-in server did not start\n");
+    return;
+  }
+  const std::string base_url = server.base_url();
+  Client client;
+  client.set_base_url(base_url.c_str());
+  QueryPlanner planner(&client);
+  size_t views = 0;
+  const ViewCallback count = [&views](int status_code,
+                                      const ResponseView &view) {
+    views += status_code == 200 && view;
+  };
+  for (size_t site = 0; site < 8; ++site) {
+    OpenMeteoParams display = {};
+    display.latitude = 45.f + site * 0.25f;
+    display.longitude = 7.f + site * 0.25f;
+    display.hourly_set = {temperature_2m, weather_code};
+    display.forecast_days = 2;
+    OpenMeteoParams irrigation = display;
+    irrigation.hourly_set = {precipitation, rain};
+    irrigation.past_days = 2;
+    irrigation.forecast_days = 3;
+    OpenMeteoParams comfort = display;
+    comfort.hourly_set = {temperature_2m, relative_humidity_2m};
+    comfort.forecast_days = 1;
+    planner.submit(display, count);
+    planner.submit(irrigation, count);
+    planner.submit(comfort, count);
+  }
+  planner.flush();
+  const PlannerStats stats = planner.stats();
+  if (views != stats.queries)
+    printf("planner: %zu of %zu queries failed\n", stats.queries - views,
+           stats.queries);
+  runner->report("planner/round_trips", stats.round_trips);
+  runner->report("planner/round_trips_saved", stats.round_trips_saved);
+  runner->report("planner/bytes_fetched", stats.bytes_fetched);
+  runner->report("planner/bytes_saved", stats.bytes_saved);
+}
+
+void write_json(const char *path, const Runner &runner) {
+  const std::vector<Result> &results = runner.results();
+  const std::vector<std::pair<std::string, double>> &metrics =
+      runner.metrics();
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return;
+  }
+  fprintf(file, "{\n  \"version\": \"%s\",\n  \"aggregate_backend\": \"%s\",\n",
+          OPEN_METEO_BENCH_VERSION, AggregateBackend());
+  fprintf(file, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &result = results[i];
+    fprintf(file,
+            "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, "
+            "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f}%s\n",
+            result.name.c_str(), (unsigned long long)result.iterations,
+            result.ns_per_op, result.allocs_per_op, result.bytes_per_op,
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(file, "  ],\n  \"metrics\": [\n");
+  for (size_t i = 0; i < metrics.size(); ++i)
+    fprintf(file, "    {\"name\": \"%s\", \"value\": %.4f}%s\n",
+            metrics[i].first.c_str(), metrics[i].second,
+            i + 1 < metrics.size() ? "," : "");
+  fprintf(file, "  ]\n}\n");
+  fclose(file);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  const char *json = nullptr;
+  double min_seconds = 0.2;
+  std::vector<const char *> files;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "--json") && i + 1 < argc)
+      json = argv[++i];
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+      min_seconds = atof(argv[++i]);
+    else
+      files.push_back(argv[i]);
+  }
+
+  Runner runner(min_seconds, filter);
+  printf("open_meteo_bench %s, aggregation: %s\n", OPEN_METEO_BENCH_VERSION,
+         AggregateBackend());
+  bench_params(&runner);
+  bench_budget(&runner);
+
+  const struct {
+    const char *name;
+    size_t bytes;
+  } sizes[] = {{"1k", 1 << 10},
+               {"16k", 16 << 10},
+               {"128k", 128 << 10},
+               {"1m", 1 << 20}};
+  std::vector<uint8_t> largest;
+  for (const auto &size : sizes) {
+    std::vector<uint8_t> body = synthetic_response(size.bytes);
+    bench_response(&runner, size.name, body);
+    if (size.bytes == (16 << 10)) {
+      bench_mutations(&runner, body);
+      bench_fetch_pool(&runner, body);
+      bench_planner(&runner, body);
+    }
+    largest = std::move(body);
+  }
+  for (const char *path : files) {
+    std::vector<uint8_t> body;
+    if (!read_file(path, &body)) {
+      fprintf(stderr, "cannot read %s\n", path);
+      return 1;
+    }
+    const char *name = strrchr(path, '/');
+    bench_response(&runner, std::string("file:") + (name ? name + 1 : path),
+                   body);
+  }
+
+  WeatherResponse response;
+  if (!response.reserve(largest.size()))
+    return 1;
+  memcpy(response.tail(), largest.data(), largest.size());
+  response.commit(largest.size());
+  if (!response) {
+    fprintf(stderr, "synthetic response does not decode\n");
+    return 1;
+  }
+  bench_lookup(&runner, response);
+  bench_aggregate(&runner, response);
+
+  if (json)
+    write_json(json, runner);
+  return 0;
+}
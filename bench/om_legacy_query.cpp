@@ -0,0 +1,112 @@
+#include "om_legacy_query.hpp"
+#include <cstring>
+#include <sdkconfig.h>
+#include <sstream>
+
+namespace OM_SDK {
+namespace legacy {
+
+namespace {
+
+std::string add(time_t value, const char *name, const char *format) {
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  char strftime_buf[17] = {0};
+  strftime(strftime_buf, sizeof(strftime_buf), format, &timeinfo);
+  std::stringstream ss;
+  if (value != 0)
+    ss << "&" << name << "=" << strftime_buf;
+  return ss.str();
+}
+
+std::string add(int8_t value, const char *name) {
+  std::stringstream ss;
+  if (value > 0)
+    ss << "&" << name << "=" << (int)value;
+  return ss.str();
+}
+
+std::string timeParamstoString(const TimeParamSet &params) {
+  std::stringstream ss;
+  const char *separator = "";
+  params.for_each([&](TimeParam param) {
+    ss << separator << EnumNamesTimeParams()[param];
+    separator = ",";
+  });
+  return ss.str();
+}
+
+std::string timeParams_to_args(const TimeParamSet &params, const char *str) {
+  std::stringstream ss;
+  std::string value = timeParamstoString(params);
+  if (value.empty())
+    return "";
+  ss << str << value;
+  return ss.str();
+}
+
+} // namespace
+
+std::string paramsToString(const OpenMeteoParams *p) {
+  std::stringstream ss;
+  ss << "?latitude=" << p->latitude << "&longitude=" << p->longitude
+     << "&format=flatbuffers";
+  if (strcmp(CONFIG_OPEN_METEO_API_KEY, "")) {
+    ss << ",apikey=" CONFIG_OPEN_METEO_API_KEY;
+  }
+  bool force_timezone_to_auto = false;
+  if (!p->elevation_default)
+    ss << "&elevation=" << p->elevation;
+  ss << timeParams_to_args(p->hourly_set, "&hourly=")
+     << timeParams_to_args(p->minutely_15_set, "&minutely_15=")
+     << timeParams_to_args(p->current_set, "&current=");
+  if (!p->daily_set.empty()) {
+    ss << timeParams_to_args(p->daily_set, "&daily=");
+    force_timezone_to_auto = true;
+  }
+  if (p->temperature_unit != undefined_tmp_unit)
+    ss << "&temperature_unit="
+       << EnumNamesTemperatureUnit()[p->temperature_unit];
+  if (p->wind_speed_unit != undefined_wind_unit)
+    ss << "&wind_speed_unit=" << EnumNamesWindSpeedUnit()[p->wind_speed_unit];
+  if (p->precipitation_unit != undefined_precipitation_unit)
+    ss << "&precipitation_unit="
+       << EnumNamesPrecipitationUnit()[p->precipitation_unit];
+  if (p->timeformat != undefined_timeformat)
+    ss << "&timeformat=" << EnumNamesTimeFormat()[p->timeformat];
+  if (force_timezone_to_auto) {
+    ss << "&timezone=auto";
+  } else if (p->timezone) {
+    ss << "&timezone=" << p->timezone;
+  }
+
+  ss << add(p->past_days, "past_days") << add(p->forecast_days, "forecast_days")
+     << add(p->forecast_hours, "forecast_hours")
+     << add(p->forecast_minutely_15, "forecast_minutely_15")
+     << add(p->past_hours, "past_hours")
+     << add(p->past_minutely_15, "pas_minutely_15")
+     << add(p->start_date, "start_date", "%F")
+     << add(p->end_date, "end_date", "%F")
+     << add(p->start_hour, "start_hour", "%FT%T")
+     << add(p->end_hour, "end_hour", "%FT%T")
+     << add(p->start_minutely_15, "start_minutely_15", "%FT%T")
+     << add(p->end_minutely_15, "end_minutely_15", "%FT%T");
+  if (p->models) {
+    openmeteo_sdk::Model *models = p->models;
+    ss << "&model=";
+    if (*models != openmeteo_sdk::Model_undefined) {
+      ss << EnumNameModel(*models);
+      models++;
+    }
+    while (*models != openmeteo_sdk::Model_undefined) {
+      ss << "," << EnumNameModel(*models);
+      models++;
+    }
+  }
+  if (p->cell_selection != undefined_selection)
+    ss << "&cell_selection=" << EnumNamesCellSelection()[p->cell_selection];
+  return ss.str();
+}
+
+} // namespace legacy
+} // namespace OM_SDK
@@ -0,0 +1,14 @@
+#pragma once
+#include "open_meteo.hpp"
+#include <string>
+
+namespace OM_SDK {
+namespace legacy {
+
+// The stringstream url builder the QueryBuilder replaced, kept to compare
+// allocations and code size against. Reads the TimeParamSet selections, the
+// rest is unchanged.
+std::string paramsToString(const OpenMeteoParams *p);
+
+} // namespace legacy
+} // namespace OM_SDK
@@ -0,0 +1,35 @@
+#pragma once
+// Heap capability allocation on the plain C heap, for host builds.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+
+static inline void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) {
+  (void)caps;
+  return realloc(ptr, size);
+}
+
+// Free bytes inside the heap arena, 0 where the C library cannot tell.
+static inline size_t heap_caps_get_free_size(uint32_t caps) {
+  (void)caps;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().fordblks;
+#else
+  return 0;
+#endif
+}
+
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
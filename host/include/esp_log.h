@@ -0,0 +1,12 @@
+#pragma once
+// ESP-IDF logging macros on stderr, for host builds.
+#include <esp_err.h>
+#include <stdio.h>
+
+#define OM_HOST_LOG(level, tag, format, ...)                                   \
+  fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) OM_HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) OM_HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) OM_HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) OM_HOST_LOG("D", tag, format, ##__VA_ARGS__)
@@ -0,0 +1,19 @@
+#pragma once
+// Kconfig defaults for host builds, override them with -D.
+
+#ifndef CONFIG_OPEN_METEO_API_KEY
+#define CONFIG_OPEN_METEO_API_KEY ""
+#endif
+
+#ifndef CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE
+#define CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE 131072
+#endif
+
+#ifndef CONFIG_OPEN_METEO_MAX_URL_LENGTH
+#define CONFIG_OPEN_METEO_MAX_URL_LENGTH 1024
+#endif
+
+// Responses are fully verified unless CONFIG_OPEN_METEO_VERIFY_HEADER or
+// CONFIG_OPEN_METEO_VERIFY_OFF is defined.
+
+// CONFIG_OPEN_METEO_INSTRUMENTATION is off unless defined.
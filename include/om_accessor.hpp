@@ -0,0 +1,171 @@
+#pragma once
+#include "open_meteo.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <weather_api_generated.h>
+
+namespace OM_SDK {
+
+// Read-only view over contiguous values owned by a response buffer.
+template <typename T> class Span {
+public:
+  Span() = default;
+  Span(const T *data, size_t size) : _data(data), _size(size) {}
+
+  const T *data() const { return _data; }
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+  const T &operator[](size_t index) const { return _data[index]; }
+  const T *begin() const { return _data; }
+  const T *end() const { return _data + _size; }
+
+private:
+  const T *_data{nullptr};
+  size_t _size{0};
+};
+
+// Timestamps of a VariablesWithTime section: time() up to, but excluding,
+// time_end() every interval() seconds. A section without interval, like
+// current, has a single timestamp.
+class TimeAxis {
+public:
+  class iterator {
+  public:
+    iterator(const TimeAxis *axis, size_t index)
+        : _axis(axis), _index(index) {}
+    int64_t operator*() const { return (*_axis)[_index]; }
+    iterator &operator++() {
+      ++_index;
+      return *this;
+    }
+    bool operator!=(const iterator &other) const {
+      return _index != other._index;
+    }
+
+  private:
+    const TimeAxis *_axis;
+    size_t _index;
+  };
+
+  TimeAxis() = default;
+  explicit TimeAxis(const openmeteo_sdk::VariablesWithTime *section);
+  TimeAxis(int64_t start, int32_t interval, size_t size)
+      : _start(start), _interval(interval), _size(size) {}
+
+  size_t size() const { return _size; }
+  int64_t operator[](size_t index) const {
+    return _start + (int64_t)index * _interval;
+  }
+  int32_t interval() const { return _interval; }
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, _size); }
+
+private:
+  int64_t _start{0};
+  int32_t _interval{0};
+  size_t _size{0};
+};
+
+// Maps the TimeParams of one section to their VariableWithValues, built once
+// per response. Lookups are an array access and the spans point into the
+// response, which must outlive the index. Ensemble members other than 0
+// are kept sorted aside and found by binary search.
+class SectionIndex {
+public:
+  SectionIndex() = default;
+  explicit SectionIndex(const openmeteo_sdk::VariablesWithTime *section) {
+    build(section);
+  }
+
+  void build(const openmeteo_sdk::VariablesWithTime *section);
+
+  // nullptr if the section does not hold the param for that member.
+  const openmeteo_sdk::VariableWithValues *find(TimeParam param,
+                                                int member = 0) const {
+    if (param >= max_params)
+      return nullptr;
+    return member ? find_member(param, member) : _variables[param];
+  }
+  Span<float> values(TimeParam param, int member = 0) const;
+  Span<int64_t> values_int64(TimeParam param, int member = 0) const;
+  // Single value of the current section, or `fallback`.
+  float value(TimeParam param, float fallback = 0.f) const;
+  TimeAxis time() const { return TimeAxis(_section); }
+  const openmeteo_sdk::VariablesWithTime *section() const { return _section; }
+
+private:
+  struct Member {
+    TimeParam param;
+    int member;
+    const openmeteo_sdk::VariableWithValues *variable;
+  };
+
+  const openmeteo_sdk::VariableWithValues *find_member(TimeParam param,
+                                                       int member) const;
+
+  const openmeteo_sdk::VariablesWithTime *_section{nullptr};
+  const openmeteo_sdk::VariableWithValues *_variables[max_params]{};
+  std::vector<Member> _members;
+};
+
+// Part of a section: some of its TimeParams, over `count` entries of its
+// time axis from `first`. Points into the index, which must outlive it.
+class SectionView {
+public:
+  SectionView() = default;
+  SectionView(const SectionIndex *index, const TimeParamSet &params,
+              size_t first = 0,
+              size_t count = std::numeric_limits<size_t>::max())
+      : _index(index), _params(params), _first(first), _count(count) {}
+
+  // nullptr if the section does not hold the param or the view leaves it out.
+  const openmeteo_sdk::VariableWithValues *find(TimeParam param) const {
+    return _index && _params.contains(param) ? _index->find(param) : nullptr;
+  }
+  Span<float> values(TimeParam param) const;
+  Span<int64_t> values_int64(TimeParam param) const;
+  float value(TimeParam param, float fallback = 0.f) const;
+  TimeAxis time() const;
+  const TimeParamSet &params() const { return _params; }
+
+private:
+  template <typename T> Span<T> window(Span<T> values) const {
+    const size_t first = _first < values.size() ? _first : values.size();
+    const size_t count =
+        _count < values.size() - first ? _count : values.size() - first;
+    return Span<T>(values.data() + first, count);
+  }
+
+  const SectionIndex *_index{nullptr};
+  TimeParamSet _params;
+  size_t _first{0};
+  size_t _count{0};
+};
+
+class ResponseIndex {
+public:
+  ResponseIndex() = default;
+  explicit ResponseIndex(const openmeteo_sdk::WeatherApiResponse *response) {
+    build(response);
+  }
+
+  void build(const openmeteo_sdk::WeatherApiResponse *response);
+
+  const SectionIndex &current() const { return _current; }
+  const SectionIndex &hourly() const { return _hourly; }
+  const SectionIndex &daily() const { return _daily; }
+  const SectionIndex &minutely_15() const { return _minutely_15; }
+
+private:
+  SectionIndex _current;
+  SectionIndex _hourly;
+  SectionIndex _daily;
+  SectionIndex _minutely_15;
+};
+
+// The TimeParam a variable of a response answers, undefined if none.
+TimeParam TimeParamOf(const openmeteo_sdk::VariableWithValues *variable);
+
+} // namespace OM_SDK
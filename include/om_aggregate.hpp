@@ -0,0 +1,51 @@
+#pragma once
+#include "om_accessor.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace OM_SDK {
+
+// NaN-aware summary of a value array, missing values (NaN) are skipped.
+struct Summary {
+  size_t count{0};
+  float min{0.f};
+  float max{0.f};
+  float sum{0.f};
+
+  float mean() const { return count ? sum / count : 0.f; }
+};
+
+// The kernels use SSE2 or AVX2 when the target enables them and a portable
+// scalar loop otherwise. Both accumulate in 8 lanes combined in the same
+// order, so every path returns bit-identical results. The *_scalar variants
+// always take the portable path.
+const char *AggregateBackend();
+
+Summary Summarize(const float *values, size_t count);
+Summary SummarizeScalar(const float *values, size_t count);
+inline Summary Summarize(Span<float> values) {
+  return Summarize(values.data(), values.size());
+}
+
+// Values strictly above / below threshold, e.g. frost hours.
+size_t CountAbove(const float *values, size_t count, float threshold);
+size_t CountBelow(const float *values, size_t count, float threshold);
+size_t CountAboveScalar(const float *values, size_t count, float threshold);
+size_t CountBelowScalar(const float *values, size_t count, float threshold);
+
+// One summary per `window` consecutive values (24 turns hourly into daily),
+// the last window may be partial. Returns the number of summaries written.
+size_t SummarizeWindows(const float *values, size_t count, size_t window,
+                        Summary *output, size_t max);
+
+// output[i] is the sum of values[i .. i + window), NaN counting as 0, in
+// one pass over the values. Returns the number of sums written, at most
+// `max`.
+size_t RollingSum(const float *values, size_t count, size_t window,
+                  float *output, size_t max);
+
+// How often consecutive values, NaN skipped, move from one side of
+// threshold to the other.
+size_t Crossings(const float *values, size_t count, float threshold);
+
+} // namespace OM_SDK
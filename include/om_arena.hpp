@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace OM_SDK {
+
+// Fixed block of memory response bodies are carved from instead of the heap,
+// so requests do not fragment the heap. Each allocation starts with a small
+// header holding its size and that of the block before it. Releasing is
+// O(1): the block merges with free neighbours, and a hole at the end goes
+// back to the top. Allocating bumps the top, O(1), unless holes are left;
+// then they are reused first fit, a walk over the blocks. Responses kept
+// around, e.g. by a ForecastCache, hold only their own space, but holes
+// between them can be too small for the next response. The newest block
+// grows in place; an older one grows into a free neighbour or moves.
+class ResponseArena {
+public:
+  // `buffer` must outlive the arena and every response allocated from it.
+  ResponseArena(void *buffer, size_t capacity);
+  // Allocates the block once, in PSRAM with OPEN_METEO_RESPONSE_IN_PSRAM.
+  explicit ResponseArena(size_t capacity);
+  ~ResponseArena();
+  ResponseArena(const ResponseArena &) = delete;
+  ResponseArena &operator=(const ResponseArena &) = delete;
+
+  size_t capacity() const { return _capacity; }
+  // Bytes held by live responses, headers included.
+  size_t used() const;
+  // Highest used() since construction or the last reset_peak().
+  size_t peak() const;
+  size_t live() const;
+  // Largest response that can be allocated now.
+  size_t largest_free() const;
+  void reset_peak();
+
+private:
+  friend class WeatherResponse;
+
+  struct Header {
+    // Of the whole block and of the one before it, headers included.
+    size_t size;
+    size_t previous;
+    bool live;
+  };
+  // Bodies after the header stay 8 byte aligned.
+  static constexpr size_t HEADER = (sizeof(Header) + 7) & ~size_t(7);
+
+  // Moves or grows `block` to `capacity` bytes, nullptr when full.
+  uint8_t *grow(uint8_t *block, size_t size, size_t capacity);
+  void release(uint8_t *block);
+  // With _mutex held. Blocks tile _base to _top in address order.
+  Header *header(size_t offset) const;
+  size_t take(size_t bytes);
+  void give(size_t offset);
+  // Records the size of the block at `offset` in the one after it.
+  void link(size_t offset);
+
+  static const size_t NONE = SIZE_MAX;
+
+  uint8_t *_buffer;
+  const size_t _capacity;
+  const bool _owned;
+  mutable std::mutex _mutex;
+  size_t _base{0};
+  size_t _top{0};
+  // Size of the block ending at _top.
+  size_t _last{0};
+  // Free blocks below _top.
+  size_t _holes{0};
+  size_t _used{0};
+  size_t _peak{0};
+  size_t _live{0};
+};
+
+// Heap and arena usage around the last request of a Client. The url is
+// built in a fixed buffer of the Client, not in the arena; esp_http_client
+// allocates its own header buffers on the heap, which heap_low includes.
+struct RequestMemory {
+  size_t heap_free_before{0};
+  size_t heap_free_after{0};
+  // Lowest free heap seen while the request ran, sampled around the body
+  // reads: the request's heap high-water mark.
+  size_t heap_low{0};
+  size_t largest_free_block{0};
+  size_t arena_used{0};
+  size_t arena_peak{0};
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,76 @@
+#pragma once
+#include "om_client.hpp"
+#include "open_meteo.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace OM_SDK {
+
+// Status passed to the callback of a request that never reached the server.
+typedef enum AsyncStatus : int {
+  status_cancelled = -2,
+  status_timeout = -3,
+} AsyncStatus;
+
+typedef std::function<void(int status_code, SharedResponse response)>
+    WeatherCallback;
+
+typedef uint32_t RequestId;
+
+// Runs get_weather on a worker thread, one request at a time in submission
+// order. The worker owns `client` while the AsyncClient lives. Arrays
+// referenced by the submitted params (hourly, daily, timezone, models...)
+// must stay valid until the callback ran.
+//
+// Callbacks run on the worker thread, except for requests cancelled before
+// they started: cancel() and the destructor call those on their own thread,
+// so they must not hold a lock the callback takes.
+class AsyncClient {
+public:
+  explicit AsyncClient(Client *client, size_t stack_size = 8192);
+  // Waits for the request in flight, which reports status_cancelled, then
+  // completes the queued ones with status_cancelled on this thread.
+  ~AsyncClient();
+  AsyncClient(const AsyncClient &) = delete;
+  AsyncClient &operator=(const AsyncClient &) = delete;
+
+  // timeout_ms counts from submission, 0 for none. A request that is still
+  // running at its deadline reports status_timeout, whatever it got back.
+  RequestId submit(const OpenMeteoParams &params, WeatherCallback callback,
+                   uint32_t timeout_ms = 0);
+  // A queued request is completed with status_cancelled on this thread. A
+  // request already on the network completes on the worker, but reports
+  // status_cancelled and drops its result.
+  bool cancel(RequestId id);
+  size_t pending() const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  struct Job {
+    RequestId id;
+    OpenMeteoParams params;
+    WeatherCallback callback;
+    Clock::time_point deadline;
+    bool has_deadline;
+  };
+
+  void run();
+
+  Client *_client;
+  const int _base_timeout_ms;
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<Job> _queue;
+  RequestId _next_id{1};
+  RequestId _current{0};
+  bool _current_cancelled{false};
+  bool _stop{false};
+  std::thread _worker;
+};
+
+} // namespace OM_SDK
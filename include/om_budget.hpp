@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+
+namespace OM_SDK {
+
+struct Endpoint;
+struct OpenMeteoParams;
+
+// Returned by requests the budget did not let through; nothing was sent.
+typedef enum BudgetStatus : int {
+  status_over_budget = -4,
+} BudgetStatus;
+
+// API calls a query counts as: one per location, times the number of
+// variables over 10 and the days covered over 14 when above.
+float QueryWeight(const Endpoint &endpoint, const OpenMeteoParams &params,
+                  size_t locations = 1);
+
+struct BudgetLimits {
+  // Calls per minute, hour and day, the free tier by default.
+  float per_minute{600.f};
+  float per_hour{5000.f};
+  float per_day{10000.f};
+  // low() once a window has less than this share of its calls left.
+  float low_fraction{0.1f};
+  // Longest a request waits for calls to come back before it fails.
+  uint32_t max_wait_ms{2000};
+  // Pause after a 429 without Retry-After, doubled for each further one
+  // in a row, with up to half of it taken off at random.
+  uint32_t backoff_ms{1000};
+  uint32_t max_backoff_ms{300000};
+};
+
+// Token buckets for the per minute, hour and day limits of the API, shared
+// by every client talking to it. Thread safe. The clock and sleep can be
+// replaced to run it on simulated time.
+class RequestBudget {
+public:
+  typedef std::function<int64_t()> NowMs;
+  typedef std::function<void(int64_t ms)> SleepMs;
+
+  struct Stats {
+    size_t admitted;
+    size_t waited;
+    size_t rejected;
+    size_t throttled;
+    double weight;
+  };
+
+  explicit RequestBudget(const BudgetLimits &limits = BudgetLimits(),
+                         NowMs now = nullptr, SleepMs sleep = nullptr,
+                         uint32_t seed = 1);
+  RequestBudget(const RequestBudget &) = delete;
+  RequestBudget &operator=(const RequestBudget &) = delete;
+
+  // Takes `weight` calls, sleeping up to max_wait_ms for them. False,
+  // taking nothing, when they are not back by then.
+  bool acquire(float weight);
+  // Same without sleeping, *wait_ms is when to try again.
+  bool try_acquire(float weight, int64_t *wait_ms = nullptr);
+  // Result of a request sent after acquire(). A 429 holds every request
+  // back for Retry-After seconds or the backoff, whichever is longer.
+  void on_response(int status_code, uint32_t retry_after_s = 0);
+  // Some window is nearly used up: serve stale data rather than fetch.
+  bool low();
+  // Milliseconds requests are still held back after a 429.
+  int64_t backoff_remaining();
+  Stats stats() const;
+
+private:
+  // Double: a day's refill per millisecond is below the float resolution
+  // of a full bucket.
+  struct Bucket {
+    double capacity;
+    double tokens;
+    double per_ms;
+  };
+
+  // With _mutex held.
+  void refill(int64_t now);
+
+  const BudgetLimits _limits;
+  NowMs _now;
+  SleepMs _sleep;
+  mutable std::mutex _mutex;
+  Bucket _buckets[3];
+  int64_t _last_ms{0};
+  int64_t _blocked_until{0};
+  uint32_t _failures{0};
+  std::minstd_rand _random;
+  Stats _stats{};
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,81 @@
+#pragma once
+#include "om_response.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace OM_SDK {
+
+struct CacheStats {
+  size_t hits{0};
+  size_t misses{0};
+  size_t evictions{0};
+  size_t expirations{0};
+  size_t entries{0};
+  size_t bytes{0};
+};
+
+// HTTP validators of a cached response, sent back on revalidation.
+struct Validators {
+  char etag[64];
+  char last_modified[32];
+
+  bool empty() const { return !etag[0] && !last_modified[0]; }
+};
+
+// 64-bit FNV-1a of a canonical request url, used as cache key.
+uint64_t hash_query(const char *query);
+
+// Fetch time plus the update interval of the response's model, or plus
+// `ttl_seconds` when the interval is unknown.
+time_t response_expiry(const WeatherResponse &response, time_t now,
+                       uint32_t ttl_seconds);
+
+// Bounded LRU cache of responses, shared between clients and tasks. Entries
+// expire with the update cadence of the model that produced them, or after
+// `ttl_seconds` when the cadence is unknown. Expired entries with validators
+// are kept for revalidation until the budget needs their space.
+class ForecastCache {
+public:
+  ForecastCache(size_t byte_budget, uint32_t ttl_seconds);
+  ForecastCache(const ForecastCache &) = delete;
+  ForecastCache &operator=(const ForecastCache &) = delete;
+
+  // nullptr on miss. A hit shares the cached buffer, it is not copied.
+  SharedResponse find(uint64_t key, time_t now);
+  void insert(uint64_t key, SharedResponse response, time_t now,
+              const Validators *validators = nullptr);
+  // Expired entry kept for revalidation, with its validators.
+  SharedResponse find_stale(uint64_t key, Validators *validators);
+  // Restarts the expiry of an entry the server reported as not modified.
+  bool refresh(uint64_t key, time_t now);
+  void erase(uint64_t key);
+  void clear();
+
+  CacheStats stats() const;
+
+private:
+  struct Entry {
+    uint64_t key;
+    SharedResponse response;
+    time_t expires;
+    size_t bytes;
+    Validators validators;
+    // Counted in the expirations, until refreshed or replaced.
+    bool expired;
+  };
+
+  void evict(std::list<Entry>::iterator entry);
+
+  const size_t _byte_budget;
+  const uint32_t _ttl_seconds;
+  mutable std::mutex _mutex;
+  std::list<Entry> _lru;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> _index;
+  CacheStats _stats;
+};
+
+} // namespace OM_SDK
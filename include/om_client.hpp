@@ -0,0 +1,149 @@
+#pragma once
+#include "om_arena.hpp"
+#include "om_budget.hpp"
+#include "om_cache.hpp"
+#include "om_coalesce.hpp"
+#include "om_query.hpp"
+#include "om_response.hpp"
+#include "om_store.hpp"
+#include "om_trace.hpp"
+#include "om_transport.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sdkconfig.h>
+
+namespace OM_SDK {
+
+struct DateRange;
+struct Endpoint;
+struct Location;
+struct OpenMeteoParams;
+
+// Keeps one HTTPS connection (and TLS session) to the API alive across
+// requests. Not thread safe: use one Client per task.
+class Client : private TransportListener {
+public:
+  Client() = default;
+  // Requests go through `transport` instead of DefaultTransport().
+  explicit Client(Transport *transport) : _transport(transport) {}
+  ~Client() override;
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  // The get_weather calls request forecast_endpoint.
+  int get_weather(OpenMeteoParams *params, WeatherResponse *output);
+  // Served from the cache, then the store, when set and holding a fresh
+  // response. Fetched responses are written to both. With a coalescer,
+  // identical requests in flight on other clients share one fetch.
+  int get_weather(OpenMeteoParams *params, SharedResponse *output);
+  int https_with_hostname_params(const char *path,
+                                 const OpenMeteoParams *params,
+                                 WeatherResponse *output);
+  int get_weather_batch(OpenMeteoParams *params, const Location *locations,
+                        size_t count, WeatherBatch *output);
+  // Same as above for any endpoint. A start_date to end_date range longer
+  // than endpoint.range_days_max is fetched in chunks, merged into one
+  // response; batches are not split.
+  int get(const Endpoint &endpoint, OpenMeteoParams *params,
+          WeatherResponse *output);
+  int get(const Endpoint &endpoint, OpenMeteoParams *params,
+          SharedResponse *output);
+  int get_batch(const Endpoint &endpoint, OpenMeteoParams *params,
+                const Location *locations, size_t count,
+                WeatherBatch *output);
+  void set_timeout_ms(int timeout_ms);
+  // Scheme and host requests are sent to, the public API by default. The
+  // host transport speaks plain http only and fails requests to https ones,
+  // so host builds set it.
+  void set_base_url(const char *base_url) { _base_url = base_url; }
+  int timeout_ms() const { return _timeout_ms; }
+  void set_cache(ForecastCache *cache) { _cache = cache; }
+  void set_store(ForecastStore *store) { _store = store; }
+  void set_coalescer(RequestCoalescer *coalescer) { _coalescer = coalescer; }
+  // Requests take their QueryWeight() from `budget` first and fail with
+  // status_over_budget when it has none left. While it runs low, expired
+  // cached responses are served instead of fetching.
+  void set_budget(RequestBudget *budget) { _budget = budget; }
+  // How responses are checked when received or loaded from the store. A
+  // fetched body failing the check ends the request with
+  // status_invalid_response.
+  void set_verify(const VerifyOptions &options) { _verify = options; }
+  // Response bodies are allocated from `arena` instead of the heap.
+  void set_arena(ResponseArena *arena) { _arena = arena; }
+  // Key under which params are cached and stored.
+  bool cache_key(OpenMeteoParams *params, uint64_t *key);
+  bool cache_key(const Endpoint &endpoint, OpenMeteoParams *params,
+                 uint64_t *key);
+  // Drops the connection; the next request reconnects.
+  void close();
+
+  size_t requests() const { return _requests; }
+  size_t connections_opened() const { return _connections_opened; }
+  size_t connections_reused() const { return _connections_reused; }
+  RequestOutcome last_outcome() const { return _outcome; }
+  // Responses kept after a 304 and the body bytes they did not download.
+  size_t not_modified() const { return _not_modified; }
+  size_t bytes_saved() const { return _bytes_saved; }
+  const RequestMemory &last_memory() const { return _memory; }
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+  // Told about every request, including the ones served without a fetch.
+  void set_observer(RequestObserver *observer) { _observer = observer; }
+  const RequestTrace &last_trace() const { return _trace; }
+#endif
+
+private:
+  bool build_url(const Endpoint &endpoint, const OpenMeteoParams *params,
+                 const Location *locations, size_t count);
+  int request(WeatherResponse *output,
+              const Validators *validators = nullptr);
+  int fetch_ranges(const Endpoint &endpoint, const OpenMeteoParams *params,
+                   const DateRange *ranges, size_t count,
+                   WeatherResponse *output);
+  int lookup(const Endpoint &endpoint, OpenMeteoParams *params,
+             SharedResponse *output);
+  int fetch(const Endpoint &endpoint, const OpenMeteoParams *params,
+            uint64_t key, time_t now, SharedResponse *output);
+  int perform(WeatherResponse *output);
+  void on_connected() override;
+  void on_disconnected() override;
+  void on_header(const char *key, const char *value) override;
+  void sample_heap();
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+  // Nested calls extend the outermost trace.
+  void trace_begin();
+  void trace_end(int status_code);
+#endif
+
+  StaticQueryBuilder<CONFIG_OPEN_METEO_MAX_URL_LENGTH> _url;
+  const char *_base_url{nullptr};
+  int _timeout_ms{5000};
+  ForecastCache *_cache{nullptr};
+  ForecastStore *_store{nullptr};
+  RequestCoalescer *_coalescer{nullptr};
+  RequestBudget *_budget{nullptr};
+  ResponseArena *_arena{nullptr};
+  VerifyOptions _verify{};
+  std::unique_ptr<Transport> _own_transport;
+  Transport *_transport{nullptr};
+  bool _connected{false};
+  bool _connected_this_request{false};
+  bool _server_closing{false};
+  Validators _validators{};
+  float _weight{1.f};
+  uint32_t _retry_after_s{0};
+  RequestOutcome _outcome{outcome_none};
+  size_t _requests{0};
+  size_t _connections_opened{0};
+  size_t _connections_reused{0};
+  size_t _not_modified{0};
+  size_t _bytes_saved{0};
+  RequestMemory _memory{};
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+  RequestObserver *_observer{nullptr};
+  RequestTrace _trace{};
+  int _trace_depth{0};
+#endif
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,48 @@
+#pragma once
+#include "om_response.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace OM_SDK {
+
+struct CoalescerStats {
+  size_t fetches{0};
+  size_t coalesced{0};
+  size_t in_flight{0};
+};
+
+// Lets clients on different tasks share one fetch of an identical query.
+// The first caller for a key fetches, callers arriving while it is in
+// flight wait for it and get the same response buffer.
+class RequestCoalescer {
+public:
+  RequestCoalescer() = default;
+  RequestCoalescer(const RequestCoalescer &) = delete;
+  RequestCoalescer &operator=(const RequestCoalescer &) = delete;
+
+  // True if the caller must fetch and then call complete() for `key`.
+  // Otherwise blocks until the fetching caller completed and returns its
+  // result through status_code and output.
+  bool join(uint64_t key, int *status_code, SharedResponse *output);
+  void complete(uint64_t key, int status_code, SharedResponse response);
+
+  CoalescerStats stats() const;
+
+private:
+  struct Flight {
+    bool done{false};
+    int status_code{-1};
+    SharedResponse response;
+  };
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::unordered_map<uint64_t, std::shared_ptr<Flight>> _flights;
+  CoalescerStats _stats;
+};
+
+} // namespace OM_SDK
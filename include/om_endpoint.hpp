@@ -0,0 +1,58 @@
+#pragma once
+#include "om_response.hpp"
+#include "open_meteo.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+namespace OM_SDK {
+
+// One Open-Meteo API: where it lives and what a request may ask for. Copy
+// one of the endpoints below to change its limits.
+struct Endpoint {
+  // Scheme and host, Client::set_base_url replaces it.
+  const char *host;
+  const char *path;
+  // Variables each section accepts, others are dropped from the request.
+  TimeParamSet current;
+  TimeParamSet hourly;
+  TimeParamSet daily;
+  TimeParamSet minutely_15;
+  // past_days and forecast_days are clamped to these.
+  int8_t past_days_max;
+  int8_t forecast_days_max;
+  // Days forecast when forecast_days is not set.
+  int8_t forecast_days_default;
+  // Days one request covers from start_date to end_date. Longer ranges are
+  // fetched in chunks and merged, 0 never splits.
+  uint16_t range_days_max;
+};
+
+extern const Endpoint forecast_endpoint;
+extern const Endpoint air_quality_endpoint;
+extern const Endpoint marine_endpoint;
+// Historical weather, split into 92 day chunks.
+extern const Endpoint archive_endpoint;
+// Needs models; the sections hold one variable per ensemble member.
+extern const Endpoint ensemble_endpoint;
+
+// Local dates, both included.
+struct DateRange {
+  time_t start;
+  time_t end;
+};
+
+// The chunks start_date to end_date is fetched in, one when it fits in
+// endpoint.range_days_max, none without a range.
+std::vector<DateRange> SplitDateRange(const Endpoint &endpoint, time_t start,
+                                      time_t end);
+
+// Joins the responses of consecutive date range chunks into one response
+// with a single time series per section, the current section coming from
+// the last chunk. False if they do not line up: different variables or a
+// gap between the time axes.
+bool MergeTimeSeries(const WeatherResponse *parts, size_t count,
+                     WeatherResponse *output);
+
+} // namespace OM_SDK
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef ESP_PLATFORM
+#include "om_client.hpp"
+#include "om_endpoint.hpp"
+#include "open_meteo.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace OM_SDK {
+
+struct FetchPoolOptions {
+  // Concurrent connections, one worker thread each.
+  size_t connections{4};
+  // Requests started per second on one host, 0 for no limit.
+  double requests_per_second{0.};
+  // Tries per job on network errors, corrupt bodies, 429 and 5xx answers.
+  uint8_t max_attempts{4};
+  // Wait before the first retry, doubled for each further one. Up to half
+  // of it is taken off at random so workers do not retry in step.
+  uint32_t backoff_ms{500};
+  uint32_t max_backoff_ms{30000};
+  int timeout_ms{5000};
+  // Shared call budget of every connection, none when null.
+  RequestBudget *budget{nullptr};
+  // Scheme and host instead of the endpoint's, e.g. a local server.
+  const char *base_url{nullptr};
+  VerifyOptions verify{};
+  // Transport of each connection, DefaultTransport() when empty.
+  std::function<std::unique_ptr<Transport>()> transport;
+};
+
+// One site and date window of a backfill. The range is {0, 0} when the
+// params have no start_date.
+struct FetchJob {
+  size_t site;
+  DateRange range;
+};
+
+// Gets every job once, in order: site by site, each in date order.
+typedef std::function<void(const FetchJob &job, int status_code,
+                           WeatherResponse &&response)>
+    FetchConsumer;
+
+struct FetchPoolStats {
+  size_t jobs;
+  size_t requests;
+  size_t retries;
+  size_t failed;
+  size_t bytes;
+  int64_t elapsed_us;
+};
+
+// Fetches the same params for many sites over a bounded number of
+// connections, for backfills on host builds. Workers run at most two jobs
+// per connection ahead of the consumer, which bounds the responses held.
+class FetchPool {
+public:
+  explicit FetchPool(const FetchPoolOptions &options) : _options(options) {}
+  FetchPool(const FetchPool &) = delete;
+  FetchPool &operator=(const FetchPool &) = delete;
+
+  // Fetches params at each site, start_date to end_date split into windows
+  // of endpoint.range_days_max days. The consumer runs on the calling
+  // thread; returns once it saw every job, with the number that failed.
+  size_t run(const Endpoint &endpoint, const OpenMeteoParams &params,
+             const Location *sites, size_t count,
+             const FetchConsumer &consumer);
+  const FetchPoolStats &stats() const { return _stats; }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  struct Run;
+
+  void work(Run *run, unsigned seed);
+  // Sleeps until the host may take another request.
+  void wait_for_host(const std::string &host);
+
+  const FetchPoolOptions _options;
+  FetchPoolStats _stats{};
+  std::mutex _hosts_mutex;
+  std::map<std::string, Clock::time_point> _next_start;
+};
+
+} // namespace OM_SDK
+#endif
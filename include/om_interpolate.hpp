@@ -0,0 +1,58 @@
+#pragma once
+#include "om_accessor.hpp"
+#include "open_meteo.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace OM_SDK {
+
+typedef enum Interpolation : uint8_t {
+  interpolation_linear = 0,
+  // Monotone cubic (Fritsch-Butland tangents), never overshoots the samples.
+  interpolation_cubic,
+  // Degrees on the circle, through the shorter arc.
+  interpolation_angle,
+} Interpolation;
+
+// Angle for wind directions, linear otherwise.
+Interpolation DefaultInterpolation(TimeParam param);
+
+// A timestamp between samples index and index + 1 of a TimeAxis, at
+// fraction t. Timestamps outside the axis are clamped to its ends.
+struct TimeWeight {
+  uint32_t index;
+  float t;
+};
+
+// Fill `output` once, then evaluate any number of variables of the same
+// section with it. Returns the number of weights written.
+size_t TimeWeights(const TimeAxis &axis, const int64_t *times, size_t count,
+                   TimeWeight *output);
+// Evenly spaced timestamps from `start` every `step` seconds.
+size_t TimeWeights(const TimeAxis &axis, int64_t start, int32_t step,
+                   size_t count, TimeWeight *output);
+
+// output[i] is `values` at weights[i]. Samples next to a NaN give NaN.
+void Interpolate(Span<float> values, const TimeWeight *weights, size_t count,
+                 Interpolation mode, float *output);
+// Same on a param of an indexed section, all NaN if the param is missing.
+void Interpolate(const SectionIndex &section, TimeParam param,
+                 const TimeWeight *weights, size_t count, float *output);
+
+// Bilinear weights of `point` inside the box spanned by the south-west and
+// north-east corners, for corners ordered south-west, south-east, north-west,
+// north-east. Points outside the box are clamped to its edges. A box whose
+// east edge lies west of its west edge crosses the antimeridian.
+struct GridWeights {
+  float weight[4];
+};
+
+bool BilinearWeights(Location south_west, Location north_east, Location point,
+                     GridWeights *output);
+
+// output[i] blends corners[0..3][i] with the grid weights. Angles are blended
+// as unit vectors.
+void Blend(const float *const corners[4], const GridWeights &weights,
+           size_t count, Interpolation mode, float *output);
+
+} // namespace OM_SDK
@@ -0,0 +1,119 @@
+#pragma once
+#include "om_accessor.hpp"
+#include "om_client.hpp"
+#include "om_response.hpp"
+#include "open_meteo.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OM_SDK {
+
+struct Endpoint;
+
+struct PlannerConfig {
+  // Time a query waits for others to join it before it is fetched.
+  uint32_t window_ms{100};
+};
+
+struct PlannerStats {
+  size_t queries;
+  // Requests sent for them, and the ones separate fetches would have added.
+  size_t round_trips;
+  size_t round_trips_saved;
+  size_t bytes_fetched;
+  // Estimated from the values each query gets: the bytes of separate
+  // responses above the merged ones.
+  size_t bytes_saved;
+};
+
+// What one query asked for in a merged response: its variables over its
+// days. The sections point into the shared buffer, nothing is copied, and
+// stay valid while a copy of the view lives.
+class ResponseView {
+public:
+  ResponseView() = default;
+
+  // The whole message, including what other queries asked for.
+  const openmeteo_sdk::WeatherApiResponse *response() const;
+  SharedResponse shared() const;
+  explicit operator bool() const { return response() != nullptr; }
+
+  const SectionView &current() const { return _current; }
+  const SectionView &hourly() const { return _hourly; }
+  const SectionView &daily() const { return _daily; }
+  const SectionView &minutely_15() const { return _minutely_15; }
+
+private:
+  friend class QueryPlanner;
+  struct Merged;
+
+  std::shared_ptr<const Merged> _merged;
+  SectionView _current;
+  SectionView _hourly;
+  SectionView _daily;
+  SectionView _minutely_15;
+};
+
+typedef std::function<void(int status_code, const ResponseView &view)>
+    ViewCallback;
+
+// Fetches queries for the same place together: queries submitted within
+// window_ms of each other that only differ by their variables and days are
+// sent as one request for the union of both, and each callback gets a view
+// of its own part. Days only merge in UTC or GMT: in other timezones, and
+// with daily values which come in the local one, queries need the same days
+// to share a request. Queries may be submitted from any task; poll()
+// fetches and runs the callbacks on the task that owns the client.
+class QueryPlanner {
+public:
+  typedef std::function<int64_t()> NowMs;
+
+  // `now` defaults to MonotonicUs() / 1000.
+  explicit QueryPlanner(Client *client, const PlannerConfig &config = {},
+                        NowMs now = nullptr);
+  QueryPlanner(const QueryPlanner &) = delete;
+  QueryPlanner &operator=(const QueryPlanner &) = delete;
+
+  // forecast_endpoint. The params are copied, their arrays are not kept.
+  bool submit(const OpenMeteoParams &params, ViewCallback callback);
+  bool submit(const Endpoint &endpoint, const OpenMeteoParams &params,
+              ViewCallback callback);
+
+  // Fetches the groups whose window closed and runs their callbacks.
+  // Returns the number of requests made.
+  size_t poll();
+  // Same for every group, closed or not.
+  size_t flush();
+  // Time poll() has work next, 0 without queries.
+  int64_t next_due() const;
+  PlannerStats stats() const;
+
+private:
+  struct Query {
+    OpenMeteoParams params;
+    ViewCallback callback;
+  };
+  struct Group {
+    const Endpoint *endpoint;
+    uint64_t key;
+    int64_t opened;
+    std::vector<Query> queries;
+  };
+
+  int64_t now() const;
+  size_t fetch(bool all);
+  size_t fetch_group(Group *group);
+
+  Client *_client;
+  const PlannerConfig _config;
+  NowMs _now;
+  mutable std::mutex _mutex;
+  std::vector<Group> _groups;
+  PlannerStats _stats{};
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <ctime>
+
+namespace OM_SDK {
+
+// Appends to a caller supplied buffer without allocating. Once the buffer is
+// full further appends are dropped and overflow() reports it; the content
+// stays null terminated at all times.
+class QueryBuilder {
+public:
+  QueryBuilder(char *buffer, size_t capacity);
+  QueryBuilder(const QueryBuilder &) = delete;
+  QueryBuilder &operator=(const QueryBuilder &) = delete;
+
+  QueryBuilder &append(const char *str);
+  QueryBuilder &append(int value);
+  QueryBuilder &append(float value);
+  QueryBuilder &append_time(time_t value, const char *format);
+  void clear();
+
+  const char *c_str() const { return _buffer; }
+  size_t size() const { return _size; }
+  size_t capacity() const { return _capacity; }
+  bool overflow() const { return _overflow; }
+
+private:
+  QueryBuilder &appendf(const char *format, ...);
+
+  char *_buffer;
+  size_t _capacity;
+  size_t _size{0};
+  bool _overflow{false};
+};
+
+template <size_t N> class StaticQueryBuilder : public QueryBuilder {
+public:
+  StaticQueryBuilder() : QueryBuilder(_storage, N) {}
+
+private:
+  char _storage[N];
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,129 @@
+#pragma once
+#include "om_arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sdkconfig.h>
+#include <vector>
+#include <weather_api_generated.h>
+
+namespace OM_SDK {
+
+// How far received bytes are checked before they are read, in increasing
+// cost. Header checks the size prefixes and that each root table and its
+// vtable lie inside the message, full runs the flatbuffers Verifier.
+typedef enum VerifyMode : uint8_t {
+  verify_off = 0,
+  verify_header,
+  verify_full,
+} VerifyMode;
+
+#if CONFIG_OPEN_METEO_VERIFY_OFF
+constexpr VerifyMode default_verify_mode = verify_off;
+#elif CONFIG_OPEN_METEO_VERIFY_HEADER
+constexpr VerifyMode default_verify_mode = verify_header;
+#else
+constexpr VerifyMode default_verify_mode = verify_full;
+#endif
+
+// Returned by requests whose body arrived whole but failed verification.
+typedef enum VerifyStatus : int {
+  status_invalid_response = -5,
+} VerifyStatus;
+
+struct VerifyOptions {
+  VerifyMode mode{default_verify_mode};
+  // Limits of the full verification, nesting depth and number of tables.
+  uint32_t max_depth{64};
+  uint32_t max_tables{1000000};
+};
+
+// True if `data` is one or more size-prefixed messages passing `options`.
+// The size prefixes are checked in every mode.
+bool VerifyMessages(const uint8_t *data, size_t size,
+                    const VerifyOptions &options);
+
+// Owns the raw size-prefixed flatbuffer returned by the API. The decoded
+// WeatherApiResponse points into this buffer, so it stays valid for as long
+// as the WeatherResponse lives. The buffer comes from the heap, or from
+// `arena` when one is given.
+class WeatherResponse {
+public:
+  WeatherResponse() = default;
+  explicit WeatherResponse(ResponseArena *arena) : _arena(arena) {}
+  ~WeatherResponse();
+  WeatherResponse(WeatherResponse &&other) noexcept;
+  WeatherResponse &operator=(WeatherResponse &&other) noexcept;
+  WeatherResponse(const WeatherResponse &) = delete;
+  WeatherResponse &operator=(const WeatherResponse &) = delete;
+
+  // nullptr if the buffer does not hold a complete size-prefixed message.
+  const openmeteo_sdk::WeatherApiResponse *get() const;
+  const openmeteo_sdk::WeatherApiResponse *operator->() const { return get(); }
+  explicit operator bool() const { return get() != nullptr; }
+
+  // Multi-location responses hold one message per location, back to back.
+  // Fills `out` with up to `max` of them and returns how many were found.
+  size_t messages(const openmeteo_sdk::WeatherApiResponse **out,
+                  size_t max) const;
+
+  // Verifies the messages unless they already passed options.mode, and
+  // remembers the mode they passed. Writing to the buffer forgets it.
+  bool verify(const VerifyOptions &options);
+  VerifyMode verified() const { return _verified; }
+  // Records a check done before, e.g. by the copy the bytes came from.
+  void set_verified(VerifyMode mode) { _verified = mode; }
+
+  const uint8_t *data() const { return _data; }
+  size_t size() const { return _size; }
+  size_t capacity() const { return _capacity; }
+
+  // Grows the buffer to at least `capacity` bytes, keeping its content.
+  bool reserve(size_t capacity);
+  // Free space after the written bytes, filled then published with commit().
+  uint8_t *tail() { return _data + _size; }
+  size_t available() const { return _capacity - _size; }
+  void commit(size_t count) {
+    _size += count;
+    _verified = verify_off;
+  }
+  void clear() {
+    _size = 0;
+    _verified = verify_off;
+  }
+  void reset();
+  ResponseArena *arena() const { return _arena; }
+
+private:
+  ResponseArena *_arena{nullptr};
+  uint8_t *_data{nullptr};
+  size_t _size{0};
+  size_t _capacity{0};
+  VerifyMode _verified{verify_off};
+};
+
+// Read-only response shared between the cache and its users.
+typedef std::shared_ptr<const WeatherResponse> SharedResponse;
+
+// Result of get_weather_batch, one response per requested location in
+// request order. The views point into the owned response buffers.
+class WeatherBatch {
+public:
+  size_t size() const { return _locations.size(); }
+  const openmeteo_sdk::WeatherApiResponse *operator[](size_t index) const {
+    return _locations[index];
+  }
+  size_t requests() const { return _responses.size(); }
+  void clear();
+
+  // Takes `response` and appends its `count` messages.
+  bool append(WeatherResponse &&response, size_t count);
+  // Copies the message of location `index` into `output`, on its own.
+  bool copy(size_t index, WeatherResponse *output) const;
+
+private:
+  std::vector<WeatherResponse> _responses;
+  std::vector<const openmeteo_sdk::WeatherApiResponse *> _locations;
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,74 @@
+#pragma once
+#include "om_async.hpp"
+#include "om_client.hpp"
+#include "open_meteo.hpp"
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <vector>
+
+namespace OM_SDK {
+
+struct SchedulerConfig {
+  // Refresh interval when the model cadence is unknown.
+  uint32_t default_interval{3600};
+  // Time between a model run and its data being served.
+  uint32_t publish_delay{900};
+  // Upper bound of the random delay added to every refresh.
+  uint32_t jitter{120};
+  // Delay before retrying a failed fetch.
+  uint32_t retry{300};
+};
+
+typedef uint32_t QueryId;
+
+// Refreshes registered queries right after the model that serves them
+// publishes a new run, instead of on a fixed timer. Due queries that only
+// differ by location are fetched together with get_weather_batch. Not thread
+// safe: add, remove and poll from the task that owns the client.
+class RefreshScheduler {
+public:
+  typedef std::function<time_t()> TimeSource;
+
+  // `now` defaults to time(); `seed` drives the jitter.
+  RefreshScheduler(Client *client, const SchedulerConfig &config = {},
+                   TimeSource now = nullptr, uint32_t seed = 1);
+
+  // Arrays referenced by params must stay valid until the query is removed.
+  // The query is due right away.
+  QueryId add(const OpenMeteoParams &params, WeatherCallback callback);
+  bool remove(QueryId id);
+
+  // Fetches the due queries and runs their callbacks. Returns the number of
+  // requests made.
+  size_t poll();
+  // Time of the earliest refresh, 0 without queries.
+  time_t next_due() const;
+  time_t due(QueryId id) const;
+  // Next refresh for a response of `model` fetched at `now`, without jitter.
+  time_t next_refresh(openmeteo_sdk::Model model, time_t now) const;
+
+private:
+  struct Query {
+    QueryId id;
+    OpenMeteoParams params;
+    WeatherCallback callback;
+    uint64_t group;
+    time_t due;
+  };
+
+  time_t now() const { return _now ? _now() : time(nullptr); }
+  uint32_t jitter();
+  void complete(Query *query, int status_code, SharedResponse response,
+                time_t now);
+  void fetch_group(const std::vector<Query *> &group, time_t now);
+
+  Client *_client;
+  const SchedulerConfig _config;
+  TimeSource _now;
+  uint32_t _random;
+  QueryId _next_id{1};
+  std::vector<Query> _queries;
+};
+
+} // namespace OM_SDK
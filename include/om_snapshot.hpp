@@ -0,0 +1,109 @@
+#pragma once
+#include "om_accessor.hpp"
+#include "open_meteo.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OM_SDK {
+
+// What a snapshot keeps of a response.
+struct SnapshotSelection {
+  TimeParamSet current;
+  TimeParamSet hourly;
+  TimeParamSet daily;
+  TimeParamSet minutely_15;
+  // Keeps every stride-th step of the hourly and 15 minutely sections.
+  uint16_t stride{1};
+  // Steps kept per section, 0 for all.
+  uint16_t max_steps{0};
+  // Steps before this time are dropped, 0 keeps them.
+  int64_t from{0};
+};
+
+// Decimal digits a TimeParam keeps in a snapshot, e.g. 1 for temperatures
+// and 0 for cloud cover or weather codes.
+int8_t SnapshotDecimals(TimeParam param);
+
+// Writes the selected part of `response` as a compact blob for slow links
+// and returns its size, 0 if it does not fit in `capacity`.
+//
+// Layout, integers as LEB128 varints, signed ones zigzag coded:
+//   'O' 'S' version, latitude and longitude * 1e4, elevation, utc offset,
+//   model, then a byte with one bit per present section (current, hourly,
+//   daily, minutely_15) and for each of them:
+//     start time, interval, step count, variable count, then per variable
+//     the TimeParam, the decimals (int64 values use 0x80) and one code per
+//     step: 0 for a missing value, else 1 + the delta to the previous
+//     value, quantized to the decimals.
+size_t EncodeSnapshot(const openmeteo_sdk::WeatherApiResponse *response,
+                      const SnapshotSelection &selection, uint8_t *output,
+                      size_t capacity);
+
+// One section of a decoded snapshot, read like a SectionIndex.
+class SnapshotSection {
+public:
+  bool has(TimeParam param) const {
+    return param < max_params && _slots[param] != absent;
+  }
+  Span<float> values(TimeParam param) const;
+  Span<int64_t> values_int64(TimeParam param) const;
+  // First value, the only one in the current section, or `fallback`.
+  float value(TimeParam param, float fallback = 0.f) const;
+  TimeAxis time() const { return TimeAxis(_start, _interval, _steps); }
+
+private:
+  friend class Snapshot;
+  static constexpr uint8_t absent = 0xff;
+
+  struct Column {
+    size_t offset;
+    bool int64;
+  };
+
+  int64_t _start{0};
+  int32_t _interval{0};
+  size_t _steps{0};
+  uint8_t _slots[max_params];
+  std::vector<Column> _columns;
+  const float *_floats{nullptr};
+  const int64_t *_ints{nullptr};
+};
+
+// A decoded snapshot. The values are copied out of the blob, which can be
+// dropped after decode().
+class Snapshot {
+public:
+  Snapshot();
+  Snapshot(const Snapshot &) = delete;
+  Snapshot &operator=(const Snapshot &) = delete;
+  Snapshot(Snapshot &&) = default;
+  Snapshot &operator=(Snapshot &&) = default;
+
+  // False, leaving the snapshot empty, if the blob is truncated or invalid.
+  bool decode(const uint8_t *data, size_t size);
+
+  float latitude() const { return _latitude; }
+  float longitude() const { return _longitude; }
+  float elevation() const { return _elevation; }
+  int32_t utc_offset_seconds() const { return _utc_offset_seconds; }
+  openmeteo_sdk::Model model() const { return _model; }
+  const SnapshotSection &current() const { return _sections[0]; }
+  const SnapshotSection &hourly() const { return _sections[1]; }
+  const SnapshotSection &daily() const { return _sections[2]; }
+  const SnapshotSection &minutely_15() const { return _sections[3]; }
+
+private:
+  void clear();
+
+  float _latitude{0.f};
+  float _longitude{0.f};
+  float _elevation{0.f};
+  int32_t _utc_offset_seconds{0};
+  openmeteo_sdk::Model _model{openmeteo_sdk::Model_undefined};
+  SnapshotSection _sections[4];
+  std::vector<float> _floats;
+  std::vector<int64_t> _ints;
+};
+
+} // namespace OM_SDK
@@ -0,0 +1,68 @@
+#pragma once
+#include "om_response.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+namespace OM_SDK {
+
+// Minimal file access used by ForecastStore, so the storage can live on
+// SPIFFS, LittleFS, an SD card or a plain directory on a host.
+class FileBackend {
+public:
+  virtual ~FileBackend() = default;
+  // Bytes read, or -1 if the file cannot be opened.
+  virtual int read(const char *name, size_t offset, void *data,
+                   size_t size) = 0;
+  // Replaces the file with header followed by data.
+  virtual bool write(const char *name, const void *header, size_t header_size,
+                     const void *data, size_t size) = 0;
+  virtual bool remove(const char *name) = 0;
+};
+
+// Files in a directory through stdio, which is also how VFS mounted
+// partitions are reached on ESP-IDF. Writes go to a temporary file renamed
+// onto the old one, which is replaced atomically where the file system
+// allows it. Where rename cannot replace a file, the old one is removed
+// first and a crash in between loses it.
+class StdioFileBackend : public FileBackend {
+public:
+  explicit StdioFileBackend(const char *directory);
+  int read(const char *name, size_t offset, void *data, size_t size) override;
+  bool write(const char *name, const void *header, size_t header_size,
+             const void *data, size_t size) override;
+  bool remove(const char *name) override;
+
+private:
+  bool path(const char *name, const char *suffix, char *out, size_t size);
+
+  const char *_directory;
+};
+
+struct StoredForecastInfo {
+  uint64_t key;
+  time_t fetched;
+  time_t expires;
+};
+
+// Keeps the raw size-prefixed flatbuffer of a response on disk, one file per
+// query key, so it can be shown right after boot without a network fetch.
+class ForecastStore {
+public:
+  // Stored forecasts expire like ForecastCache entries.
+  ForecastStore(FileBackend *backend, uint32_t ttl_seconds)
+      : _backend(backend), _ttl_seconds(ttl_seconds) {}
+
+  bool save(uint64_t key, const WeatherResponse &response, time_t fetched);
+  // Fails if the file is missing, corrupt or truncated, and if it expired
+  // unless allow_expired is set.
+  bool load(uint64_t key, time_t now, WeatherResponse *output,
+            StoredForecastInfo *info = nullptr, bool allow_expired = false);
+  bool remove(uint64_t key);
+
+private:
+  FileBackend *_backend;
+  const uint32_t _ttl_seconds;
+};
+
+} // namespace OM_SDK
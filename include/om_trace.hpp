@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace OM_SDK {
+
+// Where the response of the last request came from.
+typedef enum RequestOutcome : uint8_t {
+  outcome_none = 0,
+  outcome_fetched,
+  outcome_cache_hit,
+  outcome_store_hit,
+  outcome_not_modified,
+  outcome_coalesced,
+  outcome_failed,
+  // Expired cache entry served while the request budget ran low.
+  outcome_stale,
+} RequestOutcome;
+
+// Microseconds on a clock that never goes backwards.
+int64_t MonotonicUs();
+
+// One request as seen by the client. Timestamps are MonotonicUs() values, 0
+// for phases the request did not reach. The transport resolves, connects and
+// handshakes inside open(), so `connected_us` is the only mark before the
+// request is sent, and it is 0 when a kept-alive connection was reused.
+struct RequestTrace {
+  int64_t start_us;
+  int64_t connected_us;
+  int64_t sent_us;
+  int64_t headers_us;
+  int64_t body_us;
+  int64_t end_us;
+  // Time spent verifying the flatbuffers once the body arrived.
+  int64_t decode_us;
+  size_t body_bytes;
+  // Times the response buffer had to grow while the body was read.
+  uint16_t buffer_grows;
+  // Requests sent, 2 after a reconnect.
+  uint8_t attempts;
+  RequestOutcome outcome;
+  int status_code;
+
+  int64_t connect_time() const { return span(start_us, connected_us); }
+  // From sending the request to the status line and headers.
+  int64_t first_byte_time() const { return span(sent_us, headers_us); }
+  int64_t transfer_time() const { return span(headers_us, body_us); }
+  int64_t total_time() const { return span(start_us, end_us); }
+
+private:
+  static int64_t span(int64_t from, int64_t to) {
+    return from && to ? to - from : 0;
+  }
+};
+
+// Told about every request of the clients it is set on.
+class RequestObserver {
+public:
+  virtual ~RequestObserver() = default;
+  virtual void on_request(const RequestTrace &trace) = 0;
+};
+
+// Counts values in buckets a quarter of a power of two wide, so percentiles
+// are within 25% of the recorded values at any scale.
+class LatencyHistogram {
+public:
+  void add(int64_t value);
+  void clear();
+  size_t count() const { return _count; }
+  int64_t max() const { return _max; }
+  // Upper bound of the bucket holding the `percent` percentile, 0 when
+  // empty.
+  int64_t percentile(double percent) const;
+
+private:
+  static constexpr size_t bucket_count = 8 + 4 * 61;
+  static size_t bucket(uint64_t value);
+  static int64_t upper_bound(size_t bucket);
+
+  uint32_t _buckets[bucket_count]{};
+  size_t _count{0};
+  int64_t _max{0};
+};
+
+// Cumulative phase latencies and byte counts over all observed requests.
+// Thread safe, one recorder can observe several clients.
+class TraceRecorder : public RequestObserver {
+public:
+  struct Stats {
+    LatencyHistogram connect;
+    LatencyHistogram first_byte;
+    LatencyHistogram transfer;
+    LatencyHistogram decode;
+    LatencyHistogram total;
+    size_t requests;
+    size_t failures;
+    size_t served_locally;
+    uint64_t body_bytes;
+    size_t buffer_grows;
+    size_t reconnects;
+  };
+
+  void on_request(const RequestTrace &trace) override;
+  Stats stats() const;
+  void clear();
+
+private:
+  mutable std::mutex _mutex;
+  Stats _stats{};
+};
+
+} // namespace OM_SDK
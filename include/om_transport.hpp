@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <esp_err.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OM_SDK {
+
+// Told what a transport sees while a request runs.
+class TransportListener {
+public:
+  virtual ~TransportListener() = default;
+  virtual void on_connected() = 0;
+  virtual void on_disconnected() = 0;
+  virtual void on_header(const char *key, const char *value) = 0;
+};
+
+// One HTTP connection issuing GET requests, kept alive between them when the
+// server allows it. A request is prepare(), set_header(), open(),
+// fetch_headers(), then read() or flush().
+class Transport {
+public:
+  virtual ~Transport() = default;
+
+  void set_listener(TransportListener *listener) { _listener = listener; }
+  virtual void set_timeout_ms(int timeout_ms) = 0;
+
+  // Url of the next request.
+  virtual esp_err_t prepare(const char *url) = 0;
+  // Header sent with every request until deleted.
+  virtual esp_err_t set_header(const char *key, const char *value) = 0;
+  virtual esp_err_t delete_header(const char *key) = 0;
+
+  // Connects if needed and sends the request.
+  virtual esp_err_t open() = 0;
+  // Content length, 0 when unknown, negative on failure.
+  virtual int64_t fetch_headers() = 0;
+  virtual int status_code() = 0;
+  // Body bytes read, 0 once the body is complete, negative on failure.
+  virtual int read(uint8_t *buffer, size_t size) = 0;
+  // Discards the rest of the body.
+  virtual esp_err_t flush() = 0;
+  virtual bool complete() = 0;
+  virtual void close() = 0;
+
+protected:
+  TransportListener *_listener{nullptr};
+};
+
+// esp_http_client over TLS with the certificate bundle on ESP-IDF, plain
+// HTTP over POSIX sockets elsewhere.
+std::unique_ptr<Transport> DefaultTransport(int timeout_ms);
+
+// Serves canned responses in order, for running the library without network.
+// Each request takes the next response, the urls are recorded.
+class ReplayTransport : public Transport {
+public:
+  struct Response {
+    int status_code;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::vector<uint8_t> body;
+    // Server closes the connection after this response.
+    bool close{false};
+  };
+
+  void push(Response response) { _responses.push_back(std::move(response)); }
+  // Answers every further request with the last pushed response.
+  void set_repeat(bool repeat) { _repeat = repeat; }
+  const std::vector<std::string> &urls() const { return _urls; }
+  const std::vector<std::pair<std::string, std::string>> &headers() const {
+    return _headers;
+  }
+  size_t connections() const { return _connections; }
+
+  void set_timeout_ms(int) override {}
+  esp_err_t prepare(const char *url) override;
+  esp_err_t set_header(const char *key, const char *value) override;
+  esp_err_t delete_header(const char *key) override;
+  esp_err_t open() override;
+  int64_t fetch_headers() override;
+  int status_code() override;
+  int read(uint8_t *buffer, size_t size) override;
+  esp_err_t flush() override;
+  bool complete() override;
+  void close() override;
+
+private:
+  std::vector<Response> _responses;
+  size_t _next{0};
+  bool _repeat{false};
+  const Response *_current{nullptr};
+  size_t _offset{0};
+  bool _connected{false};
+  size_t _connections{0};
+  std::string _url;
+  std::vector<std::string> _urls;
+  std::vector<std::pair<std::string, std::string>> _headers;
+};
+
+} // namespace OM_SDK
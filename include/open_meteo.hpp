@@ -1,3 +1,9 @@
+#pragma once
+#include "om_cache.hpp"
+#include "om_client.hpp"
+#include "om_response.hpp"
+#include <cstdint>
+#include <initializer_list>
 #include <weather_api_generated.h>
 
 namespace OM_SDK {
@@ -77,9 +83,122 @@ typedef enum TimeParam {
   wind_speed_180m,
   wind_speed_80m,
   uv_index,
+  // Air quality endpoint.
+  pm10,
+  pm2_5,
+  carbon_monoxide,
+  nitrogen_dioxide,
+  sulphur_dioxide,
+  ozone,
+  aerosol_optical_depth,
+  dust,
+  uv_index_clear_sky,
+  ammonia,
+  alder_pollen,
+  birch_pollen,
+  grass_pollen,
+  mugwort_pollen,
+  olive_pollen,
+  ragweed_pollen,
+  european_aqi,
+  us_aqi,
+  // Marine endpoint.
+  wave_height,
+  wave_direction,
+  wave_period,
+  wind_wave_height,
+  wind_wave_direction,
+  wind_wave_period,
+  wind_wave_peak_period,
+  swell_wave_height,
+  swell_wave_direction,
+  swell_wave_period,
+  swell_wave_peak_period,
+  ocean_current_velocity,
+  ocean_current_direction,
+  wave_height_max,
+  wave_direction_dominant,
+  wave_period_max,
   max_params,
 } TimeParam;
 
+// Set of TimeParam values, one bit each. Iteration follows enum order so a
+// selection always serializes the same way.
+class TimeParamSet {
+public:
+  constexpr TimeParamSet() : _bits{0, 0} {}
+  constexpr TimeParamSet(std::initializer_list<TimeParam> params)
+      : _bits{0, 0} {
+    for (TimeParam param : params)
+      set(param);
+  }
+
+  // Adapter for the max_params terminated arrays, undefined is skipped.
+  static TimeParamSet from_array(const TimeParam *params) {
+    TimeParamSet set;
+    for (; params && *params != max_params; ++params)
+      set.insert(*params);
+    return set;
+  }
+
+  constexpr bool contains(TimeParam param) const {
+    return param > undefined && param < max_params &&
+           (_bits[param / 64] >> (param % 64)) & 1;
+  }
+  constexpr bool empty() const { return !_bits[0] && !_bits[1]; }
+  constexpr size_t size() const { return count(_bits[0]) + count(_bits[1]); }
+  void insert(TimeParam param) { set(param); }
+  void erase(TimeParam param) {
+    if (param > undefined && param < max_params)
+      _bits[param / 64] &= ~(uint64_t(1) << (param % 64));
+  }
+  void clear() { _bits[0] = _bits[1] = 0; }
+
+  constexpr TimeParamSet operator&(const TimeParamSet &other) const {
+    return TimeParamSet(_bits[0] & other._bits[0], _bits[1] & other._bits[1]);
+  }
+  constexpr TimeParamSet operator|(const TimeParamSet &other) const {
+    return TimeParamSet(_bits[0] | other._bits[0], _bits[1] | other._bits[1]);
+  }
+  TimeParamSet &operator&=(const TimeParamSet &other) {
+    return *this = *this & other;
+  }
+  TimeParamSet &operator|=(const TimeParamSet &other) {
+    return *this = *this | other;
+  }
+  constexpr bool operator==(const TimeParamSet &other) const {
+    return _bits[0] == other._bits[0] && _bits[1] == other._bits[1];
+  }
+  constexpr bool operator!=(const TimeParamSet &other) const {
+    return !(*this == other);
+  }
+
+  // Calls fn(TimeParam) for every member, in enum order.
+  template <typename Fn> void for_each(Fn fn) const {
+    for (size_t word = 0; word < 2; ++word) {
+      for (uint64_t bits = _bits[word]; bits; bits &= bits - 1)
+        fn((TimeParam)(word * 64 + __builtin_ctzll(bits)));
+    }
+  }
+
+private:
+  constexpr TimeParamSet(uint64_t low, uint64_t high) : _bits{low, high} {}
+  constexpr void set(TimeParam param) {
+    if (param > undefined && param < max_params)
+      _bits[param / 64] |= uint64_t(1) << (param % 64);
+  }
+  static constexpr size_t count(uint64_t bits) {
+    size_t n = 0;
+    for (; bits; bits &= bits - 1)
+      ++n;
+    return n;
+  }
+
+  uint64_t _bits[2];
+};
+
+static_assert(max_params <= 128, "TimeParamSet holds 128 values");
+
 typedef enum WeatherCode : int8_t {
   Clear_sky = 0,
   mainly_clear = 1,
@@ -157,13 +276,29 @@ typedef enum Cell_selection : uint8_t {
 
 const char *const *EnumNamesCellSelection();
 
+// Seconds between two runs of the model, 0 if unknown.
+uint32_t ModelUpdateInterval(openmeteo_sdk::Model model);
+
+struct Location {
+  float latitude;
+  float longitude;
+};
+
 struct OpenMeteoParams {
   float latitude;
   float longitude;
   float elevation{0.};
   bool elevation_default{true};
+  // Requested variables per section. Values a section does not support are
+  // dropped from the request.
+  TimeParamSet hourly_set{};
+  TimeParamSet daily_set{}; // timezone is required.
+  TimeParamSet minutely_15_set{};
+  TimeParamSet current_set{};
+  // Same as the sets above, as max_params terminated arrays. Both are
+  // merged when present.
   TimeParam *hourly{nullptr};
-  TimeParam *daily{nullptr}; // timezone is required.
+  TimeParam *daily{nullptr};
   TimeParam *minutely_15{nullptr};
   TimeParam *current{nullptr};
   Temperature_unit temperature_unit{undefined_tmp_unit};
@@ -188,6 +323,12 @@ struct OpenMeteoParams {
   Cell_selection cell_selection{undefined_selection};
 };
 
-int get_weather(OpenMeteoParams *params,
-                openmeteo_sdk::WeatherApiResponse **output);
+int get_weather(OpenMeteoParams *params, WeatherResponse *output);
+int get_weather(OpenMeteoParams *params, ForecastCache *cache,
+                SharedResponse *output);
+
+// One request for several locations, the latitude/longitude of params are
+// ignored. Split into several requests if the url gets too long.
+int get_weather_batch(OpenMeteoParams *params, const Location *locations,
+                      size_t count, WeatherBatch *output);
 } // namespace OM_SDK
@@ -0,0 +1,311 @@
+#include "om_accessor.hpp"
+#include "om_internal.hpp"
+#include <algorithm>
+
+namespace OM_SDK {
+
+using namespace openmeteo_sdk;
+
+namespace {
+
+// How the API encodes each TimeParam, in TimeParam order.
+struct Descriptor {
+  TimeParam param;
+  Variable variable;
+  int16_t altitude;
+  Aggregation aggregation;
+  int16_t depth;
+  int16_t depth_to;
+};
+
+constexpr Descriptor descriptors[] = {
+    {undefined, Variable_undefined, 0, Aggregation_none, 0, 0},
+    {apparent_temperature, Variable_apparent_temperature, 0, Aggregation_none,
+     0, 0},
+    {apparent_temperature_max, Variable_apparent_temperature, 0,
+     Aggregation_maximum, 0, 0},
+    {apparent_temperature_min, Variable_apparent_temperature, 0,
+     Aggregation_minimum, 0, 0},
+    {cape, Variable_cape, 0, Aggregation_none, 0, 0},
+    {cloud_cover, Variable_cloud_cover, 0, Aggregation_none, 0, 0},
+    {cloud_cover_high, Variable_cloud_cover_high, 0, Aggregation_none, 0, 0},
+    {cloud_cover_low, Variable_cloud_cover_low, 0, Aggregation_none, 0, 0},
+    {cloud_cover_mid, Variable_cloud_cover_mid, 0, Aggregation_none, 0, 0},
+    {daylight_duration, Variable_daylight_duration, 0, Aggregation_none, 0, 0},
+    {dew_point_2m, Variable_dew_point, 2, Aggregation_none, 0, 0},
+    {diffuse_radiation, Variable_diffuse_radiation, 0, Aggregation_none, 0, 0},
+    {direct_normal_irradiance, Variable_direct_normal_irradiance, 0,
+     Aggregation_none, 0, 0},
+    {direct_radiation, Variable_direct_radiation, 0, Aggregation_none, 0, 0},
+    {et0_fao_evapotranspiration, Variable_et0_fao_evapotranspiration, 0,
+     Aggregation_none, 0, 0},
+    {evapotranspiration, Variable_evapotranspiration, 0, Aggregation_none, 0,
+     0},
+    {freezing_level_height, Variable_freezing_level_height, 0,
+     Aggregation_none, 0, 0},
+    {global_tilted_irradiance, Variable_global_tilted_irradiance, 0,
+     Aggregation_none, 0, 0},
+    {global_tilted_irradiance_instant,
+     Variable_global_tilted_irradiance_instant, 0, Aggregation_none, 0, 0},
+    {is_day, Variable_is_day, 0, Aggregation_none, 0, 0},
+    {lightning_potential, Variable_lightning_potential, 0, Aggregation_none, 0,
+     0},
+    {precipitation, Variable_precipitation, 0, Aggregation_none, 0, 0},
+    {precipitation_hours, Variable_precipitation_hours, 0, Aggregation_none, 0,
+     0},
+    {precipitation_probability, Variable_precipitation_probability, 0,
+     Aggregation_none, 0, 0},
+    {precipitation_probability_max, Variable_precipitation_probability, 0,
+     Aggregation_maximum, 0, 0},
+    {precipitation_probability_mean, Variable_precipitation_probability, 0,
+     Aggregation_mean, 0, 0},
+    {precipitation_probability_min, Variable_precipitation_probability, 0,
+     Aggregation_minimum, 0, 0},
+    {precipitation_sum, Variable_precipitation, 0, Aggregation_sum, 0, 0},
+    {pressure_msl, Variable_pressure_msl, 0, Aggregation_none, 0, 0},
+    {rain, Variable_rain, 0, Aggregation_none, 0, 0},
+    {rain_sum, Variable_rain, 0, Aggregation_sum, 0, 0},
+    {relative_humidity_2m, Variable_relative_humidity, 2, Aggregation_none, 0,
+     0},
+    {shortwave_radiation, Variable_shortwave_radiation, 0, Aggregation_none, 0,
+     0},
+    {shortwave_radiation_sum, Variable_shortwave_radiation, 0, Aggregation_sum,
+     0, 0},
+    {showers, Variable_showers, 0, Aggregation_none, 0, 0},
+    {showers_sum, Variable_showers, 0, Aggregation_sum, 0, 0},
+    {snow_depth, Variable_snow_depth, 0, Aggregation_none, 0, 0},
+    {snowfall, Variable_snowfall, 0, Aggregation_none, 0, 0},
+    {snowfall_height, Variable_snowfall_height, 0, Aggregation_none, 0, 0},
+    {snowfall_sum, Variable_snowfall, 0, Aggregation_sum, 0, 0},
+    {soil_moisture_0_to_1cm, Variable_soil_moisture, 0, Aggregation_none, 0,
+     1},
+    {soil_moisture_1_to_3cm, Variable_soil_moisture, 0, Aggregation_none, 1,
+     3},
+    {soil_moisture_27_to_81cm, Variable_soil_moisture, 0, Aggregation_none, 27,
+     81},
+    {soil_moisture_3_to_9cm, Variable_soil_moisture, 0, Aggregation_none, 3,
+     9},
+    {soil_moisture_9_to_27cm, Variable_soil_moisture, 0, Aggregation_none, 9,
+     27},
+    {soil_temperature_0cm, Variable_soil_temperature, 0, Aggregation_none, 0,
+     0},
+    {soil_temperature_18cm, Variable_soil_temperature, 0, Aggregation_none, 18,
+     0},
+    {soil_temperature_54cm, Variable_soil_temperature, 0, Aggregation_none, 54,
+     0},
+    {soil_temperature_6cm, Variable_soil_temperature, 0, Aggregation_none, 6,
+     0},
+    {sunrise, Variable_sunrise, 0, Aggregation_none, 0, 0},
+    {sunset, Variable_sunset, 0, Aggregation_none, 0, 0},
+    {sunshine_duration, Variable_sunshine_duration, 0, Aggregation_none, 0, 0},
+    {surface_pressure, Variable_surface_pressure, 0, Aggregation_none, 0, 0},
+    {temperature_2m, Variable_temperature, 2, Aggregation_none, 0, 0},
+    {temperature_2m_max, Variable_temperature, 2, Aggregation_maximum, 0, 0},
+    {temperature_2m_min, Variable_temperature, 2, Aggregation_minimum, 0, 0},
+    {uv_index_clear_sky_max, Variable_uv_index_clear_sky, 0,
+     Aggregation_maximum, 0, 0},
+    {uv_index_max, Variable_uv_index, 0, Aggregation_maximum, 0, 0},
+    {vapour_pressure_deficit, Variable_vapour_pressure_deficit, 0,
+     Aggregation_none, 0, 0},
+    {visibility, Variable_visibility, 0, Aggregation_none, 0, 0},
+    {weather_code, Variable_weather_code, 0, Aggregation_none, 0, 0},
+    {wind_direction_10m, Variable_wind_direction, 10, Aggregation_none, 0, 0},
+    {wind_direction_10m_dominant, Variable_wind_direction, 10,
+     Aggregation_dominant, 0, 0},
+    {wind_direction_120m, Variable_wind_direction, 120, Aggregation_none, 0,
+     0},
+    {wind_direction_180m, Variable_wind_direction, 180, Aggregation_none, 0,
+     0},
+    {wind_direction_80m, Variable_wind_direction, 80, Aggregation_none, 0, 0},
+    {wind_gusts_10m, Variable_wind_gusts, 10, Aggregation_none, 0, 0},
+    {wind_gusts_10m_max, Variable_wind_gusts, 10, Aggregation_maximum, 0, 0},
+    {wind_speed_10m, Variable_wind_speed, 10, Aggregation_none, 0, 0},
+    {wind_speed_10m_max, Variable_wind_speed, 10, Aggregation_maximum, 0, 0},
+    {wind_speed_120m, Variable_wind_speed, 120, Aggregation_none, 0, 0},
+    {wind_speed_180m, Variable_wind_speed, 180, Aggregation_none, 0, 0},
+    {wind_speed_80m, Variable_wind_speed, 80, Aggregation_none, 0, 0},
+    {uv_index, Variable_uv_index, 0, Aggregation_none, 0, 0},
+    {pm10, Variable_pm10, 0, Aggregation_none, 0, 0},
+    {pm2_5, Variable_pm2p5, 0, Aggregation_none, 0, 0},
+    {carbon_monoxide, Variable_carbon_monoxide, 0, Aggregation_none, 0, 0},
+    {nitrogen_dioxide, Variable_nitrogen_dioxide, 0, Aggregation_none, 0, 0},
+    {sulphur_dioxide, Variable_sulphur_dioxide, 0, Aggregation_none, 0, 0},
+    {ozone, Variable_ozone, 0, Aggregation_none, 0, 0},
+    {aerosol_optical_depth, Variable_aerosol_optical_depth, 0, Aggregation_none,
+     0, 0},
+    {dust, Variable_dust, 0, Aggregation_none, 0, 0},
+    {uv_index_clear_sky, Variable_uv_index_clear_sky, 0, Aggregation_none,
+     0, 0},
+    {ammonia, Variable_ammonia, 0, Aggregation_none, 0, 0},
+    {alder_pollen, Variable_alder_pollen, 0, Aggregation_none, 0, 0},
+    {birch_pollen, Variable_birch_pollen, 0, Aggregation_none, 0, 0},
+    {grass_pollen, Variable_grass_pollen, 0, Aggregation_none, 0, 0},
+    {mugwort_pollen, Variable_mugwort_pollen, 0, Aggregation_none, 0, 0},
+    {olive_pollen, Variable_olive_pollen, 0, Aggregation_none, 0, 0},
+    {ragweed_pollen, Variable_ragweed_pollen, 0, Aggregation_none, 0, 0},
+    {european_aqi, Variable_european_aqi, 0, Aggregation_none, 0, 0},
+    {us_aqi, Variable_us_aqi, 0, Aggregation_none, 0, 0},
+    {wave_height, Variable_wave_height, 0, Aggregation_none, 0, 0},
+    {wave_direction, Variable_wave_direction, 0, Aggregation_none, 0, 0},
+    {wave_period, Variable_wave_period, 0, Aggregation_none, 0, 0},
+    {wind_wave_height, Variable_wind_wave_height, 0, Aggregation_none, 0, 0},
+    {wind_wave_direction, Variable_wind_wave_direction, 0, Aggregation_none,
+     0, 0},
+    {wind_wave_period, Variable_wind_wave_period, 0, Aggregation_none, 0, 0},
+    {wind_wave_peak_period, Variable_wind_wave_peak_period, 0, Aggregation_none,
+     0, 0},
+    {swell_wave_height, Variable_swell_wave_height, 0, Aggregation_none, 0, 0},
+    {swell_wave_direction, Variable_swell_wave_direction, 0, Aggregation_none,
+     0, 0},
+    {swell_wave_period, Variable_swell_wave_period, 0, Aggregation_none, 0, 0},
+    {swell_wave_peak_period, Variable_swell_wave_peak_period, 0,
+     Aggregation_none, 0, 0},
+    {ocean_current_velocity, Variable_ocean_current_velocity, 0,
+     Aggregation_none, 0, 0},
+    {ocean_current_direction, Variable_ocean_current_direction, 0,
+     Aggregation_none, 0, 0},
+    {wave_height_max, Variable_wave_height, 0, Aggregation_maximum, 0, 0},
+    {wave_direction_dominant, Variable_wave_direction, 0, Aggregation_dominant,
+     0, 0},
+    {wave_period_max, Variable_wave_period, 0, Aggregation_maximum, 0, 0},
+};
+
+constexpr bool in_param_order() {
+  for (size_t i = 0; i < ARRAY_LENGTH(descriptors); ++i) {
+    if (descriptors[i].param != (TimeParam)i)
+      return false;
+  }
+  return true;
+}
+
+static_assert(ARRAY_LENGTH(descriptors) == max_params,
+              "one descriptor per TimeParam");
+static_assert(in_param_order(), "descriptors out of TimeParam order");
+
+bool same_place(const Descriptor &d, const VariableWithValues *v) {
+  return d.variable == v->variable() && d.altitude == v->altitude() &&
+         d.depth == v->depth() && d.depth_to == v->depth_to();
+}
+
+} // namespace
+
+TimeParam TimeParamOf(const VariableWithValues *variable) {
+  if (!variable || variable->variable() == Variable_undefined)
+    return undefined;
+  // Some daily values carry an aggregation their TimeParam name does not
+  // spell out, they fall back to the unaggregated param.
+  TimeParam fallback = undefined;
+  for (const Descriptor &d : descriptors) {
+    if (!same_place(d, variable))
+      continue;
+    if (d.aggregation == variable->aggregation())
+      return d.param;
+    if (d.aggregation == Aggregation_none)
+      fallback = d.param;
+  }
+  return fallback;
+}
+
+TimeAxis::TimeAxis(const VariablesWithTime *section) {
+  if (!section)
+    return;
+  _start = section->time();
+  _interval = section->interval();
+  if (_interval > 0 && section->time_end() > _start)
+    _size = (section->time_end() - _start + _interval - 1) / _interval;
+  else
+    _size = 1;
+}
+
+void SectionIndex::build(const VariablesWithTime *section) {
+  _section = section;
+  for (auto &variable : _variables)
+    variable = nullptr;
+  _members.clear();
+  if (!section || !section->variables())
+    return;
+  for (const VariableWithValues *variable : *section->variables()) {
+    const TimeParam param = TimeParamOf(variable);
+    if (param == undefined)
+      continue;
+    const int member = variable->ensemble_member();
+    if (!member) {
+      if (!_variables[param])
+        _variables[param] = variable;
+    } else {
+      _members.push_back({param, member, variable});
+    }
+  }
+  // Stable, so the first of duplicates stays first as for member 0.
+  std::stable_sort(_members.begin(), _members.end(),
+                   [](const Member &a, const Member &b) {
+                     return a.param != b.param ? a.param < b.param
+                                               : a.member < b.member;
+                   });
+}
+
+const VariableWithValues *SectionIndex::find_member(TimeParam param,
+                                                    int member) const {
+  const auto it = std::lower_bound(
+      _members.begin(), _members.end(), std::make_pair(param, member),
+      [](const Member &a, const std::pair<TimeParam, int> &b) {
+        return a.param != b.first ? a.param < b.first : a.member < b.second;
+      });
+  if (it == _members.end() || it->param != param || it->member != member)
+    return nullptr;
+  return it->variable;
+}
+
+Span<float> SectionIndex::values(TimeParam param, int member) const {
+  const VariableWithValues *variable = find(param, member);
+  if (!variable || !variable->values())
+    return Span<float>();
+  return Span<float>(variable->values()->data(), variable->values()->size());
+}
+
+Span<int64_t> SectionIndex::values_int64(TimeParam param, int member) const {
+  const VariableWithValues *variable = find(param, member);
+  if (!variable || !variable->values_int64())
+    return Span<int64_t>();
+  return Span<int64_t>(variable->values_int64()->data(),
+                       variable->values_int64()->size());
+}
+
+float SectionIndex::value(TimeParam param, float fallback) const {
+  const VariableWithValues *variable = find(param);
+  return variable ? variable->value() : fallback;
+}
+
+Span<float> SectionView::values(TimeParam param) const {
+  return find(param) ? window(_index->values(param)) : Span<float>();
+}
+
+Span<int64_t> SectionView::values_int64(TimeParam param) const {
+  return find(param) ? window(_index->values_int64(param)) : Span<int64_t>();
+}
+
+float SectionView::value(TimeParam param, float fallback) const {
+  return find(param) ? _index->value(param, fallback) : fallback;
+}
+
+TimeAxis SectionView::time() const {
+  if (!_index)
+    return TimeAxis();
+  const TimeAxis axis = _index->time();
+  // Sections without interval have a single timestamp, nothing to cut.
+  if (!axis.interval())
+    return axis;
+  const size_t first = _first < axis.size() ? _first : axis.size();
+  const size_t count =
+      _count < axis.size() - first ? _count : axis.size() - first;
+  return TimeAxis(axis[first], axis.interval(), count);
+}
+
+void ResponseIndex::build(const WeatherApiResponse *response) {
+  _current.build(response ? response->current() : nullptr);
+  _hourly.build(response ? response->hourly() : nullptr);
+  _daily.build(response ? response->daily() : nullptr);
+  _minutely_15.build(response ? response->minutely_15() : nullptr);
+}
+
+} // namespace OM_SDK
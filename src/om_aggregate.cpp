@@ -0,0 +1,277 @@
+#include "om_aggregate.hpp"
+#include <limits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace OM_SDK {
+
+namespace {
+
+constexpr size_t LANES = 8;
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+inline float or_zero(float value) { return value == value ? value : 0.f; }
+
+// Per lane accumulators shared by every path. A lane only ever sees the
+// values at its index modulo LANES, in array order.
+struct Accumulator {
+  float sum[LANES] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+  float min[LANES] = {INF, INF, INF, INF, INF, INF, INF, INF};
+  float max[LANES] = {-INF, -INF, -INF, -INF, -INF, -INF, -INF, -INF};
+  size_t count{0};
+
+  void add(size_t lane, float value) {
+    if (value != value)
+      return;
+    sum[lane] += value;
+    min[lane] = value < min[lane] ? value : min[lane];
+    max[lane] = value > max[lane] ? value : max[lane];
+    ++count;
+  }
+
+  void add_tail(const float *values, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      add(i % LANES, values[i]);
+  }
+
+  Summary finish() const {
+    Summary summary;
+    summary.count = count;
+    if (!count)
+      return summary;
+    summary.sum = ((sum[0] + sum[1]) + (sum[2] + sum[3])) +
+                  ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+    summary.min = min[0];
+    summary.max = max[0];
+    for (size_t lane = 1; lane < LANES; ++lane) {
+      summary.min = min[lane] < summary.min ? min[lane] : summary.min;
+      summary.max = max[lane] > summary.max ? max[lane] : summary.max;
+    }
+    return summary;
+  }
+};
+
+#if defined(__AVX2__)
+
+Summary summarize_simd(const float *values, size_t count) {
+  Accumulator acc;
+  const __m256 inf = _mm256_set1_ps(INF);
+  const __m256 ninf = _mm256_set1_ps(-INF);
+  __m256 sum = _mm256_setzero_ps();
+  __m256 min = inf;
+  __m256 max = ninf;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    const __m256 v = _mm256_loadu_ps(values + i);
+    const __m256 valid = _mm256_cmp_ps(v, v, _CMP_ORD_Q);
+    sum = _mm256_add_ps(sum, _mm256_and_ps(v, valid));
+    min = _mm256_min_ps(_mm256_blendv_ps(inf, v, valid), min);
+    max = _mm256_max_ps(_mm256_blendv_ps(ninf, v, valid), max);
+    acc.count += __builtin_popcount(_mm256_movemask_ps(valid));
+  }
+  _mm256_storeu_ps(acc.sum, sum);
+  _mm256_storeu_ps(acc.min, min);
+  _mm256_storeu_ps(acc.max, max);
+  acc.add_tail(values, i, count);
+  return acc.finish();
+}
+
+template <int Predicate>
+size_t count_simd(const float *values, size_t count, float threshold) {
+  const __m256 t = _mm256_set1_ps(threshold);
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    const __m256 v = _mm256_loadu_ps(values + i);
+    n += __builtin_popcount(
+        _mm256_movemask_ps(_mm256_cmp_ps(v, t, Predicate)));
+  }
+  for (; i < count; ++i)
+    n += Predicate == _CMP_GT_OQ ? values[i] > threshold
+                                 : values[i] < threshold;
+  return n;
+}
+
+size_t count_above_simd(const float *values, size_t count, float threshold) {
+  return count_simd<_CMP_GT_OQ>(values, count, threshold);
+}
+
+size_t count_below_simd(const float *values, size_t count, float threshold) {
+  return count_simd<_CMP_LT_OQ>(values, count, threshold);
+}
+
+#elif defined(__SSE2__)
+
+struct Lanes4 {
+  __m128 sum;
+  __m128 min;
+  __m128 max;
+};
+
+inline size_t add4(Lanes4 *lanes, const float *values, __m128 inf,
+                   __m128 ninf) {
+  const __m128 v = _mm_loadu_ps(values);
+  const __m128 valid = _mm_cmpord_ps(v, v);
+  const __m128 kept = _mm_and_ps(v, valid);
+  lanes->sum = _mm_add_ps(lanes->sum, kept);
+  lanes->min =
+      _mm_min_ps(_mm_or_ps(kept, _mm_andnot_ps(valid, inf)), lanes->min);
+  lanes->max =
+      _mm_max_ps(_mm_or_ps(kept, _mm_andnot_ps(valid, ninf)), lanes->max);
+  return __builtin_popcount(_mm_movemask_ps(valid));
+}
+
+// Two 4-wide registers stand for the 8 lanes.
+Summary summarize_simd(const float *values, size_t count) {
+  Accumulator acc;
+  const __m128 inf = _mm_set1_ps(INF);
+  const __m128 ninf = _mm_set1_ps(-INF);
+  Lanes4 low = {_mm_setzero_ps(), inf, ninf};
+  Lanes4 high = low;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    acc.count += add4(&low, values + i, inf, ninf);
+    acc.count += add4(&high, values + i + 4, inf, ninf);
+  }
+  _mm_storeu_ps(acc.sum, low.sum);
+  _mm_storeu_ps(acc.min, low.min);
+  _mm_storeu_ps(acc.max, low.max);
+  _mm_storeu_ps(acc.sum + 4, high.sum);
+  _mm_storeu_ps(acc.min + 4, high.min);
+  _mm_storeu_ps(acc.max + 4, high.max);
+  acc.add_tail(values, i, count);
+  return acc.finish();
+}
+
+size_t count_above_simd(const float *values, size_t count, float threshold) {
+  const __m128 t = _mm_set1_ps(threshold);
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    n += __builtin_popcount(
+        _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), t)));
+  for (; i < count; ++i)
+    n += values[i] > threshold;
+  return n;
+}
+
+size_t count_below_simd(const float *values, size_t count, float threshold) {
+  const __m128 t = _mm_set1_ps(threshold);
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    n += __builtin_popcount(
+        _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(values + i), t)));
+  for (; i < count; ++i)
+    n += values[i] < threshold;
+  return n;
+}
+
+#endif
+
+} // namespace
+
+const char *AggregateBackend() {
+#if defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+Summary SummarizeScalar(const float *values, size_t count) {
+  Accumulator acc;
+  acc.add_tail(values, 0, count);
+  return acc.finish();
+}
+
+size_t CountAboveScalar(const float *values, size_t count, float threshold) {
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i)
+    n += values[i] > threshold;
+  return n;
+}
+
+size_t CountBelowScalar(const float *values, size_t count, float threshold) {
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i)
+    n += values[i] < threshold;
+  return n;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+Summary Summarize(const float *values, size_t count) {
+  return summarize_simd(values, count);
+}
+
+size_t CountAbove(const float *values, size_t count, float threshold) {
+  return count_above_simd(values, count, threshold);
+}
+
+size_t CountBelow(const float *values, size_t count, float threshold) {
+  return count_below_simd(values, count, threshold);
+}
+#else
+Summary Summarize(const float *values, size_t count) {
+  return SummarizeScalar(values, count);
+}
+
+size_t CountAbove(const float *values, size_t count, float threshold) {
+  return CountAboveScalar(values, count, threshold);
+}
+
+size_t CountBelow(const float *values, size_t count, float threshold) {
+  return CountBelowScalar(values, count, threshold);
+}
+#endif
+
+size_t SummarizeWindows(const float *values, size_t count, size_t window,
+                        Summary *output, size_t max) {
+  if (!window)
+    return 0;
+  size_t written = 0;
+  for (size_t start = 0; start < count && written < max; start += window) {
+    const size_t size = count - start < window ? count - start : window;
+    output[written++] = Summarize(values + start, size);
+  }
+  return written;
+}
+
+size_t RollingSum(const float *values, size_t count, size_t window,
+                  float *output, size_t max) {
+  if (!window || window > count || !max)
+    return 0;
+  // One pass, adding the value entering the window and subtracting the one
+  // leaving it. A double holds sums of floats a few decades apart exactly,
+  // so the sums do not drift along the array.
+  double sum = 0.;
+  for (size_t i = 0; i < window; ++i)
+    sum += or_zero(values[i]);
+  size_t written = 0;
+  output[written++] = float(sum);
+  for (size_t i = window; i < count && written < max; ++i) {
+    sum += or_zero(values[i]);
+    sum -= or_zero(values[i - window]);
+    output[written++] = float(sum);
+  }
+  return written;
+}
+
+size_t Crossings(const float *values, size_t count, float threshold) {
+  size_t crossings = 0;
+  int side = -1;
+  for (size_t i = 0; i < count; ++i) {
+    if (values[i] != values[i])
+      continue;
+    const int current = values[i] >= threshold;
+    if (side >= 0 && current != side)
+      ++crossings;
+    side = current;
+  }
+  return crossings;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,203 @@
+#include "om_arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <sdkconfig.h>
+
+namespace OM_SDK {
+
+// Flatbuffers expect 8 byte aligned buffers for their 64-bit fields.
+static const size_t ALIGNMENT = 8;
+
+static size_t align(size_t offset) {
+  return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+static uint8_t *allocate(size_t capacity) {
+#if CONFIG_OPEN_METEO_RESPONSE_IN_PSRAM
+  return (uint8_t *)heap_caps_malloc(capacity,
+                                     MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#else
+  return (uint8_t *)malloc(capacity);
+#endif
+}
+
+ResponseArena::ResponseArena(void *buffer, size_t capacity)
+    : _buffer((uint8_t *)buffer), _capacity(buffer ? capacity : 0),
+      _owned(false) {
+  // Start on an aligned address, the head of the block is lost otherwise.
+  _base = align((uintptr_t)_buffer) - (uintptr_t)_buffer;
+  if (_base > _capacity)
+    _base = _capacity;
+  _top = _base;
+}
+
+ResponseArena::ResponseArena(size_t capacity)
+    : _buffer(allocate(capacity)), _capacity(_buffer ? capacity : 0),
+      _owned(true) {}
+
+ResponseArena::~ResponseArena() {
+  if (_owned)
+    free(_buffer);
+}
+
+size_t ResponseArena::used() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _used;
+}
+
+size_t ResponseArena::peak() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _peak;
+}
+
+size_t ResponseArena::live() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _live;
+}
+
+size_t ResponseArena::largest_free() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  size_t largest = _capacity - _top;
+  for (size_t offset = _base; offset < _top; offset += header(offset)->size) {
+    if (!header(offset)->live)
+      largest = std::max(largest, header(offset)->size);
+  }
+  return largest > HEADER ? (largest - HEADER) & ~(ALIGNMENT - 1) : 0;
+}
+
+void ResponseArena::reset_peak() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _peak = _used;
+}
+
+ResponseArena::Header *ResponseArena::header(size_t offset) const {
+  return (Header *)(_buffer + offset);
+}
+
+void ResponseArena::link(size_t offset) {
+  const size_t next = offset + header(offset)->size;
+  if (next < _top)
+    header(next)->previous = header(offset)->size;
+}
+
+size_t ResponseArena::take(size_t bytes) {
+  for (size_t offset = _base; _holes && offset < _top;
+       offset += header(offset)->size) {
+    Header *block = header(offset);
+    if (block->live || block->size < bytes)
+      continue;
+    // Split when the rest can hold a response of its own.
+    if (block->size - bytes > HEADER) {
+      *header(offset + bytes) = {block->size - bytes, bytes, false};
+      block->size = bytes;
+      link(offset + bytes);
+    } else {
+      --_holes;
+    }
+    block->live = true;
+    return offset;
+  }
+  // Block sizes are multiples of ALIGNMENT, _top stays aligned.
+  const size_t start = _top;
+  if (bytes > _capacity - start)
+    return NONE;
+  *header(start) = {bytes, start == _base ? 0 : _last, true};
+  _top = start + bytes;
+  _last = bytes;
+  return start;
+}
+
+void ResponseArena::give(size_t offset) {
+  Header *block = header(offset);
+  block->live = false;
+  ++_holes;
+  const size_t next = offset + block->size;
+  if (next < _top && !header(next)->live) {
+    block->size += header(next)->size;
+    --_holes;
+  }
+  if (offset > _base && !header(offset - block->previous)->live) {
+    const size_t size = block->size;
+    offset -= block->previous;
+    block = header(offset);
+    block->size += size;
+    --_holes;
+  }
+  if (offset + block->size < _top) {
+    link(offset);
+  } else {
+    // The block before a hole is live, it becomes the last one.
+    _top = offset;
+    _last = block->previous;
+    --_holes;
+  }
+}
+
+uint8_t *ResponseArena::grow(uint8_t *block, size_t size, size_t capacity) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (capacity > _capacity)
+    return nullptr;
+  const size_t bytes = HEADER + align(capacity);
+  size_t offset;
+  if (block) {
+    offset = block - _buffer - HEADER;
+    Header *current = header(offset);
+    const size_t end = offset + current->size;
+    if (current->size >= bytes)
+      return block;
+    if (end == _top && bytes <= _capacity - offset) {
+      // The newest block grows in place.
+      _used += bytes - current->size;
+      current->size = bytes;
+      _top = offset + bytes;
+      _last = bytes;
+    } else if (end < _top && !header(end)->live &&
+               current->size + header(end)->size >= bytes) {
+      // Into the hole after it, splitting off what is left. Holes are
+      // never last, there is a block after it.
+      const size_t rest = current->size + header(end)->size - bytes;
+      _used += bytes - current->size;
+      if (rest > HEADER) {
+        current->size = bytes;
+        *header(offset + bytes) = {rest, bytes, false};
+        link(offset + bytes);
+      } else {
+        _used += rest;
+        current->size += header(end)->size;
+        --_holes;
+        link(offset);
+      }
+    } else {
+      const size_t start = take(bytes);
+      if (start == NONE)
+        return nullptr;
+      memcpy(_buffer + start + HEADER, block, size);
+      _used += header(start)->size - current->size;
+      give(offset);
+      offset = start;
+    }
+  } else {
+    offset = take(bytes);
+    if (offset == NONE)
+      return nullptr;
+    _used += header(offset)->size;
+    ++_live;
+  }
+  if (_used > _peak)
+    _peak = _used;
+  return _buffer + offset + HEADER;
+}
+
+void ResponseArena::release(uint8_t *block) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_live || !block)
+    return;
+  const size_t offset = block - _buffer - HEADER;
+  _used -= header(offset)->size;
+  --_live;
+  give(offset);
+}
+
+} // namespace OM_SDK
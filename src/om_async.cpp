@@ -0,0 +1,136 @@
+#include "om_async.hpp"
+#include <algorithm>
+#include <utility>
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#endif
+
+namespace OM_SDK {
+
+AsyncClient::AsyncClient(Client *client, size_t stack_size)
+    : _client(client), _base_timeout_ms(client->timeout_ms()) {
+#ifdef ESP_PLATFORM
+  // The config is the calling task's default for the threads it creates,
+  // it gets back its own once the worker exists.
+  esp_pthread_cfg_t saved;
+  if (esp_pthread_get_cfg(&saved) != ESP_OK)
+    saved = esp_pthread_get_default_config();
+  esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+  cfg.stack_size = stack_size;
+  cfg.thread_name = "om_async";
+  esp_pthread_set_cfg(&cfg);
+#else
+  (void)stack_size;
+#endif
+  _worker = std::thread(&AsyncClient::run, this);
+#ifdef ESP_PLATFORM
+  esp_pthread_set_cfg(&saved);
+#endif
+}
+
+AsyncClient::~AsyncClient() {
+  std::deque<Job> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    _current_cancelled = _current != 0;
+    cancelled.swap(_queue);
+  }
+  _cv.notify_all();
+  _worker.join();
+  for (Job &job : cancelled) {
+    if (job.callback)
+      job.callback(status_cancelled, nullptr);
+  }
+}
+
+RequestId AsyncClient::submit(const OpenMeteoParams &params,
+                              WeatherCallback callback, uint32_t timeout_ms) {
+  Job job = {0, params, std::move(callback),
+             Clock::now() + std::chrono::milliseconds(timeout_ms),
+             timeout_ms > 0};
+  RequestId id;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    id = _next_id++;
+    if (!_next_id)
+      _next_id = 1;
+    job.id = id;
+    _queue.push_back(std::move(job));
+  }
+  _cv.notify_one();
+  return id;
+}
+
+bool AsyncClient::cancel(RequestId id) {
+  WeatherCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_current == id) {
+      _current_cancelled = true;
+      return true;
+    }
+    auto it = std::find_if(_queue.begin(), _queue.end(),
+                           [id](const Job &job) { return job.id == id; });
+    if (it == _queue.end())
+      return false;
+    callback = std::move(it->callback);
+    _queue.erase(it);
+  }
+  if (callback)
+    callback(status_cancelled, nullptr);
+  return true;
+}
+
+size_t AsyncClient::pending() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _queue.size() + (_current ? 1 : 0);
+}
+
+void AsyncClient::run() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this] { return _stop || !_queue.empty(); });
+      if (_stop)
+        return;
+      job = std::move(_queue.front());
+      _queue.pop_front();
+      _current = job.id;
+      _current_cancelled = false;
+    }
+
+    int status_code = status_timeout;
+    SharedResponse response;
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline -
+                                                              Clock::now());
+    if (!job.has_deadline || remaining.count() > 0) {
+      _client->set_timeout_ms(
+          job.has_deadline
+              ? std::min<int>(remaining.count(), _base_timeout_ms)
+              : _base_timeout_ms);
+      status_code = _client->get_weather(&job.params, &response);
+    }
+
+    bool cancelled;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      cancelled = _current_cancelled;
+      _current = 0;
+    }
+    if (cancelled) {
+      status_code = status_cancelled;
+      response.reset();
+    } else if (job.has_deadline && Clock::now() > job.deadline) {
+      // Finished, but too late for the caller.
+      status_code = status_timeout;
+      response.reset();
+    }
+    if (job.callback)
+      job.callback(status_code, std::move(response));
+  }
+}
+
+} // namespace OM_SDK
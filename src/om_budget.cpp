@@ -0,0 +1,151 @@
+#include "om_budget.hpp"
+#include "om_endpoint.hpp"
+#include "om_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <thread>
+
+namespace OM_SDK {
+
+float QueryWeight(const Endpoint &endpoint, const OpenMeteoParams &params,
+                  size_t locations) {
+  const size_t variables =
+      ((params.hourly_set | TimeParamSet::from_array(params.hourly)) &
+       endpoint.hourly)
+          .size() +
+      ((params.daily_set | TimeParamSet::from_array(params.daily)) &
+       endpoint.daily)
+          .size() +
+      ((params.minutely_15_set | TimeParamSet::from_array(params.minutely_15)) &
+       endpoint.minutely_15)
+          .size() +
+      ((params.current_set | TimeParamSet::from_array(params.current)) &
+       endpoint.current)
+          .size();
+  float days;
+  if (params.start_date && params.end_date)
+    days = std::abs(difftime(params.end_date, params.start_date)) / 86400 + 1;
+  else
+    days = params.past_days + (params.forecast_days
+                                   ? params.forecast_days
+                                   : endpoint.forecast_days_default);
+  return std::max<size_t>(locations, 1) * std::max(1.f, variables / 10.f) *
+         std::max(1.f, days / 14.f);
+}
+
+RequestBudget::RequestBudget(const BudgetLimits &limits, NowMs now,
+                             SleepMs sleep, uint32_t seed)
+    : _limits(limits), _now(std::move(now)), _sleep(std::move(sleep)),
+      _buckets{{limits.per_minute, limits.per_minute,
+                limits.per_minute / 60000.},
+               {limits.per_hour, limits.per_hour, limits.per_hour / 3600000.},
+               {limits.per_day, limits.per_day, limits.per_day / 86400000.}},
+      _random(seed) {
+  if (!_now)
+    _now = [] { return MonotonicUs() / 1000; };
+  if (!_sleep)
+    _sleep = [](int64_t ms) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    };
+  _last_ms = _now();
+}
+
+void RequestBudget::refill(int64_t now) {
+  const int64_t elapsed = now - _last_ms;
+  if (elapsed <= 0)
+    return;
+  for (Bucket &bucket : _buckets)
+    bucket.tokens =
+        std::min(bucket.capacity, bucket.tokens + elapsed * bucket.per_ms);
+  _last_ms = now;
+}
+
+bool RequestBudget::try_acquire(float weight, int64_t *wait_ms) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const int64_t now = _now();
+  refill(now);
+  int64_t wait = std::max<int64_t>(_blocked_until - now, 0);
+  for (const Bucket &bucket : _buckets) {
+    // A query larger than a window only waits for the window to be full.
+    const double needed = std::min<double>(weight, bucket.capacity);
+    if (bucket.tokens < needed && bucket.per_ms > 0.)
+      wait = std::max<int64_t>(
+          wait, (int64_t)((needed - bucket.tokens) / bucket.per_ms) + 1);
+  }
+  if (wait_ms)
+    *wait_ms = wait;
+  if (wait)
+    return false;
+  for (Bucket &bucket : _buckets)
+    bucket.tokens -= std::min<double>(weight, bucket.capacity);
+  ++_stats.admitted;
+  _stats.weight += weight;
+  return true;
+}
+
+bool RequestBudget::acquire(float weight) {
+  int64_t waited = 0;
+  int64_t wait = 0;
+  while (!try_acquire(weight, &wait)) {
+    if (waited + wait > _limits.max_wait_ms) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_stats.rejected;
+      return false;
+    }
+    if (!waited) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_stats.waited;
+    }
+    _sleep(wait);
+    waited += wait;
+  }
+  return true;
+}
+
+void RequestBudget::on_response(int status_code, uint32_t retry_after_s) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (status_code != 429) {
+    if (status_code > 0 && status_code < 500)
+      _failures = 0;
+    return;
+  }
+  ++_stats.throttled;
+  ++_failures;
+  int64_t delay = std::min<int64_t>(
+      _limits.max_backoff_ms,
+      int64_t(_limits.backoff_ms) << std::min<uint32_t>(_failures - 1, 20));
+  delay -= _random() % (delay / 2 + 1);
+  delay = std::max<int64_t>(delay, int64_t(retry_after_s) * 1000);
+  const int64_t now = _now();
+  refill(now);
+  // The server counts calls this budget did not see, start the minute over.
+  _buckets[0].tokens = 0.;
+  _blocked_until = std::max(_blocked_until, now + delay);
+}
+
+bool RequestBudget::low() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const int64_t now = _now();
+  refill(now);
+  if (now < _blocked_until)
+    return true;
+  for (const Bucket &bucket : _buckets) {
+    if (bucket.tokens < bucket.capacity * _limits.low_fraction)
+      return true;
+  }
+  return false;
+}
+
+int64_t RequestBudget::backoff_remaining() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::max<int64_t>(_blocked_until - _now(), 0);
+}
+
+RequestBudget::Stats RequestBudget::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,125 @@
+#include "om_cache.hpp"
+#include "open_meteo.hpp"
+#include <utility>
+
+namespace OM_SDK {
+
+uint64_t hash_query(const char *query) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char *c = query; *c; ++c) {
+    hash ^= (uint8_t)*c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+time_t response_expiry(const WeatherResponse &response, time_t now,
+                       uint32_t ttl_seconds) {
+  uint32_t ttl = ttl_seconds;
+  if (response) {
+    const uint32_t interval = ModelUpdateInterval(response->model());
+    if (interval)
+      ttl = interval;
+  }
+  return now + ttl;
+}
+
+ForecastCache::ForecastCache(size_t byte_budget, uint32_t ttl_seconds)
+    : _byte_budget(byte_budget), _ttl_seconds(ttl_seconds) {}
+
+void ForecastCache::evict(std::list<Entry>::iterator entry) {
+  _stats.bytes -= entry->bytes;
+  _index.erase(entry->key);
+  _lru.erase(entry);
+  _stats.entries = _lru.size();
+}
+
+SharedResponse ForecastCache::find(uint64_t key, time_t now) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it == _index.end()) {
+    ++_stats.misses;
+    return nullptr;
+  }
+  if (it->second->expires <= now) {
+    // Entries kept for revalidation are looked up again until then.
+    if (!it->second->expired)
+      ++_stats.expirations;
+    it->second->expired = true;
+    ++_stats.misses;
+    if (it->second->validators.empty())
+      evict(it->second);
+    return nullptr;
+  }
+  _lru.splice(_lru.begin(), _lru, it->second);
+  ++_stats.hits;
+  return it->second->response;
+}
+
+SharedResponse ForecastCache::find_stale(uint64_t key,
+                                        Validators *validators) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it == _index.end() || it->second->validators.empty())
+    return nullptr;
+  *validators = it->second->validators;
+  return it->second->response;
+}
+
+bool ForecastCache::refresh(uint64_t key, time_t now) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it == _index.end())
+    return false;
+  it->second->expires =
+      response_expiry(*it->second->response, now, _ttl_seconds);
+  it->second->expired = false;
+  _lru.splice(_lru.begin(), _lru, it->second);
+  return true;
+}
+
+void ForecastCache::insert(uint64_t key, SharedResponse response, time_t now,
+                           const Validators *validators) {
+  if (!response)
+    return;
+  const size_t bytes = response->capacity();
+  if (bytes > _byte_budget)
+    return;
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it != _index.end())
+    evict(it->second);
+  while (!_lru.empty() && _stats.bytes + bytes > _byte_budget) {
+    evict(std::prev(_lru.end()));
+    ++_stats.evictions;
+  }
+  const time_t expires = response_expiry(*response, now, _ttl_seconds);
+  _lru.push_front({key, std::move(response), expires, bytes, {}, false});
+  if (validators)
+    _lru.front().validators = *validators;
+  _index[key] = _lru.begin();
+  _stats.bytes += bytes;
+  _stats.entries = _lru.size();
+}
+
+void ForecastCache::erase(uint64_t key) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _index.find(key);
+  if (it != _index.end())
+    evict(it->second);
+}
+
+void ForecastCache::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _lru.clear();
+  _index.clear();
+  _stats.bytes = 0;
+  _stats.entries = 0;
+}
+
+CacheStats ForecastCache::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,471 @@
+#include "om_client.hpp"
+#include "om_internal.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <strings.h>
+#include <utility>
+
+namespace OM_SDK {
+
+static esp_err_t read_exact(Transport *transport, uint8_t *buffer,
+                            size_t count, size_t *received) {
+  *received = 0;
+  while (*received < count) {
+    const int read = transport->read(buffer + *received, count - *received);
+    if (read < 0)
+      return ESP_FAIL;
+    if (read == 0)
+      return ESP_ERR_INVALID_SIZE;
+    *received += read;
+  }
+  return ESP_OK;
+}
+
+static bool grow(WeatherResponse *output, size_t capacity,
+                 [[maybe_unused]] RequestTrace *trace) {
+  OM_TRACE(if (trace && capacity > output->capacity()) ++trace->buffer_grows;)
+  return output->reserve(capacity);
+}
+
+// Reads the body message by message: the size prefix first, then exactly
+// that many bytes straight into the response buffer, so a message is never
+// copied or over-allocated. The messages are verified once complete.
+static esp_err_t read_body(Transport *transport, int64_t content_length,
+                           WeatherResponse *output, RequestTrace *trace) {
+  output->clear();
+  if (content_length > CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE) {
+    ESP_LOGE(TAG, "Response too large: %lld", (long long)content_length);
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (content_length > 0 && !grow(output, content_length, trace))
+    return ESP_ERR_NO_MEM;
+  while (true) {
+    uint8_t prefix[sizeof(flatbuffers::uoffset_t)];
+    size_t received = 0;
+    esp_err_t err = read_exact(transport, prefix, sizeof(prefix), &received);
+    if (err == ESP_ERR_INVALID_SIZE && received == 0 && output->size() > 0)
+      return ESP_OK;
+    if (err != ESP_OK)
+      return err;
+    const size_t message_size = flatbuffers::GetPrefixedSize(prefix);
+    const size_t total = output->size() + sizeof(prefix) + message_size;
+    if (message_size == 0 || total > CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE) {
+      ESP_LOGE(TAG, "Invalid message size: %u", (unsigned)message_size);
+      return ESP_ERR_INVALID_SIZE;
+    }
+    if (!grow(output, total, trace))
+      return ESP_ERR_NO_MEM;
+    memcpy(output->tail(), prefix, sizeof(prefix));
+    output->commit(sizeof(prefix));
+    err = read_exact(transport, output->tail(), message_size, &received);
+    output->commit(received);
+    if (err != ESP_OK)
+      return err;
+  }
+}
+
+static int url_too_long() {
+  ESP_LOGE(TAG, "URL longer than %d bytes", CONFIG_OPEN_METEO_MAX_URL_LENGTH);
+  return -1;
+}
+
+Client::~Client() {
+  if (_transport)
+    _transport->set_listener(nullptr);
+}
+
+int Client::get_weather(OpenMeteoParams *params, WeatherResponse *output) {
+  return get(forecast_endpoint, params, output);
+}
+
+int Client::get(const Endpoint &endpoint, OpenMeteoParams *params,
+                WeatherResponse *output) {
+  if (!params)
+    return -1;
+  validateParams(endpoint, params);
+  const std::vector<DateRange> ranges =
+      SplitDateRange(endpoint, params->start_date, params->end_date);
+  if (ranges.size() > 1)
+    return fetch_ranges(endpoint, params, ranges.data(), ranges.size(),
+                        output);
+  const Location location = {params->latitude, params->longitude};
+  if (!build_url(endpoint, params, &location, 1))
+    return url_too_long();
+  return request(output);
+}
+
+void Client::close() {
+  if (_transport)
+    _transport->close();
+  _connected = false;
+}
+
+void Client::set_timeout_ms(int timeout_ms) {
+  _timeout_ms = timeout_ms;
+  if (_transport)
+    _transport->set_timeout_ms(timeout_ms);
+}
+
+void Client::on_connected() {
+  _connected = true;
+  _connected_this_request = true;
+  ++_connections_opened;
+  OM_TRACE(_trace.connected_us = MonotonicUs();)
+}
+
+void Client::on_disconnected() { _connected = false; }
+
+void Client::on_header(const char *key, const char *value) {
+  if (!strcasecmp(key, "Connection") && !strcasecmp(value, "close")) {
+    _server_closing = true;
+  } else if (!strcasecmp(key, "ETag")) {
+    snprintf(_validators.etag, sizeof(_validators.etag), "%s", value);
+  } else if (!strcasecmp(key, "Last-Modified")) {
+    snprintf(_validators.last_modified, sizeof(_validators.last_modified),
+             "%s", value);
+  } else if (!strcasecmp(key, "Retry-After")) {
+    // Delta seconds only, an HTTP date falls back to the budget's backoff.
+    _retry_after_s = strtoul(value, nullptr, 10);
+  }
+}
+
+int Client::perform(WeatherResponse *output) {
+  _connected_this_request = false;
+  _server_closing = false;
+  _validators = {};
+  _retry_after_s = 0;
+  int64_t content_length = 0;
+  bool complete = false;
+  RequestTrace *trace = nullptr;
+  OM_TRACE(trace = &_trace; ++_trace.attempts;
+           _trace.connected_us = _trace.sent_us = 0;
+           _trace.headers_us = _trace.body_us = 0;)
+  esp_err_t err = _transport->open();
+  const bool opened = err == ESP_OK;
+  int body_failed = 0;
+  if (opened) {
+    OM_TRACE(_trace.sent_us = MonotonicUs();)
+    content_length = _transport->fetch_headers();
+    OM_TRACE(_trace.headers_us = MonotonicUs();)
+  }
+  if (!opened) {
+    ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
+  } else if (content_length < 0) {
+    ESP_LOGE(TAG, "HTTP client fetch headers failed");
+  } else if (output && _transport->status_code() == 200) {
+    sample_heap();
+    err = read_body(_transport, content_length, output, trace);
+    OM_TRACE(_trace.body_us = MonotonicUs();
+             _trace.body_bytes = output->size();)
+    if (err == ESP_OK && !output->verify(_verify)) {
+      err = ESP_ERR_INVALID_RESPONSE;
+      body_failed = status_invalid_response;
+    }
+    OM_TRACE(_trace.decode_us = MonotonicUs() - _trace.body_us;)
+    sample_heap();
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to read response: %s", esp_err_to_name(err));
+      output->reset();
+      if (!body_failed)
+        body_failed = -1;
+    } else {
+      complete = true;
+    }
+  } else {
+    // Error and 304 bodies are not flatbuffers.
+    if (output)
+      output->reset();
+    complete = _transport->flush() == ESP_OK;
+  }
+
+  // A 200 whose body did not arrive whole, or not intact, failed, and so
+  // did a request whose headers broke off.
+  const bool answered = opened && content_length >= 0;
+  const int status_code = body_failed ? body_failed
+                          : answered  ? _transport->status_code()
+                                      : -1;
+  if (!complete || _server_closing || !_transport->complete())
+    close();
+  return status_code;
+}
+
+void Client::sample_heap() {
+  const size_t free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  if (free < _memory.heap_low)
+    _memory.heap_low = free;
+}
+
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+void Client::trace_begin() {
+  if (_trace_depth++)
+    return;
+  _trace = {};
+  _trace.start_us = MonotonicUs();
+}
+
+void Client::trace_end(int status_code) {
+  if (--_trace_depth)
+    return;
+  _trace.end_us = MonotonicUs();
+  _trace.status_code = status_code;
+  _trace.outcome =
+      status_code == 200 || status_code == 304 ? _outcome : outcome_failed;
+  if (_observer)
+    _observer->on_request(_trace);
+}
+#endif
+
+bool Client::build_url(const Endpoint &endpoint,
+                       const OpenMeteoParams *params,
+                       const Location *locations, size_t count) {
+  _url.clear();
+  _url.append(_base_url ? _base_url : endpoint.host).append(endpoint.path);
+  _weight = QueryWeight(endpoint, *params, count);
+  return paramsToString(endpoint, params, locations, count, &_url);
+}
+
+int Client::request(WeatherResponse *output, const Validators *validators) {
+  ESP_LOGI(TAG, "%s", _url.c_str());
+  OM_TRACE(trace_begin();)
+  if (_budget && !_budget->acquire(_weight)) {
+    ESP_LOGW(TAG, "Request budget used up");
+    _outcome = outcome_failed;
+    OM_TRACE(trace_end(status_over_budget);)
+    return status_over_budget;
+  }
+  if (!_transport) {
+    _own_transport = DefaultTransport(_timeout_ms);
+    _transport = _own_transport.get();
+  }
+  _transport->set_listener(this);
+  if (_transport->prepare(_url.c_str()) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to init HTTP client");
+    _outcome = outcome_failed;
+    OM_TRACE(trace_end(-1);)
+    return -1;
+  }
+  if (validators && validators->etag[0])
+    _transport->set_header("If-None-Match", validators->etag);
+  else
+    _transport->delete_header("If-None-Match");
+  if (validators && validators->last_modified[0])
+    _transport->set_header("If-Modified-Since", validators->last_modified);
+  else
+    _transport->delete_header("If-Modified-Since");
+  if (output && output->arena() != _arena)
+    *output = WeatherResponse(_arena);
+  _memory = {};
+  _memory.heap_free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  _memory.heap_low = _memory.heap_free_before;
+  ++_requests;
+  const bool reusing = _connected;
+  int status_code = perform(output);
+  if (reusing && status_code <= 0 && status_code != status_invalid_response) {
+    // The server dropped the idle connection, retry on a fresh one.
+    ESP_LOGW(TAG, "Kept-alive connection lost, reconnecting");
+    close();
+    status_code = perform(output);
+  }
+  if (status_code > 0 && !_connected_this_request)
+    ++_connections_reused;
+  if (_budget)
+    _budget->on_response(status_code, _retry_after_s);
+  _memory.heap_free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  _memory.largest_free_block =
+      heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  if (_arena) {
+    _memory.arena_used = _arena->used();
+    _memory.arena_peak = _arena->peak();
+  }
+  _outcome = status_code == 200   ? outcome_fetched
+             : status_code == 304 ? outcome_not_modified
+                                  : outcome_failed;
+  OM_TRACE(trace_end(status_code);)
+  return status_code;
+}
+
+int Client::fetch_ranges(const Endpoint &endpoint,
+                         const OpenMeteoParams *params,
+                         const DateRange *ranges, size_t count,
+                         WeatherResponse *output) {
+  OM_TRACE(trace_begin();)
+  OpenMeteoParams chunk = *params;
+  const Location location = {params->latitude, params->longitude};
+  std::vector<WeatherResponse> parts;
+  parts.reserve(count);
+  int status_code = 200;
+  for (size_t i = 0; i < count && status_code == 200; ++i) {
+    chunk.start_date = ranges[i].start;
+    chunk.end_date = ranges[i].end;
+    if (!build_url(endpoint, &chunk, &location, 1)) {
+      status_code = url_too_long();
+      break;
+    }
+    parts.emplace_back(_arena);
+    // Without an output only the status is wanted, as in perform().
+    status_code = request(output ? &parts.back() : nullptr);
+  }
+  if (status_code == 200 && output) {
+    if (output->arena() != _arena)
+      *output = WeatherResponse(_arena);
+    if (!MergeTimeSeries(parts.data(), parts.size(), output)) {
+      ESP_LOGE(TAG, "Chunks of %s do not line up", endpoint.path);
+      status_code = -1;
+    }
+  }
+  OM_TRACE(trace_end(status_code);)
+  return status_code;
+}
+
+bool Client::cache_key(OpenMeteoParams *params, uint64_t *key) {
+  return cache_key(forecast_endpoint, params, key);
+}
+
+bool Client::cache_key(const Endpoint &endpoint, OpenMeteoParams *params,
+                       uint64_t *key) {
+  if (!params || !key)
+    return false;
+  validateParams(endpoint, params);
+  const Location location = {params->latitude, params->longitude};
+  if (!build_url(endpoint, params, &location, 1)) {
+    url_too_long();
+    return false;
+  }
+  *key = hash_query(_url.c_str());
+  return true;
+}
+
+int Client::get_weather(OpenMeteoParams *params, SharedResponse *output) {
+  return get(forecast_endpoint, params, output);
+}
+
+int Client::get(const Endpoint &endpoint, OpenMeteoParams *params,
+                SharedResponse *output) {
+  OM_TRACE(trace_begin();)
+  const int status_code = lookup(endpoint, params, output);
+  OM_TRACE(trace_end(status_code);)
+  return status_code;
+}
+
+int Client::lookup(const Endpoint &endpoint, OpenMeteoParams *params,
+                   SharedResponse *output) {
+  uint64_t key = 0;
+  if (!output || !cache_key(endpoint, params, &key))
+    return -1;
+  const time_t now = time(nullptr);
+  if (_cache && (*output = _cache->find(key, now))) {
+    _outcome = outcome_cache_hit;
+    return 200;
+  }
+  WeatherResponse response(_arena);
+  if (_store && _store->load(key, now, &response) &&
+      response.verify(_verify)) {
+    *output = std::make_shared<const WeatherResponse>(std::move(response));
+    if (_cache)
+      _cache->insert(key, *output, now);
+    _outcome = outcome_store_hit;
+    return 200;
+  }
+  if (_budget && _cache && _budget->low()) {
+    Validators validators;
+    if ((*output = _cache->find_stale(key, &validators))) {
+      _outcome = outcome_stale;
+      return 200;
+    }
+  }
+  if (!_coalescer)
+    return fetch(endpoint, params, key, now, output);
+  int status_code = -1;
+  if (!_coalescer->join(key, &status_code, output)) {
+    _outcome = outcome_coalesced;
+    return status_code;
+  }
+  status_code = fetch(endpoint, params, key, now, output);
+  _coalescer->complete(key, status_code, *output);
+  return status_code;
+}
+
+int Client::fetch(const Endpoint &endpoint, const OpenMeteoParams *params,
+                  uint64_t key, time_t now, SharedResponse *output) {
+  WeatherResponse response(_arena);
+  const std::vector<DateRange> ranges =
+      SplitDateRange(endpoint, params->start_date, params->end_date);
+  // Merged chunks carry no validators to revalidate with.
+  const bool chunked = ranges.size() > 1;
+  Validators validators = {};
+  SharedResponse stale = _cache && !chunked
+                             ? _cache->find_stale(key, &validators)
+                             : nullptr;
+  const int status_code =
+      chunked ? fetch_ranges(endpoint, params, ranges.data(), ranges.size(),
+                             &response)
+              : request(&response, stale ? &validators : nullptr);
+  if (status_code == 304 && stale) {
+    _cache->refresh(key, now);
+    ++_not_modified;
+    _bytes_saved += stale->size();
+    *output = std::move(stale);
+    return 200;
+  }
+  if (status_code != 200 || !response) {
+    output->reset();
+    return status_code;
+  }
+  *output = std::make_shared<const WeatherResponse>(std::move(response));
+  if (_cache)
+    _cache->insert(key, *output, now, chunked ? nullptr : &_validators);
+  if (_store)
+    _store->save(key, **output, now);
+  return status_code;
+}
+
+int Client::https_with_hostname_params(const char *path,
+                                       const OpenMeteoParams *params,
+                                       WeatherResponse *output) {
+  Endpoint endpoint = forecast_endpoint;
+  endpoint.path = path;
+  const Location location = {params->latitude, params->longitude};
+  if (!build_url(endpoint, params, &location, 1))
+    return url_too_long();
+  return request(output);
+}
+
+int Client::get_weather_batch(OpenMeteoParams *params,
+                              const Location *locations, size_t count,
+                              WeatherBatch *output) {
+  return get_batch(forecast_endpoint, params, locations, count, output);
+}
+
+int Client::get_batch(const Endpoint &endpoint, OpenMeteoParams *params,
+                      const Location *locations, size_t count,
+                      WeatherBatch *output) {
+  if (!params || !locations || !output)
+    return -1;
+  validateParams(endpoint, params);
+  output->clear();
+  int status_code = -1;
+  size_t done = 0;
+  while (done < count) {
+    size_t chunk = count - done;
+    while (!build_url(endpoint, params, locations + done, chunk)) {
+      if (chunk == 1)
+        return url_too_long();
+      chunk = (chunk + 1) / 2;
+    }
+    WeatherResponse response(_arena);
+    status_code = request(&response);
+    if (status_code != 200)
+      return status_code;
+    if (!output->append(std::move(response), chunk)) {
+      ESP_LOGE(TAG, "Expected %u locations in response", (unsigned)chunk);
+      return -1;
+    }
+    done += chunk;
+  }
+  return status_code;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,46 @@
+#include "om_coalesce.hpp"
+#include <utility>
+
+namespace OM_SDK {
+
+bool RequestCoalescer::join(uint64_t key, int *status_code,
+                            SharedResponse *output) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  auto it = _flights.find(key);
+  if (it == _flights.end()) {
+    _flights.emplace(key, std::make_shared<Flight>());
+    ++_stats.fetches;
+    _stats.in_flight = _flights.size();
+    return true;
+  }
+  // The flight leaves the map on completion, keep it alive until read.
+  std::shared_ptr<Flight> flight = it->second;
+  ++_stats.coalesced;
+  _cv.wait(lock, [&flight] { return flight->done; });
+  *status_code = flight->status_code;
+  *output = flight->response;
+  return false;
+}
+
+void RequestCoalescer::complete(uint64_t key, int status_code,
+                                SharedResponse response) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _flights.find(key);
+    if (it == _flights.end())
+      return;
+    it->second->status_code = status_code;
+    it->second->response = std::move(response);
+    it->second->done = true;
+    _flights.erase(it);
+    _stats.in_flight = _flights.size();
+  }
+  _cv.notify_all();
+}
+
+CoalescerStats RequestCoalescer::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,230 @@
+#include "om_endpoint.hpp"
+#include <cstring>
+#include <utility>
+
+namespace OM_SDK {
+
+using namespace openmeteo_sdk;
+
+namespace {
+
+typedef const VariablesWithTime *(WeatherApiResponse::*SectionOf)() const;
+
+// Noon of the local day `days` after `value`, clear of DST changes.
+time_t local_noon(time_t value, int days) {
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  timeinfo.tm_mday += days;
+  timeinfo.tm_hour = 12;
+  timeinfo.tm_min = 0;
+  timeinfo.tm_sec = 0;
+  timeinfo.tm_isdst = -1;
+  return mktime(&timeinfo);
+}
+
+bool same_variable(const VariableWithValues *a, const VariableWithValues *b) {
+  return a->variable() == b->variable() && a->unit() == b->unit() &&
+         a->altitude() == b->altitude() &&
+         a->aggregation() == b->aggregation() &&
+         a->pressure_level() == b->pressure_level() &&
+         a->depth() == b->depth() && a->depth_to() == b->depth_to() &&
+         a->ensemble_member() == b->ensemble_member() &&
+         a->previous_day() == b->previous_day();
+}
+
+// The section of every part lines up with the one before it.
+bool sections_line_up(const WeatherApiResponse *const *parts, size_t count,
+                      SectionOf section_of) {
+  const VariablesWithTime *first = (parts[0]->*section_of)();
+  const size_t variables =
+      first && first->variables() ? first->variables()->size() : 0;
+  for (size_t i = 1; i < count; ++i) {
+    const VariablesWithTime *previous = (parts[i - 1]->*section_of)();
+    const VariablesWithTime *section = (parts[i]->*section_of)();
+    if (!first && !section)
+      continue;
+    if (!first || !section)
+      return false;
+    const size_t size = section->variables() ? section->variables()->size() : 0;
+    if (size != variables || section->interval() != first->interval() ||
+        section->time() != previous->time_end())
+      return false;
+    for (size_t v = 0; v < variables; ++v) {
+      const VariableWithValues *a = first->variables()->Get(v);
+      const VariableWithValues *b = section->variables()->Get(v);
+      if (!same_variable(a, b) || !a->values() != !b->values() ||
+          !a->values_int64() != !b->values_int64())
+        return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, typename Values>
+flatbuffers::Offset<flatbuffers::Vector<T>>
+concatenate(flatbuffers::FlatBufferBuilder *fbb,
+            const WeatherApiResponse *const *parts, size_t count,
+            SectionOf section_of, size_t index, Values values_of) {
+  size_t total = 0;
+  for (size_t i = 0; i < count; ++i)
+    total += values_of((parts[i]->*section_of)()->variables()->Get(index))
+                 ->size();
+  T *output = nullptr;
+  const auto vector = fbb->CreateUninitializedVector(total, &output);
+  for (size_t i = 0; i < count; ++i) {
+    const auto *values =
+        values_of((parts[i]->*section_of)()->variables()->Get(index));
+    memcpy(output, values->data(), values->size() * sizeof(T));
+    output += values->size();
+  }
+  return vector;
+}
+
+// The section of all parts as one, checked by sections_line_up().
+flatbuffers::Offset<VariablesWithTime>
+merge_section(flatbuffers::FlatBufferBuilder *fbb,
+              const WeatherApiResponse *const *parts, size_t count,
+              SectionOf section_of) {
+  const VariablesWithTime *first = (parts[0]->*section_of)();
+  if (!first)
+    return 0;
+  const VariablesWithTime *last = (parts[count - 1]->*section_of)();
+  const size_t size = first->variables() ? first->variables()->size() : 0;
+  // Vectors cannot be built while a table is, so the values go first.
+  std::vector<flatbuffers::Offset<flatbuffers::Vector<float>>> values(size);
+  std::vector<flatbuffers::Offset<flatbuffers::Vector<int64_t>>> values_int64(
+      size);
+  for (size_t v = 0; v < size; ++v) {
+    const VariableWithValues *variable = first->variables()->Get(v);
+    if (variable->values())
+      values[v] = concatenate<float>(
+          fbb, parts, count, section_of, v,
+          [](const VariableWithValues *x) { return x->values(); });
+    if (variable->values_int64())
+      values_int64[v] = concatenate<int64_t>(
+          fbb, parts, count, section_of, v,
+          [](const VariableWithValues *x) { return x->values_int64(); });
+  }
+  std::vector<flatbuffers::Offset<VariableWithValues>> variables(size);
+  for (size_t v = 0; v < size; ++v) {
+    const VariableWithValues *variable = first->variables()->Get(v);
+    VariableWithValuesBuilder builder(*fbb);
+    builder.add_variable(variable->variable());
+    builder.add_unit(variable->unit());
+    builder.add_value(last->variables()->Get(v)->value());
+    if (values[v].o)
+      builder.add_values(values[v]);
+    if (values_int64[v].o)
+      builder.add_values_int64(values_int64[v]);
+    builder.add_altitude(variable->altitude());
+    builder.add_aggregation(variable->aggregation());
+    builder.add_pressure_level(variable->pressure_level());
+    builder.add_depth(variable->depth());
+    builder.add_depth_to(variable->depth_to());
+    builder.add_ensemble_member(variable->ensemble_member());
+    builder.add_previous_day(variable->previous_day());
+    variables[v] = builder.Finish();
+  }
+  const auto vector = fbb->CreateVector(variables);
+  VariablesWithTimeBuilder builder(*fbb);
+  builder.add_time(first->time());
+  builder.add_time_end(last->time_end());
+  builder.add_interval(first->interval());
+  builder.add_variables(vector);
+  return builder.Finish();
+}
+
+} // namespace
+
+std::vector<DateRange> SplitDateRange(const Endpoint &endpoint, time_t start,
+                                      time_t end) {
+  std::vector<DateRange> ranges;
+  if (!start || !end)
+    return ranges;
+  if (end < start)
+    std::swap(start, end);
+  if (!endpoint.range_days_max) {
+    ranges.push_back({start, end});
+    return ranges;
+  }
+  const time_t last = local_noon(end, 0);
+  for (time_t day = local_noon(start, 0); day != -1 && day <= last;
+       day = local_noon(day, endpoint.range_days_max)) {
+    const time_t chunk_end = local_noon(day, endpoint.range_days_max - 1);
+    ranges.push_back({day, chunk_end < last ? chunk_end : last});
+  }
+  return ranges;
+}
+
+bool MergeTimeSeries(const WeatherResponse *parts, size_t count,
+                     WeatherResponse *output) {
+  if (!parts || !count || !output)
+    return false;
+  std::vector<const WeatherApiResponse *> responses(count);
+  size_t size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (!(responses[i] = parts[i].get()))
+      return false;
+    size += parts[i].size();
+  }
+  const SectionOf series[] = {&WeatherApiResponse::hourly,
+                              &WeatherApiResponse::daily,
+                              &WeatherApiResponse::minutely_15};
+  for (SectionOf section_of : series) {
+    if (!sections_line_up(responses.data(), count, section_of))
+      return false;
+  }
+
+  const WeatherApiResponse *first = responses[0];
+  flatbuffers::FlatBufferBuilder fbb(size);
+  const auto hourly = merge_section(&fbb, responses.data(), count,
+                                    &WeatherApiResponse::hourly);
+  const auto daily =
+      merge_section(&fbb, responses.data(), count, &WeatherApiResponse::daily);
+  const auto minutely_15 = merge_section(&fbb, responses.data(), count,
+                                         &WeatherApiResponse::minutely_15);
+  // The current conditions are the latest chunk's.
+  const auto current = merge_section(&fbb, &responses[count - 1], 1,
+                                     &WeatherApiResponse::current);
+  flatbuffers::Offset<flatbuffers::String> timezone, timezone_abbreviation;
+  if (first->timezone())
+    timezone = fbb.CreateString(first->timezone());
+  if (first->timezone_abbreviation())
+    timezone_abbreviation = fbb.CreateString(first->timezone_abbreviation());
+  float generation_time = 0.f;
+  for (const WeatherApiResponse *response : responses)
+    generation_time += response->generation_time_milliseconds();
+
+  WeatherApiResponseBuilder builder(fbb);
+  builder.add_latitude(first->latitude());
+  builder.add_longitude(first->longitude());
+  builder.add_elevation(first->elevation());
+  builder.add_generation_time_milliseconds(generation_time);
+  builder.add_location_id(first->location_id());
+  builder.add_model(first->model());
+  builder.add_utc_offset_seconds(first->utc_offset_seconds());
+  if (timezone.o)
+    builder.add_timezone(timezone);
+  if (timezone_abbreviation.o)
+    builder.add_timezone_abbreviation(timezone_abbreviation);
+  if (current.o)
+    builder.add_current(current);
+  if (hourly.o)
+    builder.add_hourly(hourly);
+  if (daily.o)
+    builder.add_daily(daily);
+  if (minutely_15.o)
+    builder.add_minutely_15(minutely_15);
+  FinishSizePrefixedWeatherApiResponseBuffer(fbb, builder.Finish());
+
+  output->clear();
+  if (!output->reserve(fbb.GetSize()))
+    return false;
+  memcpy(output->tail(), fbb.GetBufferPointer(), fbb.GetSize());
+  output->commit(fbb.GetSize());
+  // Built here, so sound whatever the parts were checked for.
+  output->set_verified(verify_full);
+  return true;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,163 @@
+#ifndef ESP_PLATFORM
+#include "om_fetch_pool.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace OM_SDK {
+
+struct FetchPool::Run {
+  Run(const Endpoint &endpoint, const OpenMeteoParams &params,
+      const Location *sites)
+      : endpoint(endpoint), params(params), sites(sites) {}
+
+  const Endpoint &endpoint;
+  const OpenMeteoParams &params;
+  const Location *sites;
+  std::vector<FetchJob> jobs;
+  std::vector<WeatherResponse> responses;
+  std::vector<int> status_codes;
+  std::vector<bool> done;
+  size_t next{0};
+  size_t consumed{0};
+  size_t ahead{0};
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+static bool retryable(int status_code) {
+  return status_code <= 0 || status_code == 429 || status_code >= 500;
+}
+
+size_t FetchPool::run(const Endpoint &endpoint, const OpenMeteoParams &params,
+                      const Location *sites, size_t count,
+                      const FetchConsumer &consumer) {
+  _stats = {};
+  const Clock::time_point started = Clock::now();
+  std::vector<DateRange> windows =
+      SplitDateRange(endpoint, params.start_date, params.end_date);
+  if (windows.empty())
+    windows.push_back({0, 0});
+
+  Run run(endpoint, params, sites);
+  for (size_t site = 0; sites && site < count; ++site) {
+    for (const DateRange &window : windows)
+      run.jobs.push_back({site, window});
+  }
+  const size_t connections = std::max<size_t>(_options.connections, 1);
+  run.responses.resize(run.jobs.size());
+  run.status_codes.resize(run.jobs.size());
+  run.done.resize(run.jobs.size());
+  run.ahead = 2 * connections;
+  _stats.jobs = run.jobs.size();
+
+  std::vector<std::thread> workers;
+  const unsigned seed = std::random_device()();
+  for (size_t i = 0; i < std::min(connections, run.jobs.size()); ++i)
+    workers.emplace_back(&FetchPool::work, this, &run, seed + i);
+
+  for (size_t i = 0; i < run.jobs.size(); ++i) {
+    std::unique_lock<std::mutex> lock(run.mutex);
+    run.cv.wait(lock, [&] { return run.done[i]; });
+    WeatherResponse response = std::move(run.responses[i]);
+    const int status_code = run.status_codes[i];
+    run.consumed = i + 1;
+    lock.unlock();
+    run.cv.notify_all();
+    if (consumer)
+      consumer(run.jobs[i], status_code, std::move(response));
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+  _stats.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          Clock::now() - started)
+                          .count();
+  return _stats.failed;
+}
+
+void FetchPool::work(Run *run, unsigned seed) {
+  std::unique_ptr<Transport> transport =
+      _options.transport ? _options.transport() : nullptr;
+  Client client(transport.get());
+  client.set_timeout_ms(_options.timeout_ms);
+  client.set_base_url(_options.base_url);
+  client.set_verify(_options.verify);
+  client.set_budget(_options.budget);
+  const std::string host =
+      _options.base_url ? _options.base_url : run->endpoint.host;
+  std::minstd_rand random(seed);
+  OpenMeteoParams params = run->params;
+
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(run->mutex);
+      run->cv.wait(lock, [run] {
+        return run->next >= run->jobs.size() ||
+               run->next < run->consumed + run->ahead;
+      });
+      if (run->next >= run->jobs.size())
+        return;
+      index = run->next++;
+    }
+    const FetchJob &job = run->jobs[index];
+    params.latitude = run->sites[job.site].latitude;
+    params.longitude = run->sites[job.site].longitude;
+    if (job.range.start) {
+      params.start_date = job.range.start;
+      params.end_date = job.range.end;
+    }
+
+    WeatherResponse response;
+    int status_code = -1;
+    size_t attempts = 0;
+    while (attempts < std::max<uint8_t>(_options.max_attempts, 1)) {
+      if (attempts) {
+        const uint32_t delay =
+            std::min<uint64_t>(_options.max_backoff_ms,
+                               uint64_t(_options.backoff_ms)
+                                   << std::min<size_t>(attempts - 1, 20));
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            delay - random() % (delay / 2 + 1)));
+      }
+      wait_for_host(host);
+      ++attempts;
+      status_code = client.get(run->endpoint, &params, &response);
+      if (!retryable(status_code))
+        break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(run->mutex);
+      _stats.requests += attempts;
+      _stats.retries += attempts - 1;
+      _stats.failed += status_code != 200;
+      _stats.bytes += response.size();
+      run->responses[index] = std::move(response);
+      run->status_codes[index] = status_code;
+      run->done[index] = true;
+    }
+    run->cv.notify_all();
+  }
+}
+
+void FetchPool::wait_for_host(const std::string &host) {
+  if (_options.requests_per_second <= 0.)
+    return;
+  const auto interval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1. / _options.requests_per_second));
+  Clock::time_point start;
+  {
+    std::lock_guard<std::mutex> lock(_hosts_mutex);
+    Clock::time_point &next = _next_start[host];
+    start = std::max(Clock::now(), next);
+    next = start + interval;
+  }
+  std::this_thread::sleep_until(start);
+}
+
+} // namespace OM_SDK
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include "om_endpoint.hpp"
+#include "om_query.hpp"
+#include "open_meteo.hpp"
+#include <sdkconfig.h>
+
+#define TAG "OM_SDK"
+#define PAST_DAY_MAX 92
+#define FORCAST_DAY_MAX 16
+#define WEB_SCHEME "https://"
+#define WEB_URL WEB_SCHEME "api.open-meteo.com"
+#define FORECAST "/v1/forecast"
+#define AIR_QUALITY_URL WEB_SCHEME "air-quality-api.open-meteo.com"
+#define AIR_QUALITY "/v1/air-quality"
+#define MARINE_URL WEB_SCHEME "marine-api.open-meteo.com"
+#define MARINE "/v1/marine"
+#define ARCHIVE_URL WEB_SCHEME "archive-api.open-meteo.com"
+#define ARCHIVE "/v1/archive"
+#define ENSEMBLE_URL WEB_SCHEME "ensemble-api.open-meteo.com"
+#define ENSEMBLE "/v1/ensemble"
+#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
+
+// Request instrumentation, compiled out unless enabled in Kconfig.
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+#define OM_TRACE(...) __VA_ARGS__
+#else
+#define OM_TRACE(...)
+#endif
+
+namespace OM_SDK {
+
+// Forecast endpoint shorthands of the functions below.
+void validateParams(OpenMeteoParams *params);
+
+bool paramsToString(const OpenMeteoParams *p, QueryBuilder *q);
+
+bool paramsToString(const OpenMeteoParams *p, const Location *locations,
+                    size_t count, QueryBuilder *q);
+
+void validateParams(const Endpoint &endpoint, OpenMeteoParams *params);
+
+bool paramsToString(const Endpoint &endpoint, const OpenMeteoParams *p,
+                    const Location *locations, size_t count, QueryBuilder *q);
+
+} // namespace OM_SDK
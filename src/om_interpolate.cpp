@@ -0,0 +1,172 @@
+#include "om_interpolate.hpp"
+#include <cmath>
+
+namespace OM_SDK {
+
+static const float DEG_TO_RAD = 0.017453292519943295f;
+
+Interpolation DefaultInterpolation(TimeParam param) {
+  switch (param) {
+  case wind_direction_10m:
+  case wind_direction_10m_dominant:
+  case wind_direction_80m:
+  case wind_direction_120m:
+  case wind_direction_180m:
+    return interpolation_angle;
+  default:
+    return interpolation_linear;
+  }
+}
+
+static TimeWeight weight_at(const TimeAxis &axis, int64_t time) {
+  if (axis.size() < 2 || axis.interval() <= 0 || time <= axis[0])
+    return {0, 0.f};
+  const size_t last = axis.size() - 1;
+  if (time >= axis[last])
+    return {(uint32_t)(last - 1), 1.f};
+  const int64_t offset = time - axis[0];
+  const uint32_t index = offset / axis.interval();
+  const float t =
+      (float)(offset - (int64_t)index * axis.interval()) / axis.interval();
+  return {index, t};
+}
+
+size_t TimeWeights(const TimeAxis &axis, const int64_t *times, size_t count,
+                   TimeWeight *output) {
+  for (size_t i = 0; i < count; ++i)
+    output[i] = weight_at(axis, times[i]);
+  return count;
+}
+
+size_t TimeWeights(const TimeAxis &axis, int64_t start, int32_t step,
+                   size_t count, TimeWeight *output) {
+  for (size_t i = 0; i < count; ++i)
+    output[i] = weight_at(axis, start + (int64_t)i * step);
+  return count;
+}
+
+static float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+static float lerp_angle(float a, float b, float t) {
+  const float turn = std::fmod(std::fmod(b - a, 360.f) + 540.f, 360.f);
+  const float delta = turn - 180.f;
+  const float angle = std::fmod(a + delta * t, 360.f);
+  return angle < 0.f ? angle + 360.f : angle;
+}
+
+// Harmonic mean of the neighbouring slopes, 0 at local extrema, which keeps
+// the curve monotone between samples on a regular axis.
+static float tangent(float before, float after) {
+  if (before * after <= 0.f)
+    return 0.f;
+  return 2.f * before * after / (before + after);
+}
+
+static float cubic(const Span<float> &values, uint32_t index, float t) {
+  const float y0 = values[index];
+  const float y1 = values[index + 1];
+  const float delta = y1 - y0;
+  const float before = index > 0 ? y0 - values[index - 1] : delta;
+  const float after =
+      index + 2 < values.size() ? values[index + 2] - y1 : delta;
+  // A missing outer neighbour falls back to a straight segment.
+  if (std::isnan(before) || std::isnan(after))
+    return lerp(y0, y1, t);
+  const float m0 = index > 0 ? tangent(before, delta) : delta;
+  const float m1 = index + 2 < values.size() ? tangent(delta, after) : delta;
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  return (2.f * t3 - 3.f * t2 + 1.f) * y0 + (t3 - 2.f * t2 + t) * m0 +
+         (-2.f * t3 + 3.f * t2) * y1 + (t3 - t2) * m1;
+}
+
+void Interpolate(Span<float> values, const TimeWeight *weights, size_t count,
+                 Interpolation mode, float *output) {
+  if (values.empty()) {
+    for (size_t i = 0; i < count; ++i)
+      output[i] = NAN;
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t index = weights[i].index;
+    const float t = weights[i].t;
+    if (index + 1 >= values.size()) {
+      output[i] = values[values.size() - 1];
+      continue;
+    }
+    switch (mode) {
+    case interpolation_cubic:
+      output[i] = cubic(values, index, t);
+      break;
+    case interpolation_angle:
+      output[i] = lerp_angle(values[index], values[index + 1], t);
+      break;
+    default:
+      output[i] = lerp(values[index], values[index + 1], t);
+      break;
+    }
+  }
+}
+
+void Interpolate(const SectionIndex &section, TimeParam param,
+                 const TimeWeight *weights, size_t count, float *output) {
+  Interpolate(section.values(param), weights, count,
+              DefaultInterpolation(param), output);
+}
+
+static float fraction(float from, float to, float value) {
+  if (to == from)
+    return 0.f;
+  const float f = (value - from) / (to - from);
+  return f < 0.f ? 0.f : f > 1.f ? 1.f : f;
+}
+
+bool BilinearWeights(Location south_west, Location north_east, Location point,
+                     GridWeights *output) {
+  if (!output || south_west.latitude > north_east.latitude)
+    return false;
+  // A box crossing the antimeridian has its east edge west of its west edge:
+  // measure longitudes east of the west edge, past 180 where needed. Points
+  // outside the box go to the edge they are nearer to.
+  float east = north_east.longitude;
+  float longitude = point.longitude;
+  if (east < south_west.longitude) {
+    east += 360.f;
+    if (longitude < south_west.longitude &&
+        longitude + 360.f - east < south_west.longitude - longitude)
+      longitude += 360.f;
+  }
+  const float x = fraction(south_west.longitude, east, longitude);
+  const float y =
+      fraction(south_west.latitude, north_east.latitude, point.latitude);
+  output->weight[0] = (1.f - x) * (1.f - y);
+  output->weight[1] = x * (1.f - y);
+  output->weight[2] = (1.f - x) * y;
+  output->weight[3] = x * y;
+  return true;
+}
+
+void Blend(const float *const corners[4], const GridWeights &weights,
+           size_t count, Interpolation mode, float *output) {
+  const float *w = weights.weight;
+  if (mode != interpolation_angle) {
+    for (size_t i = 0; i < count; ++i)
+      output[i] = w[0] * corners[0][i] + w[1] * corners[1][i] +
+                  w[2] * corners[2][i] + w[3] * corners[3][i];
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    float x = 0.f;
+    float y = 0.f;
+    for (size_t c = 0; c < 4; ++c) {
+      x += w[c] * std::cos(corners[c][i] * DEG_TO_RAD);
+      y += w[c] * std::sin(corners[c][i] * DEG_TO_RAD);
+    }
+    float angle = std::atan2(y, x) / DEG_TO_RAD;
+    if (angle < 0.f)
+      angle += 360.f;
+    output[i] = angle < 360.f ? angle : 0.f;
+  }
+}
+
+} // namespace OM_SDK
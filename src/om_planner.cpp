@@ -0,0 +1,317 @@
+#include "om_planner.hpp"
+#include "om_cache.hpp"
+#include "om_endpoint.hpp"
+#include "om_internal.hpp"
+#include "om_trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <esp_log.h>
+#include <strings.h>
+#include <utility>
+
+namespace OM_SDK {
+
+using namespace openmeteo_sdk;
+
+struct ResponseView::Merged {
+  SharedResponse response;
+  ResponseIndex index;
+};
+
+const WeatherApiResponse *ResponseView::response() const {
+  return _merged && _merged->response ? _merged->response->get() : nullptr;
+}
+
+SharedResponse ResponseView::shared() const {
+  return _merged ? _merged->response : nullptr;
+}
+
+namespace {
+
+// The timezone the request of `params` is sent with: daily values need one
+// and get the one of the place.
+const char *request_timezone(const OpenMeteoParams &params) {
+  return params.daily_set.empty() ? params.timezone : "auto";
+}
+
+// Whether every day of the response is 86400 s: UTC and GMT have no DST.
+bool fixed_days(const OpenMeteoParams &params) {
+  const char *timezone = request_timezone(params);
+  return !timezone || !strcasecmp(timezone, "UTC") ||
+         !strcasecmp(timezone, "GMT");
+}
+
+// Hash of everything a query asks for but its variables and days: queries
+// sharing it can be fetched as one. In timezones with DST the days are part
+// of it, the values of a day cannot be told apart by their count.
+uint64_t group_key(const Endpoint &endpoint, const OpenMeteoParams &params) {
+  OpenMeteoParams shape = params;
+  shape.timezone = const_cast<char *>(request_timezone(params));
+  shape.hourly_set = shape.daily_set = TimeParamSet();
+  shape.minutely_15_set = shape.current_set = TimeParamSet();
+  const bool fixed = fixed_days(params);
+  if (fixed) {
+    shape.past_days = shape.forecast_days = 0;
+    // Dates merge with dates only.
+    shape.start_date = shape.end_date = params.start_date ? 1 : 0;
+  }
+  StaticQueryBuilder<CONFIG_OPEN_METEO_MAX_URL_LENGTH> url;
+  url.append(endpoint.host).append(endpoint.path);
+  const Location location = {params.latitude, params.longitude};
+  if (!paramsToString(endpoint, &shape, &location, 1, &url))
+    return 0;
+  if (!fixed)
+    url.append("#days");
+  return hash_query(url.c_str());
+}
+
+int forecast_days(const Endpoint &endpoint, const OpenMeteoParams &params) {
+  return params.forecast_days ? params.forecast_days
+                              : endpoint.forecast_days_default;
+}
+
+// Days since 1970-01-01 of the local date of `t`, the date its request is
+// sent with.
+long local_day(time_t t) {
+  struct tm date;
+  localtime_r(&t, &date);
+  // Years starting in March, leap days last.
+  const long year = date.tm_year + 1900L - (date.tm_mon < 2);
+  const long era = (year >= 0 ? year : year - 399) / 400;
+  const long year_of_era = year - era * 400;
+  const long month = date.tm_mon < 2 ? date.tm_mon + 10 : date.tm_mon - 2;
+  const long day_of_year = (153 * month + 2) / 5 + date.tm_mday - 1;
+  const long day_of_era = year_of_era * 365 + year_of_era / 4 -
+                          year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+// Days `query` covers and how many days into the `merged` ones they start.
+void query_days(const Endpoint &endpoint, const OpenMeteoParams &merged,
+                const OpenMeteoParams &query, long *offset, long *days) {
+  if (query.start_date) {
+    const long first = local_day(query.start_date);
+    *offset = first - local_day(merged.start_date);
+    *days = local_day(query.end_date) - first + 1;
+  } else {
+    *offset = merged.past_days - query.past_days;
+    *days = query.past_days + forecast_days(endpoint, query);
+  }
+}
+
+// The days of a section a query asked for, days taken as 86400 s. The whole
+// section when `whole`: its own range params set its length, or the group
+// has days of other lengths. Both are the same for every query of a group.
+SectionView window(const SectionIndex &index, const TimeParamSet &params,
+                   long offset, long days, bool whole) {
+  const int32_t interval = index.time().interval();
+  if (whole || interval <= 0 || 86400 % interval || offset < 0 || days <= 0)
+    return SectionView(&index, params);
+  const size_t per_day = 86400 / interval;
+  return SectionView(&index, params, offset * per_day, days * per_day);
+}
+
+size_t value_bytes(const VariablesWithTime *section) {
+  size_t bytes = 0;
+  if (!section || !section->variables())
+    return bytes;
+  for (const VariableWithValues *variable : *section->variables()) {
+    if (variable->values())
+      bytes += variable->values()->size() * sizeof(float);
+    if (variable->values_int64())
+      bytes += variable->values_int64()->size() * sizeof(int64_t);
+  }
+  return bytes;
+}
+
+size_t value_bytes(const SectionView &view) {
+  size_t bytes = 0;
+  view.params().for_each([&view, &bytes](TimeParam param) {
+    const size_t values = view.values(param).size() * sizeof(float) +
+                          view.values_int64(param).size() * sizeof(int64_t);
+    // Current values are a single float.
+    bytes += values ? values : view.find(param) ? sizeof(float) : 0;
+  });
+  return bytes;
+}
+
+} // namespace
+
+QueryPlanner::QueryPlanner(Client *client, const PlannerConfig &config,
+                           NowMs now)
+    : _client(client), _config(config), _now(std::move(now)) {}
+
+int64_t QueryPlanner::now() const {
+  return _now ? _now() : MonotonicUs() / 1000;
+}
+
+bool QueryPlanner::submit(const OpenMeteoParams &params,
+                          ViewCallback callback) {
+  return submit(forecast_endpoint, params, std::move(callback));
+}
+
+bool QueryPlanner::submit(const Endpoint &endpoint,
+                          const OpenMeteoParams &params,
+                          ViewCallback callback) {
+  Query query = {params, std::move(callback)};
+  OpenMeteoParams &p = query.params;
+  p.hourly_set =
+      (p.hourly_set | TimeParamSet::from_array(p.hourly)) & endpoint.hourly;
+  p.daily_set =
+      (p.daily_set | TimeParamSet::from_array(p.daily)) & endpoint.daily;
+  p.minutely_15_set =
+      (p.minutely_15_set | TimeParamSet::from_array(p.minutely_15)) &
+      endpoint.minutely_15;
+  p.current_set =
+      (p.current_set | TimeParamSet::from_array(p.current)) & endpoint.current;
+  p.hourly = p.daily = p.minutely_15 = p.current = nullptr;
+  validateParams(endpoint, &p);
+  const uint64_t key = group_key(endpoint, p);
+  if (!key) {
+    ESP_LOGE(TAG, "URL longer than %d bytes",
+             CONFIG_OPEN_METEO_MAX_URL_LENGTH);
+    return false;
+  }
+
+  const int64_t t = now();
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (Group &group : _groups) {
+    if (group.endpoint == &endpoint && group.key == key) {
+      group.queries.push_back(std::move(query));
+      return true;
+    }
+  }
+  _groups.push_back({&endpoint, key, t, {}});
+  _groups.back().queries.push_back(std::move(query));
+  return true;
+}
+
+size_t QueryPlanner::poll() { return fetch(false); }
+
+size_t QueryPlanner::flush() { return fetch(true); }
+
+int64_t QueryPlanner::next_due() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  int64_t next = 0;
+  for (const Group &group : _groups) {
+    const int64_t due = group.opened + _config.window_ms;
+    if (!next || due < next)
+      next = due;
+  }
+  return next;
+}
+
+PlannerStats QueryPlanner::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+size_t QueryPlanner::fetch(bool all) {
+  const int64_t t = now();
+  std::vector<Group> due;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _groups.begin(); it != _groups.end();) {
+      if (all || t - it->opened >= _config.window_ms) {
+        due.push_back(std::move(*it));
+        it = _groups.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // Callbacks may submit again, the lock is not held while they run.
+  size_t requests = 0;
+  for (Group &group : due)
+    requests += fetch_group(&group);
+  return requests;
+}
+
+size_t QueryPlanner::fetch_group(Group *group) {
+  const Endpoint &endpoint = *group->endpoint;
+  OpenMeteoParams merged = group->queries[0].params;
+  bool days_set = false;
+  int days = 0;
+  for (const Query &query : group->queries) {
+    const OpenMeteoParams &p = query.params;
+    merged.hourly_set |= p.hourly_set;
+    merged.daily_set |= p.daily_set;
+    merged.minutely_15_set |= p.minutely_15_set;
+    merged.current_set |= p.current_set;
+    if (p.start_date) {
+      merged.start_date = std::min(merged.start_date, p.start_date);
+      merged.end_date = std::max(merged.end_date, p.end_date);
+    } else {
+      merged.past_days = std::max(merged.past_days, p.past_days);
+      days_set |= p.forecast_days != 0;
+      days = std::max(days, forecast_days(endpoint, p));
+    }
+  }
+  // Left unset when no query set it, the request stays the one each of
+  // them would have made.
+  if (days_set)
+    merged.forecast_days = days;
+
+  const size_t requests = _client->requests();
+  const bool whole_days = !fixed_days(merged);
+
+  SharedResponse response;
+  const int status_code = _client->get(endpoint, &merged, &response);
+  const size_t sent = _client->requests() - requests;
+
+  std::shared_ptr<ResponseView::Merged> shared;
+  size_t overhead = 0;
+  if (status_code == 200 && response && *response) {
+    shared = std::make_shared<ResponseView::Merged>();
+    shared->response = response;
+    shared->index.build(response->get());
+    const WeatherApiResponse *message = response->get();
+    const size_t values =
+        value_bytes(message->current()) + value_bytes(message->hourly()) +
+        value_bytes(message->daily()) + value_bytes(message->minutely_15());
+    overhead = response->size() > values ? response->size() - values : 0;
+  }
+
+  size_t estimated = 0;
+  for (Query &query : group->queries) {
+    ResponseView view;
+    if (shared) {
+      const OpenMeteoParams &p = query.params;
+      const ResponseIndex &index = shared->index;
+      long offset = 0;
+      long days = 0;
+      query_days(endpoint, merged, p, &offset, &days);
+      view._merged = shared;
+      view._current = SectionView(&index.current(), p.current_set);
+      view._hourly = window(index.hourly(), p.hourly_set, offset, days,
+                            whole_days || merged.forecast_hours ||
+                                merged.past_hours || merged.start_hour);
+      view._daily =
+          window(index.daily(), p.daily_set, offset, days, whole_days);
+      view._minutely_15 =
+          window(index.minutely_15(), p.minutely_15_set, offset, days,
+                 whole_days || merged.forecast_minutely_15 ||
+                     merged.past_minutely_15 || merged.start_minutely_15);
+      estimated += overhead + value_bytes(view._current) +
+                   value_bytes(view._hourly) + value_bytes(view._daily) +
+                   value_bytes(view._minutely_15);
+    }
+    if (query.callback)
+      query.callback(status_code, view);
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stats.queries += group->queries.size();
+  _stats.round_trips += sent;
+  // Each query alone would have taken as many requests.
+  _stats.round_trips_saved += sent * (group->queries.size() - 1);
+  if (sent && shared) {
+    _stats.bytes_fetched += response->size();
+    if (estimated > response->size())
+      _stats.bytes_saved += estimated - response->size();
+  }
+  return sent;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,65 @@
+#include "om_query.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace OM_SDK {
+
+QueryBuilder::QueryBuilder(char *buffer, size_t capacity)
+    : _buffer(buffer), _capacity(capacity) {
+  clear();
+}
+
+void QueryBuilder::clear() {
+  _size = 0;
+  _overflow = _capacity == 0;
+  if (_capacity)
+    _buffer[0] = '\0';
+}
+
+QueryBuilder &QueryBuilder::append(const char *str) {
+  if (_overflow)
+    return *this;
+  const size_t len = strlen(str);
+  if (_size + len >= _capacity) {
+    _overflow = true;
+    return *this;
+  }
+  memcpy(_buffer + _size, str, len + 1);
+  _size += len;
+  return *this;
+}
+
+QueryBuilder &QueryBuilder::appendf(const char *format, ...) {
+  if (_overflow)
+    return *this;
+  va_list args;
+  va_start(args, format);
+  const int len =
+      vsnprintf(_buffer + _size, _capacity - _size, format, args);
+  va_end(args);
+  if (len < 0 || _size + len >= _capacity) {
+    _overflow = true;
+    _buffer[_size] = '\0';
+    return *this;
+  }
+  _size += len;
+  return *this;
+}
+
+QueryBuilder &QueryBuilder::append(int value) { return appendf("%d", value); }
+
+// Same output as the default std::ostream float formatting.
+QueryBuilder &QueryBuilder::append(float value) {
+  return appendf("%g", (double)value);
+}
+
+QueryBuilder &QueryBuilder::append_time(time_t value, const char *format) {
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  char strftime_buf[20] = {0};
+  strftime(strftime_buf, sizeof(strftime_buf), format, &timeinfo);
+  return append(strftime_buf);
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,187 @@
+#include "om_response.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <sdkconfig.h>
+#include <utility>
+
+namespace OM_SDK {
+
+WeatherResponse::~WeatherResponse() { reset(); }
+
+WeatherResponse::WeatherResponse(WeatherResponse &&other) noexcept
+    : _arena(other._arena), _data(std::exchange(other._data, nullptr)),
+      _size(std::exchange(other._size, 0)),
+      _capacity(std::exchange(other._capacity, 0)),
+      _verified(std::exchange(other._verified, verify_off)) {}
+
+WeatherResponse &WeatherResponse::operator=(WeatherResponse &&other) noexcept {
+  if (this != &other) {
+    reset();
+    _arena = other._arena;
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _capacity = std::exchange(other._capacity, 0);
+    _verified = std::exchange(other._verified, verify_off);
+  }
+  return *this;
+}
+
+template <typename T> static T read_scalar(const uint8_t *data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// The root offset, the root table and its vtable of a message without size
+// prefix, in bounds. Reads unaligned, a corrupt offset may be odd.
+static bool verify_root(const uint8_t *message, size_t size) {
+  if (size < 2 * sizeof(flatbuffers::uoffset_t))
+    return false;
+  const size_t root = read_scalar<flatbuffers::uoffset_t>(message);
+  if (root > size - sizeof(flatbuffers::soffset_t))
+    return false;
+  const int64_t vtable =
+      (int64_t)root - read_scalar<flatbuffers::soffset_t>(message + root);
+  if (vtable < 0 || (uint64_t)vtable > size - 2 * sizeof(uint16_t))
+    return false;
+  const size_t vtable_size = read_scalar<uint16_t>(message + vtable);
+  const size_t table_size =
+      read_scalar<uint16_t>(message + vtable + sizeof(uint16_t));
+  return vtable_size >= 2 * sizeof(uint16_t) && vtable_size % 2 == 0 &&
+         vtable + vtable_size <= size && table_size <= size - root;
+}
+
+bool VerifyMessages(const uint8_t *data, size_t size,
+                    const VerifyOptions &options) {
+  const size_t prefix = sizeof(flatbuffers::uoffset_t);
+  size_t offset = 0;
+  while (size - offset >= prefix) {
+    const size_t message_size = flatbuffers::GetPrefixedSize(data + offset);
+    if (message_size == 0 || message_size > size - offset - prefix)
+      return false;
+    if (options.mode == verify_header &&
+        !verify_root(data + offset + prefix, message_size))
+      return false;
+    if (options.mode == verify_full) {
+      flatbuffers::Verifier verifier(data + offset, prefix + message_size,
+                                     options.max_depth, options.max_tables);
+      if (!openmeteo_sdk::VerifySizePrefixedWeatherApiResponseBuffer(verifier))
+        return false;
+    }
+    offset += prefix + message_size;
+  }
+  return offset == size && size > 0;
+}
+
+bool WeatherResponse::verify(const VerifyOptions &options) {
+  if (options.mode <= _verified)
+    return true;
+  if (!VerifyMessages(_data, _size, options))
+    return false;
+  _verified = options.mode;
+  return true;
+}
+
+const openmeteo_sdk::WeatherApiResponse *WeatherResponse::get() const {
+  if (_size < sizeof(flatbuffers::uoffset_t))
+    return nullptr;
+  const size_t message_size = flatbuffers::GetPrefixedSize(_data);
+  if (message_size > _size - sizeof(flatbuffers::uoffset_t))
+    return nullptr;
+  return openmeteo_sdk::GetSizePrefixedWeatherApiResponse(_data);
+}
+
+size_t WeatherResponse::messages(const openmeteo_sdk::WeatherApiResponse **out,
+                                 size_t max) const {
+  size_t count = 0;
+  size_t offset = 0;
+  while (count < max && _size - offset >= sizeof(flatbuffers::uoffset_t)) {
+    const size_t message_size = flatbuffers::GetPrefixedSize(_data + offset);
+    if (message_size > _size - offset - sizeof(flatbuffers::uoffset_t))
+      break;
+    out[count++] =
+        openmeteo_sdk::GetSizePrefixedWeatherApiResponse(_data + offset);
+    offset += sizeof(flatbuffers::uoffset_t) + message_size;
+  }
+  return count;
+}
+
+bool WeatherResponse::reserve(size_t capacity) {
+  if (capacity <= _capacity)
+    return true;
+  if (_arena) {
+    uint8_t *data = _arena->grow(_data, _size, capacity);
+    if (!data)
+      return false;
+    _data = data;
+    _capacity = capacity;
+    return true;
+  }
+#if CONFIG_OPEN_METEO_RESPONSE_IN_PSRAM
+  uint8_t *data = (uint8_t *)heap_caps_realloc(
+      _data, capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#else
+  uint8_t *data = (uint8_t *)realloc(_data, capacity);
+#endif
+  if (!data)
+    return false;
+  _data = data;
+  _capacity = capacity;
+  return true;
+}
+
+void WeatherResponse::reset() {
+  if (_arena && _data)
+    _arena->release(_data);
+  else
+    free(_data);
+  _data = nullptr;
+  _size = 0;
+  _capacity = 0;
+  _verified = verify_off;
+}
+
+void WeatherBatch::clear() {
+  _responses.clear();
+  _locations.clear();
+}
+
+bool WeatherBatch::append(WeatherResponse &&response, size_t count) {
+  const size_t offset = _locations.size();
+  _locations.resize(offset + count);
+  if (response.messages(_locations.data() + offset, count) != count) {
+    _locations.resize(offset);
+    return false;
+  }
+  _responses.push_back(std::move(response));
+  return true;
+}
+
+bool WeatherBatch::copy(size_t index, WeatherResponse *output) const {
+  if (index >= _locations.size())
+    return false;
+  for (const WeatherResponse &response : _responses) {
+    size_t offset = 0;
+    while (response.size() - offset >= sizeof(flatbuffers::uoffset_t)) {
+      const uint8_t *message = response.data() + offset;
+      const size_t size = sizeof(flatbuffers::uoffset_t) +
+                          flatbuffers::GetPrefixedSize(message);
+      if (size > response.size() - offset)
+        break;
+      if (!index--) {
+        output->clear();
+        if (!output->reserve(size))
+          return false;
+        memcpy(output->tail(), message, size);
+        output->commit(size);
+        output->set_verified(response.verified());
+        return true;
+      }
+      offset += size;
+    }
+  }
+  return false;
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,167 @@
+#include "om_scheduler.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace OM_SDK {
+
+RefreshScheduler::RefreshScheduler(Client *client,
+                                   const SchedulerConfig &config,
+                                   TimeSource now, uint32_t seed)
+    : _client(client), _config(config), _now(std::move(now)),
+      _random(seed ? seed : 1) {}
+
+QueryId RefreshScheduler::add(const OpenMeteoParams &params,
+                              WeatherCallback callback) {
+  // Queries whose url only differs by location share a group.
+  OpenMeteoParams anywhere = params;
+  anywhere.latitude = 0.f;
+  anywhere.longitude = 0.f;
+  uint64_t group = 0;
+  if (!_client->cache_key(&anywhere, &group))
+    group = 0;
+  const QueryId id = _next_id++;
+  _queries.push_back({id, params, std::move(callback), group, now()});
+  return id;
+}
+
+bool RefreshScheduler::remove(QueryId id) {
+  auto it = std::find_if(_queries.begin(), _queries.end(),
+                         [id](const Query &query) { return query.id == id; });
+  if (it == _queries.end())
+    return false;
+  _queries.erase(it);
+  return true;
+}
+
+time_t RefreshScheduler::next_due() const {
+  time_t next = 0;
+  for (const Query &query : _queries) {
+    if (!next || query.due < next)
+      next = query.due;
+  }
+  return next;
+}
+
+time_t RefreshScheduler::due(QueryId id) const {
+  for (const Query &query : _queries) {
+    if (query.id == id)
+      return query.due;
+  }
+  return 0;
+}
+
+time_t RefreshScheduler::next_refresh(openmeteo_sdk::Model model,
+                                      time_t now) const {
+  uint32_t interval = ModelUpdateInterval(model);
+  if (!interval)
+    interval = _config.default_interval;
+  if (!interval)
+    return now;
+  // Runs start on multiples of the interval and are served publish_delay
+  // later; wait for the first one not served yet.
+  const time_t served = now - _config.publish_delay;
+  const time_t last_run = served - ((served % interval) + interval) % interval;
+  return last_run + interval + _config.publish_delay;
+}
+
+uint32_t RefreshScheduler::jitter() {
+  if (!_config.jitter)
+    return 0;
+  // xorshift32, deterministic for a given seed.
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random % (_config.jitter + 1);
+}
+
+void RefreshScheduler::complete(Query *query, int status_code,
+                                SharedResponse response, time_t now) {
+  if (status_code == 200 && response && *response)
+    query->due = next_refresh((*response)->model(), now) + jitter();
+  else
+    query->due = now + _config.retry + jitter();
+  // The callback may add or remove queries, copy it out first.
+  WeatherCallback callback = query->callback;
+  if (callback)
+    callback(status_code, std::move(response));
+}
+
+size_t RefreshScheduler::poll() {
+  const time_t t = now();
+  std::vector<QueryId> due;
+  for (const Query &query : _queries) {
+    if (query.due <= t)
+      due.push_back(query.id);
+  }
+  const size_t requests = _client->requests();
+  std::vector<Query *> group;
+  for (size_t i = 0; i < due.size(); ++i) {
+    if (!due[i])
+      continue;
+    group.clear();
+    uint64_t key = 0;
+    for (size_t j = i; j < due.size(); ++j) {
+      auto it = std::find_if(
+          _queries.begin(), _queries.end(),
+          [&due, j](const Query &query) { return query.id == due[j]; });
+      if (it == _queries.end()) {
+        due[j] = 0;
+        continue;
+      }
+      if (group.empty())
+        key = it->group;
+      else if (!key || it->group != key)
+        continue;
+      group.push_back(&*it);
+      due[j] = 0;
+    }
+    if (!group.empty())
+      fetch_group(group, t);
+  }
+  return _client->requests() - requests;
+}
+
+void RefreshScheduler::fetch_group(const std::vector<Query *> &group,
+                                   time_t now) {
+  if (group.size() == 1) {
+    OpenMeteoParams params = group[0]->params;
+    SharedResponse response;
+    const int status_code = _client->get_weather(&params, &response);
+    complete(group[0], status_code, std::move(response), now);
+    return;
+  }
+
+  std::vector<QueryId> ids;
+  std::vector<Location> locations;
+  for (Query *query : group) {
+    ids.push_back(query->id);
+    locations.push_back({query->params.latitude, query->params.longitude});
+  }
+  OpenMeteoParams params = group[0]->params;
+  WeatherBatch batch;
+  const int status_code = _client->get_weather_batch(
+      &params, locations.data(), locations.size(), &batch);
+  // Callbacks may change _queries, look every query up again.
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto it = std::find_if(
+        _queries.begin(), _queries.end(),
+        [&ids, i](const Query &query) { return query.id == ids[i]; });
+    if (it == _queries.end())
+      continue;
+    Query *query = &*it;
+    if (status_code != 200) {
+      complete(query, status_code, nullptr, now);
+      continue;
+    }
+    WeatherResponse response;
+    if (!batch.copy(i, &response)) {
+      complete(query, -1, nullptr, now);
+      continue;
+    }
+    complete(query, status_code,
+             std::make_shared<const WeatherResponse>(std::move(response)),
+             now);
+  }
+}
+
+} // namespace OM_SDK
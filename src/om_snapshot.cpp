@@ -0,0 +1,396 @@
+#include "om_snapshot.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace OM_SDK {
+
+using namespace openmeteo_sdk;
+
+namespace {
+
+constexpr uint8_t SNAPSHOT_VERSION = 1;
+constexpr uint8_t INT64_VALUES = 0x80;
+constexpr size_t SECTIONS = 4;
+// Quantized values stay exact in a double.
+constexpr double QUANTIZED_MAX = 9007199254740992.;
+
+uint64_t zigzag(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+double power_of_ten(int8_t exponent) {
+  double result = 1.;
+  for (int8_t i = 0; i < exponent; ++i)
+    result *= 10.;
+  for (int8_t i = 0; i > exponent; --i)
+    result /= 10.;
+  return result;
+}
+
+class Writer {
+public:
+  Writer(uint8_t *output, size_t capacity)
+      : _output(output), _capacity(capacity) {}
+
+  void byte(uint8_t value) {
+    if (_size < _capacity)
+      _output[_size] = value;
+    ++_size;
+  }
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      byte((uint8_t)value | 0x80);
+      value >>= 7;
+    }
+    byte((uint8_t)value);
+  }
+  void signed_varint(int64_t value) { varint(zigzag(value)); }
+  // Code of one step, see EncodeSnapshot.
+  void step(bool present, int64_t value, int64_t *previous) {
+    if (!present) {
+      byte(0);
+      return;
+    }
+    // Wrapping, so any int64 round-trips.
+    varint(zigzag((int64_t)((uint64_t)value - (uint64_t)*previous)) + 1);
+    *previous = value;
+  }
+
+  bool fits() const { return _size <= _capacity; }
+  size_t size() const { return _size; }
+
+private:
+  uint8_t *_output;
+  size_t _capacity;
+  size_t _size{0};
+};
+
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+
+  bool byte(uint8_t *value) {
+    if (_offset >= _size)
+      return false;
+    *value = _data[_offset++];
+    return true;
+  }
+  bool varint(uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t b;
+      if (!byte(&b))
+        return false;
+      *value |= (uint64_t)(b & 0x7f) << shift;
+      if (!(b & 0x80))
+        return true;
+    }
+    return false;
+  }
+  bool signed_varint(int64_t *value) {
+    uint64_t raw;
+    if (!varint(&raw))
+      return false;
+    *value = unzigzag(raw);
+    return true;
+  }
+  size_t remaining() const { return _size - _offset; }
+
+private:
+  const uint8_t *_data;
+  size_t _size;
+  size_t _offset{0};
+};
+
+// Steps of a section that go into the snapshot.
+struct Steps {
+  int64_t start;
+  int32_t interval;
+  size_t first;
+  size_t stride;
+  size_t count;
+};
+
+Steps select_steps(const VariablesWithTime *section, bool current,
+                   bool downsample, const SnapshotSelection &selection) {
+  const TimeAxis axis(section);
+  Steps steps = {axis.size() ? axis[0] : 0, 0, 0, 1, 1};
+  if (current)
+    return steps;
+  if (downsample && selection.stride > 1)
+    steps.stride = selection.stride;
+  if (selection.from > steps.start && axis.interval() > 0) {
+    const int64_t skip = (selection.from - steps.start + axis.interval() - 1) /
+                         axis.interval();
+    steps.first = (size_t)skip < axis.size() ? skip : axis.size();
+  }
+  steps.start = steps.start + (int64_t)steps.first * axis.interval();
+  steps.interval = axis.interval() * steps.stride;
+  steps.count = (axis.size() - steps.first + steps.stride - 1) / steps.stride;
+  if (selection.max_steps && steps.count > selection.max_steps)
+    steps.count = selection.max_steps;
+  return steps;
+}
+
+bool encode_section(Writer *writer, const SectionIndex &index,
+                    const TimeParamSet &params, bool current, bool downsample,
+                    const SnapshotSelection &selection) {
+  size_t variables = 0;
+  params.for_each([&](TimeParam param) { variables += !!index.find(param); });
+  if (!variables)
+    return false;
+  const Steps steps =
+      select_steps(index.section(), current, downsample, selection);
+  writer->signed_varint(steps.start);
+  writer->varint(steps.interval);
+  writer->varint(steps.count);
+  writer->varint(variables);
+  params.for_each([&](TimeParam param) {
+    const VariableWithValues *variable = index.find(param);
+    if (!variable)
+      return;
+    writer->byte(param);
+    int64_t previous = 0;
+    if (!current && variable->values_int64()) {
+      writer->byte(INT64_VALUES);
+      const auto *values = variable->values_int64();
+      for (size_t i = 0; i < steps.count; ++i) {
+        const size_t at = steps.first + i * steps.stride;
+        const bool present = at < values->size();
+        writer->step(present, present ? (*values)[at] : 0, &previous);
+      }
+      return;
+    }
+    const int8_t decimals = SnapshotDecimals(param);
+    const double scale = power_of_ten(decimals);
+    writer->byte((uint8_t)decimals);
+    const auto *values = variable->values();
+    for (size_t i = 0; i < steps.count; ++i) {
+      const size_t at = steps.first + i * steps.stride;
+      float value = NAN;
+      if (current)
+        value = variable->value();
+      else if (values && at < values->size())
+        value = (*values)[at];
+      const double quantized = std::round(value * scale);
+      const bool present =
+          !std::isnan(quantized) && std::fabs(quantized) < QUANTIZED_MAX;
+      writer->step(present, present ? (int64_t)quantized : 0, &previous);
+    }
+  });
+  return true;
+}
+
+} // namespace
+
+int8_t SnapshotDecimals(TimeParam param) {
+  switch (param) {
+  case cape:
+  case cloud_cover:
+  case cloud_cover_high:
+  case cloud_cover_low:
+  case cloud_cover_mid:
+  case daylight_duration:
+  case diffuse_radiation:
+  case direct_normal_irradiance:
+  case direct_radiation:
+  case european_aqi:
+  case freezing_level_height:
+  case global_tilted_irradiance:
+  case global_tilted_irradiance_instant:
+  case is_day:
+  case lightning_potential:
+  case ocean_current_direction:
+  case precipitation_probability:
+  case precipitation_probability_max:
+  case precipitation_probability_mean:
+  case precipitation_probability_min:
+  case relative_humidity_2m:
+  case shortwave_radiation:
+  case snowfall_height:
+  case sunshine_duration:
+  case swell_wave_direction:
+  case us_aqi:
+  case visibility:
+  case wave_direction:
+  case wave_direction_dominant:
+  case weather_code:
+  case wind_direction_10m:
+  case wind_direction_10m_dominant:
+  case wind_direction_120m:
+  case wind_direction_180m:
+  case wind_direction_80m:
+  case wind_wave_direction:
+    return 0;
+  case aerosol_optical_depth:
+  case et0_fao_evapotranspiration:
+  case evapotranspiration:
+  case snow_depth:
+  case swell_wave_height:
+  case vapour_pressure_deficit:
+  case wave_height:
+  case wave_height_max:
+  case wind_wave_height:
+    return 2;
+  case soil_moisture_0_to_1cm:
+  case soil_moisture_1_to_3cm:
+  case soil_moisture_27_to_81cm:
+  case soil_moisture_3_to_9cm:
+  case soil_moisture_9_to_27cm:
+    return 3;
+  default:
+    return 1;
+  }
+}
+
+size_t EncodeSnapshot(const WeatherApiResponse *response,
+                      const SnapshotSelection &selection, uint8_t *output,
+                      size_t capacity) {
+  if (!response)
+    return 0;
+  const ResponseIndex index(response);
+  Writer writer(output, capacity);
+  writer.byte('O');
+  writer.byte('S');
+  writer.byte(SNAPSHOT_VERSION);
+  writer.signed_varint(std::lround(response->latitude() * 1e4));
+  writer.signed_varint(std::lround(response->longitude() * 1e4));
+  const float elevation = response->elevation();
+  writer.signed_varint(std::isnan(elevation) ? 0 : std::lround(elevation));
+  writer.signed_varint(response->utc_offset_seconds());
+  writer.byte(response->model());
+
+  const struct {
+    const SectionIndex &index;
+    const TimeParamSet &params;
+    bool downsample;
+  } sections[SECTIONS] = {
+      {index.current(), selection.current, false},
+      {index.hourly(), selection.hourly, true},
+      {index.daily(), selection.daily, false},
+      {index.minutely_15(), selection.minutely_15, true},
+  };
+  // The mask is only known once the sections are written, patch it in.
+  const size_t mask_at = writer.size();
+  writer.byte(0);
+  uint8_t mask = 0;
+  for (size_t i = 0; i < SECTIONS; ++i) {
+    if (encode_section(&writer, sections[i].index, sections[i].params, i == 0,
+                       sections[i].downsample, selection))
+      mask |= 1 << i;
+  }
+  if (!writer.fits())
+    return 0;
+  output[mask_at] = mask;
+  return writer.size();
+}
+
+Span<float> SnapshotSection::values(TimeParam param) const {
+  if (!has(param) || _columns[_slots[param]].int64)
+    return Span<float>();
+  return Span<float>(_floats + _columns[_slots[param]].offset, _steps);
+}
+
+Span<int64_t> SnapshotSection::values_int64(TimeParam param) const {
+  if (!has(param) || !_columns[_slots[param]].int64)
+    return Span<int64_t>();
+  return Span<int64_t>(_ints + _columns[_slots[param]].offset, _steps);
+}
+
+float SnapshotSection::value(TimeParam param, float fallback) const {
+  const Span<float> column = values(param);
+  return column.empty() ? fallback : column[0];
+}
+
+Snapshot::Snapshot() { clear(); }
+
+void Snapshot::clear() {
+  for (SnapshotSection &section : _sections) {
+    section = SnapshotSection();
+    memset(section._slots, SnapshotSection::absent, sizeof(section._slots));
+  }
+  _floats.clear();
+  _ints.clear();
+  _latitude = _longitude = _elevation = 0.f;
+  _utc_offset_seconds = 0;
+  _model = Model_undefined;
+}
+
+bool Snapshot::decode(const uint8_t *data, size_t size) {
+  clear();
+  Reader reader(data, size);
+  uint8_t magic[3];
+  int64_t latitude, longitude, elevation, utc_offset;
+  uint8_t model, mask;
+  if (!reader.byte(&magic[0]) || !reader.byte(&magic[1]) ||
+      !reader.byte(&magic[2]) || magic[0] != 'O' || magic[1] != 'S' ||
+      magic[2] != SNAPSHOT_VERSION || !reader.signed_varint(&latitude) ||
+      !reader.signed_varint(&longitude) || !reader.signed_varint(&elevation) ||
+      !reader.signed_varint(&utc_offset) || !reader.byte(&model) ||
+      !reader.byte(&mask) || mask >> SECTIONS)
+    return false;
+
+  for (size_t s = 0; s < SECTIONS; ++s) {
+    if (!(mask & (1 << s)))
+      continue;
+    SnapshotSection &section = _sections[s];
+    uint64_t interval, steps, variables;
+    if (!reader.signed_varint(&section._start) || !reader.varint(&interval) ||
+        !reader.varint(&steps) || !reader.varint(&variables) ||
+        interval > (uint64_t)std::numeric_limits<int32_t>::max() ||
+        !variables || variables >= max_params ||
+        steps > reader.remaining() / variables) {
+      clear();
+      return false;
+    }
+    section._interval = (int32_t)interval;
+    section._steps = steps;
+    for (uint64_t v = 0; v < variables; ++v) {
+      uint8_t param, decimals;
+      if (!reader.byte(&param) || !reader.byte(&decimals) ||
+          param == undefined || param >= max_params ||
+          section._slots[param] != SnapshotSection::absent) {
+        clear();
+        return false;
+      }
+      const bool int64 = decimals == INT64_VALUES;
+      section._slots[param] = section._columns.size();
+      section._columns.push_back({int64 ? _ints.size() : _floats.size(),
+                                  int64});
+      const double scale = power_of_ten((int8_t)decimals);
+      int64_t previous = 0;
+      for (uint64_t i = 0; i < steps; ++i) {
+        uint64_t code;
+        if (!reader.varint(&code)) {
+          clear();
+          return false;
+        }
+        if (code)
+          previous = (int64_t)((uint64_t)previous +
+                               (uint64_t)unzigzag(code - 1));
+        if (int64)
+          _ints.push_back(code ? previous : 0);
+        else
+          _floats.push_back(code ? (float)(previous / scale) : NAN);
+      }
+    }
+  }
+
+  for (SnapshotSection &section : _sections) {
+    section._floats = _floats.data();
+    section._ints = _ints.data();
+  }
+  _latitude = latitude / 1e4f;
+  _longitude = longitude / 1e4f;
+  _elevation = (float)elevation;
+  _utc_offset_seconds = (int32_t)utc_offset;
+  _model = (Model)model;
+  return true;
+}
+
+} // namespace OM_SDK
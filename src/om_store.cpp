@@ -0,0 +1,164 @@
+#include "om_store.hpp"
+#include "om_cache.hpp"
+#include "om_internal.hpp"
+#include <cstdio>
+#include <cstring>
+#include <esp_log.h>
+
+#define STORE_MAGIC 0x43464d4f // "OMFC"
+#define STORE_VERSION 1
+
+namespace OM_SDK {
+
+struct StoreHeader {
+  uint32_t magic;
+  uint16_t version;
+  // VerifyMode the response passed before it was saved.
+  uint8_t verified;
+  uint8_t reserved;
+  uint64_t key;
+  int64_t fetched;
+  int64_t expires;
+  uint32_t size;
+  uint32_t crc;
+};
+
+static uint32_t crc32(const uint8_t *data, size_t size) {
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static void file_name(uint64_t key, char *out, size_t size) {
+  snprintf(out, size, "%016llx.omf", (unsigned long long)key);
+}
+
+StdioFileBackend::StdioFileBackend(const char *directory)
+    : _directory(directory) {}
+
+bool StdioFileBackend::path(const char *name, const char *suffix, char *out,
+                            size_t size) {
+  const int len = snprintf(out, size, "%s/%s%s", _directory, name, suffix);
+  return len > 0 && (size_t)len < size;
+}
+
+int StdioFileBackend::read(const char *name, size_t offset, void *data,
+                           size_t size) {
+  char file[128];
+  if (!path(name, "", file, sizeof(file)))
+    return -1;
+  FILE *f = fopen(file, "rb");
+  if (!f)
+    return -1;
+  int read = -1;
+  if (fseek(f, offset, SEEK_SET) == 0)
+    read = fread(data, 1, size, f);
+  fclose(f);
+  return read;
+}
+
+bool StdioFileBackend::write(const char *name, const void *header,
+                             size_t header_size, const void *data,
+                             size_t size) {
+  char file[128];
+  char tmp[128];
+  if (!path(name, "", file, sizeof(file)) ||
+      !path(name, ".tmp", tmp, sizeof(tmp)))
+    return false;
+  FILE *f = fopen(tmp, "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(header, 1, header_size, f) == header_size &&
+            fwrite(data, 1, size, f) == size;
+  ok = fclose(f) == 0 && ok;
+  if (ok && rename(tmp, file) != 0) {
+    // rename replaces the old file atomically on POSIX, LittleFS and FAT
+    // through the VFS, but some file systems refuse to rename over an
+    // existing file. Only then the old file goes first.
+    ok = ::remove(file) == 0 && rename(tmp, file) == 0;
+  }
+  if (!ok)
+    ::remove(tmp);
+  return ok;
+}
+
+bool StdioFileBackend::remove(const char *name) {
+  char file[128];
+  return path(name, "", file, sizeof(file)) && ::remove(file) == 0;
+}
+
+bool ForecastStore::save(uint64_t key, const WeatherResponse &response,
+                         time_t fetched) {
+  if (!response)
+    return false;
+  const time_t expires = response_expiry(response, fetched, _ttl_seconds);
+  StoreHeader header = {};
+  header.magic = STORE_MAGIC;
+  header.version = STORE_VERSION;
+  header.key = key;
+  header.fetched = fetched;
+  header.expires = expires;
+  header.verified = response.verified();
+  header.size = response.size();
+  header.crc = crc32(response.data(), response.size());
+  char name[24];
+  file_name(key, name, sizeof(name));
+  if (!_backend->write(name, &header, sizeof(header), response.data(),
+                       response.size())) {
+    ESP_LOGE(TAG, "Failed to store %s", name);
+    return false;
+  }
+  return true;
+}
+
+bool ForecastStore::load(uint64_t key, time_t now, WeatherResponse *output,
+                         StoredForecastInfo *info, bool allow_expired) {
+  char name[24];
+  file_name(key, name, sizeof(name));
+  StoreHeader header;
+  if (_backend->read(name, 0, &header, sizeof(header)) != sizeof(header))
+    return false;
+  if (header.magic != STORE_MAGIC || header.version != STORE_VERSION ||
+      header.key != key || header.size > CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE) {
+    ESP_LOGW(TAG, "Invalid stored forecast %s", name);
+    return false;
+  }
+  if (!allow_expired && header.expires <= now)
+    return false;
+  output->clear();
+  if (!output->reserve(header.size))
+    return false;
+  const int read = _backend->read(name, sizeof(header), output->tail(),
+                                  header.size);
+  if (read != (int)header.size ||
+      crc32(output->tail(), header.size) != header.crc) {
+    ESP_LOGW(TAG, "Truncated or corrupt stored forecast %s", name);
+    return false;
+  }
+  output->commit(header.size);
+  // The crc matched, so the bytes are the ones checked before saving.
+  if (header.verified <= verify_full)
+    output->set_verified((VerifyMode)header.verified);
+  if (!*output) {
+    output->clear();
+    return false;
+  }
+  if (info) {
+    info->key = key;
+    info->fetched = header.fetched;
+    info->expires = header.expires;
+  }
+  return true;
+}
+
+bool ForecastStore::remove(uint64_t key) {
+  char name[24];
+  file_name(key, name, sizeof(name));
+  return _backend->remove(name);
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,98 @@
+#include "om_trace.hpp"
+#include <chrono>
+#include <cmath>
+
+namespace OM_SDK {
+
+int64_t MonotonicUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Values below 8 get a bucket each, larger ones four per power of two.
+size_t LatencyHistogram::bucket(uint64_t value) {
+  if (value < 8)
+    return value;
+  const int exponent = 63 - __builtin_clzll(value);
+  const size_t quarter = (value >> (exponent - 2)) & 3;
+  return 8 + (exponent - 3) * 4 + quarter;
+}
+
+int64_t LatencyHistogram::upper_bound(size_t bucket) {
+  if (bucket < 8)
+    return bucket;
+  const int exponent = (bucket - 8) / 4 + 3;
+  const uint64_t quarter = (bucket - 8) % 4;
+  const uint64_t upper = ((5 + quarter) << (exponent - 2)) - 1;
+  return upper > INT64_MAX ? INT64_MAX : (int64_t)upper;
+}
+
+void LatencyHistogram::add(int64_t value) {
+  if (value < 0)
+    value = 0;
+  ++_buckets[bucket(value)];
+  ++_count;
+  if (value > _max)
+    _max = value;
+}
+
+void LatencyHistogram::clear() { *this = LatencyHistogram(); }
+
+int64_t LatencyHistogram::percentile(double percent) const {
+  if (!_count)
+    return 0;
+  size_t rank = (size_t)std::ceil(percent / 100 * _count);
+  if (rank < 1)
+    rank = 1;
+  size_t seen = 0;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    seen += _buckets[i];
+    if (seen >= rank) {
+      const int64_t upper = upper_bound(i);
+      return upper < _max ? upper : _max;
+    }
+  }
+  return _max;
+}
+
+void TraceRecorder::on_request(const RequestTrace &trace) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_stats.requests;
+  if (trace.outcome == outcome_cache_hit ||
+      trace.outcome == outcome_store_hit ||
+      trace.outcome == outcome_coalesced ||
+      trace.outcome == outcome_stale) {
+    // Nothing was sent, only the time to serve it is meaningful.
+    ++_stats.served_locally;
+    _stats.total.add(trace.total_time());
+    return;
+  }
+  if (trace.outcome == outcome_failed)
+    ++_stats.failures;
+  if (trace.connected_us)
+    _stats.connect.add(trace.connect_time());
+  if (trace.headers_us)
+    _stats.first_byte.add(trace.first_byte_time());
+  if (trace.body_us) {
+    _stats.transfer.add(trace.transfer_time());
+    _stats.decode.add(trace.decode_us);
+  }
+  _stats.total.add(trace.total_time());
+  _stats.body_bytes += trace.body_bytes;
+  _stats.buffer_grows += trace.buffer_grows;
+  if (trace.attempts > 1)
+    ++_stats.reconnects;
+}
+
+TraceRecorder::Stats TraceRecorder::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+void TraceRecorder::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stats = {};
+}
+
+} // namespace OM_SDK
@@ -0,0 +1,87 @@
+#include "om_transport.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace OM_SDK {
+
+esp_err_t ReplayTransport::prepare(const char *url) {
+  _url = url;
+  return ESP_OK;
+}
+
+esp_err_t ReplayTransport::set_header(const char *key, const char *value) {
+  delete_header(key);
+  _headers.emplace_back(key, value);
+  return ESP_OK;
+}
+
+esp_err_t ReplayTransport::delete_header(const char *key) {
+  _headers.erase(std::remove_if(_headers.begin(), _headers.end(),
+                                [key](const std::pair<std::string,
+                                                      std::string> &header) {
+                                  return header.first == key;
+                                }),
+                 _headers.end());
+  return ESP_OK;
+}
+
+esp_err_t ReplayTransport::open() {
+  if (_next >= _responses.size() && !(_repeat && !_responses.empty()))
+    return ESP_FAIL;
+  if (!_connected) {
+    _connected = true;
+    ++_connections;
+    if (_listener)
+      _listener->on_connected();
+  }
+  _current = &_responses[std::min(_next, _responses.size() - 1)];
+  if (_next < _responses.size())
+    ++_next;
+  _offset = 0;
+  _urls.push_back(_url);
+  return ESP_OK;
+}
+
+int64_t ReplayTransport::fetch_headers() {
+  if (!_current)
+    return -1;
+  if (_listener) {
+    for (const auto &header : _current->headers)
+      _listener->on_header(header.first.c_str(), header.second.c_str());
+    if (_current->close)
+      _listener->on_header("Connection", "close");
+  }
+  return _current->body.size();
+}
+
+int ReplayTransport::status_code() {
+  return _current ? _current->status_code : 0;
+}
+
+int ReplayTransport::read(uint8_t *buffer, size_t size) {
+  if (!_current)
+    return -1;
+  const size_t count = std::min(size, _current->body.size() - _offset);
+  memcpy(buffer, _current->body.data() + _offset, count);
+  _offset += count;
+  return count;
+}
+
+esp_err_t ReplayTransport::flush() {
+  if (_current)
+    _offset = _current->body.size();
+  return ESP_OK;
+}
+
+bool ReplayTransport::complete() {
+  return _current && _offset == _current->body.size();
+}
+
+void ReplayTransport::close() {
+  if (_connected && _listener)
+    _listener->on_disconnected();
+  _connected = false;
+  _current = nullptr;
+}
+
+} // namespace OM_SDK
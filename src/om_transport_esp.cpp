@@ -0,0 +1,121 @@
+#ifdef ESP_PLATFORM
+#include "om_transport.hpp"
+#include <cstring>
+#include <esp_crt_bundle.h>
+#include <esp_http_client.h>
+#include <sdkconfig.h>
+
+namespace OM_SDK {
+
+namespace {
+
+class EspTransport : public Transport {
+public:
+  explicit EspTransport(int timeout_ms) : _timeout_ms(timeout_ms) {}
+  ~EspTransport() override {
+    if (_client) {
+      esp_http_client_close(_client);
+      esp_http_client_cleanup(_client);
+    }
+  }
+
+  void set_timeout_ms(int timeout_ms) override {
+    _timeout_ms = timeout_ms;
+    if (_client)
+      esp_http_client_set_timeout_ms(_client, timeout_ms);
+  }
+
+  esp_err_t prepare(const char *url) override {
+    if (_client)
+      return esp_http_client_set_url(_client, url);
+    esp_http_client_config_t config = {};
+    memset(&config, 0, sizeof(config));
+    config.url = url;
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+    config.transport_type = HTTP_TRANSPORT_OVER_SSL;
+    config.timeout_ms = _timeout_ms;
+    config.keep_alive_enable = true;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    config.save_client_session = true;
+#endif
+    config.event_handler = on_event;
+    config.user_data = this;
+    _client = esp_http_client_init(&config);
+    if (!_client)
+      return ESP_FAIL;
+    return esp_http_client_set_method(_client, HTTP_METHOD_GET);
+  }
+
+  esp_err_t set_header(const char *key, const char *value) override {
+    return _client ? esp_http_client_set_header(_client, key, value)
+                   : ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t delete_header(const char *key) override {
+    return _client ? esp_http_client_delete_header(_client, key)
+                   : ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t open() override {
+    return _client ? esp_http_client_open(_client, 0) : ESP_ERR_INVALID_STATE;
+  }
+
+  int64_t fetch_headers() override {
+    return esp_http_client_fetch_headers(_client);
+  }
+
+  int status_code() override {
+    return esp_http_client_get_status_code(_client);
+  }
+
+  int read(uint8_t *buffer, size_t size) override {
+    return esp_http_client_read_response(_client, (char *)buffer, size);
+  }
+
+  esp_err_t flush() override {
+    int flushed = 0;
+    return esp_http_client_flush_response(_client, &flushed);
+  }
+
+  bool complete() override {
+    return esp_http_client_is_complete_data_received(_client);
+  }
+
+  void close() override {
+    if (_client)
+      esp_http_client_close(_client);
+  }
+
+private:
+  static esp_err_t on_event(esp_http_client_event_t *evt) {
+    EspTransport *self = (EspTransport *)evt->user_data;
+    if (!self->_listener)
+      return ESP_OK;
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_CONNECTED:
+      self->_listener->on_connected();
+      break;
+    case HTTP_EVENT_DISCONNECTED:
+      self->_listener->on_disconnected();
+      break;
+    case HTTP_EVENT_ON_HEADER:
+      self->_listener->on_header(evt->header_key, evt->header_value);
+      break;
+    default:
+      break;
+    }
+    return ESP_OK;
+  }
+
+  esp_http_client_handle_t _client{nullptr};
+  int _timeout_ms;
+};
+
+} // namespace
+
+std::unique_ptr<Transport> DefaultTransport(int timeout_ms) {
+  return std::unique_ptr<Transport>(new EspTransport(timeout_ms));
+}
+
+} // namespace OM_SDK
+#endif
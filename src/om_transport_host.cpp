@@ -0,0 +1,292 @@
+#ifndef ESP_PLATFORM
+#include "om_internal.hpp"
+#include "om_transport.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <netdb.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace OM_SDK {
+
+namespace {
+
+// Plain HTTP/1.1 over a POSIX socket, with keep-alive and chunked bodies.
+// There is no TLS: https URLs, the public API included, are refused and
+// Client::set_base_url() has to point at a plain http server.
+class HostTransport : public Transport {
+public:
+  explicit HostTransport(int timeout_ms) : _timeout_ms(timeout_ms) {}
+  ~HostTransport() override { close(); }
+
+  void set_timeout_ms(int timeout_ms) override {
+    _timeout_ms = timeout_ms;
+    apply_timeout();
+  }
+
+  esp_err_t prepare(const char *url) override {
+    static const char scheme[] = "http://";
+    if (strncmp(url, scheme, sizeof(scheme) - 1)) {
+      ESP_LOGE(TAG, "No TLS on the host, set_base_url() to an http:// "
+                    "server: %s",
+               url);
+      return ESP_ERR_NOT_SUPPORTED;
+    }
+    const char *authority = url + sizeof(scheme) - 1;
+    const char *path = strchr(authority, '/');
+    std::string host(authority, path ? path - authority : strlen(authority));
+    std::string port = "80";
+    const size_t colon = host.find(':');
+    if (colon != std::string::npos) {
+      port = host.substr(colon + 1);
+      host.resize(colon);
+    }
+    if (host != _host || port != _port)
+      close();
+    _host = host;
+    _port = port;
+    _path = path ? path : "/";
+    return ESP_OK;
+  }
+
+  esp_err_t set_header(const char *key, const char *value) override {
+    delete_header(key);
+    _headers.emplace_back(key, value);
+    return ESP_OK;
+  }
+
+  esp_err_t delete_header(const char *key) override {
+    for (auto it = _headers.begin(); it != _headers.end(); ++it) {
+      if (!strcasecmp(it->first.c_str(), key)) {
+        _headers.erase(it);
+        break;
+      }
+    }
+    return ESP_OK;
+  }
+
+  esp_err_t open() override {
+    if (_fd < 0 && connect() != ESP_OK)
+      return ESP_FAIL;
+    std::string request = "GET " + _path + " HTTP/1.1\r\nHost: " + _host +
+                          "\r\nConnection: keep-alive\r\n";
+    for (const auto &header : _headers)
+      request += header.first + ": " + header.second + "\r\n";
+    request += "\r\n";
+    _status_code = 0;
+    _content_length = -1;
+    _received = 0;
+    _chunked = false;
+    _chunk_left = 0;
+    _done = false;
+    size_t sent = 0;
+    while (sent < request.size()) {
+      const ssize_t n = ::send(_fd, request.data() + sent,
+                               request.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        close();
+        return ESP_FAIL;
+      }
+      sent += n;
+    }
+    return ESP_OK;
+  }
+
+  int64_t fetch_headers() override {
+    std::string line;
+    if (!read_line(&line) || sscanf(line.c_str(), "HTTP/%*s %d",
+                                    &_status_code) != 1)
+      return -1;
+    while (true) {
+      if (!read_line(&line))
+        return -1;
+      if (line.empty())
+        break;
+      const size_t colon = line.find(':');
+      if (colon == std::string::npos)
+        continue;
+      const std::string key = line.substr(0, colon);
+      size_t start = colon + 1;
+      while (start < line.size() && line[start] == ' ')
+        ++start;
+      const std::string value = line.substr(start);
+      if (!strcasecmp(key.c_str(), "Content-Length"))
+        _content_length = strtoll(value.c_str(), nullptr, 10);
+      else if (!strcasecmp(key.c_str(), "Transfer-Encoding") &&
+               !strcasecmp(value.c_str(), "chunked"))
+        _chunked = true;
+      if (_listener)
+        _listener->on_header(key.c_str(), value.c_str());
+    }
+    if (_status_code == 204 || _status_code == 304 ||
+        (!_chunked && _content_length == 0))
+      _done = true;
+    return _chunked || _content_length < 0 ? 0 : _content_length;
+  }
+
+  int status_code() override { return _status_code; }
+
+  int read(uint8_t *buffer, size_t size) override {
+    if (_done || !size)
+      return 0;
+    if (_chunked && !_chunk_left) {
+      std::string line;
+      if (!read_line(&line))
+        return -1;
+      if (line.empty() && !read_line(&line))
+        return -1;
+      _chunk_left = strtoull(line.c_str(), nullptr, 16);
+      if (!_chunk_left) {
+        // Trailers end with an empty line.
+        while (read_line(&line) && !line.empty()) {
+        }
+        _done = true;
+        return 0;
+      }
+    }
+    size_t want = size;
+    if (_chunked && want > _chunk_left)
+      want = _chunk_left;
+    if (!_chunked && _content_length >= 0 &&
+        want > (uint64_t)_content_length - _received)
+      want = _content_length - _received;
+    const int n = read_raw(buffer, want);
+    if (n <= 0) {
+      // Without a length the body ends with the connection.
+      if (n == 0 && !_chunked && _content_length < 0)
+        _done = true;
+      return n == 0 && _done ? 0 : -1;
+    }
+    _received += n;
+    if (_chunked)
+      _chunk_left -= n;
+    else if (_content_length >= 0 && _received == (uint64_t)_content_length)
+      _done = true;
+    return n;
+  }
+
+  esp_err_t flush() override {
+    uint8_t scratch[512];
+    int n;
+    while ((n = read(scratch, sizeof(scratch))) > 0) {
+    }
+    return n == 0 ? ESP_OK : ESP_FAIL;
+  }
+
+  bool complete() override { return _done; }
+
+  void close() override {
+    if (_fd < 0)
+      return;
+    ::close(_fd);
+    _fd = -1;
+    _start = _end = 0;
+    if (_listener)
+      _listener->on_disconnected();
+  }
+
+private:
+  esp_err_t connect() {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(_host.c_str(), _port.c_str(), &hints, &addresses))
+      return ESP_FAIL;
+    for (addrinfo *a = addresses; a && _fd < 0; a = a->ai_next) {
+      _fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (_fd < 0)
+        continue;
+      apply_timeout();
+      if (::connect(_fd, a->ai_addr, a->ai_addrlen)) {
+        ::close(_fd);
+        _fd = -1;
+      }
+    }
+    freeaddrinfo(addresses);
+    if (_fd < 0)
+      return ESP_FAIL;
+    _start = _end = 0;
+    if (_listener)
+      _listener->on_connected();
+    return ESP_OK;
+  }
+
+  void apply_timeout() {
+    if (_fd < 0)
+      return;
+    timeval tv = {_timeout_ms / 1000, (_timeout_ms % 1000) * 1000};
+    setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  }
+
+  bool fill() {
+    if (_fd < 0)
+      return false;
+    const ssize_t n = ::recv(_fd, _buffer, sizeof(_buffer), 0);
+    if (n <= 0)
+      return false;
+    _start = 0;
+    _end = n;
+    return true;
+  }
+
+  // Buffered bytes first, then straight from the socket into `buffer`.
+  int read_raw(uint8_t *buffer, size_t size) {
+    if (_start < _end) {
+      const size_t n = std::min(size, _end - _start);
+      memcpy(buffer, _buffer + _start, n);
+      _start += n;
+      return n;
+    }
+    if (_fd < 0)
+      return -1;
+    const ssize_t n = ::recv(_fd, buffer, size, 0);
+    return n < 0 ? -1 : (int)n;
+  }
+
+  bool read_line(std::string *line) {
+    line->clear();
+    while (true) {
+      if (_start == _end && !fill())
+        return false;
+      const char c = _buffer[_start++];
+      if (c == '\n') {
+        if (!line->empty() && line->back() == '\r')
+          line->pop_back();
+        return true;
+      }
+      *line += c;
+    }
+  }
+
+  int _timeout_ms;
+  int _fd{-1};
+  std::string _host;
+  std::string _port;
+  std::string _path;
+  std::vector<std::pair<std::string, std::string>> _headers;
+  char _buffer[1024];
+  size_t _start{0};
+  size_t _end{0};
+  int _status_code{0};
+  int64_t _content_length{-1};
+  uint64_t _received{0};
+  bool _chunked{false};
+  uint64_t _chunk_left{0};
+  bool _done{false};
+};
+
+} // namespace
+
+std::unique_ptr<Transport> DefaultTransport(int timeout_ms) {
+  return std::unique_ptr<Transport>(new HostTransport(timeout_ms));
+}
+
+} // namespace OM_SDK
+#endif
@@ -1,100 +1,155 @@
+#include "om_internal.hpp"
 #include "open_meteo.hpp"
 #include <algorithm>
-#include <esp_crt_bundle.h>
-#include <esp_http_client.h>
+#include <array>
+#include <cstring>
 #include <esp_log.h>
-#include <sstream>
-
-#define TAG "OM_SDK"
-#define PAST_DAY_MAX 92
-#define FORCAST_DAY_MAX 16
-#define WEB_URL "https://api.open-meteo.com"
-#define FORECAST "/v1/forecast"
-#define MAX_HTTP_OUTPUT_BUFFER_CALLOC 3 * 1024
-#define ARRAY_LENGTH(array) (sizeof((array)) / sizeof((array)[0]))
 
 namespace OM_SDK {
 
+namespace {
+
+struct ParamName {
+  TimeParam param;
+  const char *name;
+};
+
+// Query name of every TimeParam, in enum order.
+constexpr ParamName paramNames[] = {
+    {undefined, "undefined"},
+    {apparent_temperature, "apparent_temperature"},
+    {apparent_temperature_max, "apparent_temperature_max"},
+    {apparent_temperature_min, "apparent_temperature_min"},
+    {cape, "cape"},
+    {cloud_cover, "cloud_cover"},
+    {cloud_cover_high, "cloud_cover_high"},
+    {cloud_cover_low, "cloud_cover_low"},
+    {cloud_cover_mid, "cloud_cover_mid"},
+    {daylight_duration, "daylight_duration"},
+    {dew_point_2m, "dew_point_2m"},
+    {diffuse_radiation, "diffuse_radiation"},
+    {direct_normal_irradiance, "direct_normal_irradiance"},
+    {direct_radiation, "direct_radiation"},
+    {et0_fao_evapotranspiration, "et0_fao_evapotranspiration"},
+    {evapotranspiration, "evapotranspiration"},
+    {freezing_level_height, "freezing_level_height"},
+    {global_tilted_irradiance, "global_tilted_irradiance"},
+    {global_tilted_irradiance_instant, "global_tilted_irradiance_instant"},
+    {is_day, "is_day"},
+    {lightning_potential, "lightning_potential"},
+    {precipitation, "precipitation"},
+    {precipitation_hours, "precipitation_hours"},
+    {precipitation_probability, "precipitation_probability"},
+    {precipitation_probability_max, "precipitation_probability_max"},
+    {precipitation_probability_mean, "precipitation_probability_mean"},
+    {precipitation_probability_min, "precipitation_probability_min"},
+    {precipitation_sum, "precipitation_sum"},
+    {pressure_msl, "pressure_msl"},
+    {rain, "rain"},
+    {rain_sum, "rain_sum"},
+    {relative_humidity_2m, "relative_humidity_2m"},
+    {shortwave_radiation, "shortwave_radiation"},
+    {shortwave_radiation_sum, "shortwave_radiation_sum"},
+    {showers, "showers"},
+    {showers_sum, "showers_sum"},
+    {snow_depth, "snow_depth"},
+    {snowfall, "snowfall"},
+    {snowfall_height, "snowfall_height"},
+    {snowfall_sum, "snowfall_sum"},
+    {soil_moisture_0_to_1cm, "soil_moisture_0_to_1cm"},
+    {soil_moisture_1_to_3cm, "soil_moisture_1_to_3cm"},
+    {soil_moisture_27_to_81cm, "soil_moisture_27_to_81cm"},
+    {soil_moisture_3_to_9cm, "soil_moisture_3_to_9cm"},
+    {soil_moisture_9_to_27cm, "soil_moisture_9_to_27cm"},
+    {soil_temperature_0cm, "soil_temperature_0cm"},
+    {soil_temperature_18cm, "soil_temperature_18cm"},
+    {soil_temperature_54cm, "soil_temperature_54cm"},
+    {soil_temperature_6cm, "soil_temperature_6cm"},
+    {sunrise, "sunrise"},
+    {sunset, "sunset"},
+    {sunshine_duration, "sunshine_duration"},
+    {surface_pressure, "surface_pressure"},
+    {temperature_2m, "temperature_2m"},
+    {temperature_2m_max, "temperature_2m_max"},
+    {temperature_2m_min, "temperature_2m_min"},
+    {uv_index_clear_sky_max, "uv_index_clear_sky_max"},
+    {uv_index_max, "uv_index_max"},
+    {vapour_pressure_deficit, "vapour_pressure_deficit"},
+    {visibility, "visibility"},
+    {weather_code, "weather_code"},
+    {wind_direction_10m, "wind_direction_10m"},
+    {wind_direction_10m_dominant, "wind_direction_10m_dominant"},
+    {wind_direction_120m, "wind_direction_120m "},
+    {wind_direction_180m, "wind_direction_180m "},
+    {wind_direction_80m, "wind_direction_80m "},
+    {wind_gusts_10m, "wind_gusts_10m "},
+    {wind_gusts_10m_max, "wind_gusts_10m_max "},
+    {wind_speed_10m, "wind_speed_10m "},
+    {wind_speed_10m_max, "wind_speed_10m_max "},
+    {wind_speed_120m, "wind_speed_120m "},
+    {wind_speed_180m, "wind_speed_180m"},
+    {wind_speed_80m, "wind_speed_80m"},
+    {uv_index, "uv_index"},
+    {pm10, "pm10"},
+    {pm2_5, "pm2_5"},
+    {carbon_monoxide, "carbon_monoxide"},
+    {nitrogen_dioxide, "nitrogen_dioxide"},
+    {sulphur_dioxide, "sulphur_dioxide"},
+    {ozone, "ozone"},
+    {aerosol_optical_depth, "aerosol_optical_depth"},
+    {dust, "dust"},
+    {uv_index_clear_sky, "uv_index_clear_sky"},
+    {ammonia, "ammonia"},
+    {alder_pollen, "alder_pollen"},
+    {birch_pollen, "birch_pollen"},
+    {grass_pollen, "grass_pollen"},
+    {mugwort_pollen, "mugwort_pollen"},
+    {olive_pollen, "olive_pollen"},
+    {ragweed_pollen, "ragweed_pollen"},
+    {european_aqi, "european_aqi"},
+    {us_aqi, "us_aqi"},
+    {wave_height, "wave_height"},
+    {wave_direction, "wave_direction"},
+    {wave_period, "wave_period"},
+    {wind_wave_height, "wind_wave_height"},
+    {wind_wave_direction, "wind_wave_direction"},
+    {wind_wave_period, "wind_wave_period"},
+    {wind_wave_peak_period, "wind_wave_peak_period"},
+    {swell_wave_height, "swell_wave_height"},
+    {swell_wave_direction, "swell_wave_direction"},
+    {swell_wave_period, "swell_wave_period"},
+    {swell_wave_peak_period, "swell_wave_peak_period"},
+    {ocean_current_velocity, "ocean_current_velocity"},
+    {ocean_current_direction, "ocean_current_direction"},
+    {wave_height_max, "wave_height_max"},
+    {wave_direction_dominant, "wave_direction_dominant"},
+    {wave_period_max, "wave_period_max"},
+    {max_params, "max_params"},
+};
+
+constexpr bool names_in_param_order() {
+  for (size_t i = 0; i < ARRAY_LENGTH(paramNames); ++i) {
+    if (paramNames[i].param != (TimeParam)i)
+      return false;
+  }
+  return true;
+}
+
+static_assert(ARRAY_LENGTH(paramNames) == max_params + 1,
+              "one name per TimeParam");
+static_assert(names_in_param_order(), "paramNames out of TimeParam order");
+
+} // namespace
+
 const char *const *EnumNamesTimeParams() {
-  static const char *const names[] = {
-      "undefined",
-      "apparent_temperature",
-      "apparent_temperature_max",
-      "apparent_temperature_min",
-      "cape",
-      "cloud_cover",
-      "cloud_cover_high",
-      "cloud_cover_low",
-      "cloud_cover_mid",
-      "daylight_duration",
-      "dew_point_2m",
-      "diffuse_radiation",
-      "direct_normal_irradiance",
-      "direct_radiation",
-      "et0_fao_evapotranspiration",
-      "evapotranspiration",
-      "freezing_level_height",
-      "global_tilted_irradiance",
-      "global_tilted_irradiance_instant",
-      "is_day",
-      "lightning_potential",
-      "precipitation",
-      "precipitation_hours",
-      "precipitation_probability",
-      "precipitation_probability_max",
-      "precipitation_probability_mean",
-      "precipitation_probability_min",
-      "precipitation_sum",
-      "pressure_msl",
-      "rain",
-      "rain_sum",
-      "relative_humidity_2m",
-      "shortwave_radiation",
-      "shortwave_radiation_sum",
-      "showers",
-      "showers_sum",
-      "snow_depth",
-      "snowfall",
-      "snowfall_height",
-      "snowfall_sum",
-      "soil_moisture_0_to_1cm",
-      "soil_moisture_1_to_3cm",
-      "soil_moisture_27_to_81cm",
-      "soil_moisture_3_to_9cm",
-      "soil_moisture_9_to_27cm",
-      "soil_temperature_0cm",
-      "soil_temperature_18cm",
-      "soil_temperature_54cm",
-      "soil_temperature_6cm",
-      "sunrise",
-      "sunset",
-      "sunshine_duration",
-      "surface_pressure",
-      "temperature_2m",
-      "temperature_2m_max",
-      "temperature_2m_min",
-      "uv_index_clear_sky_max",
-      "uv_index_max",
-      "vapour_pressure_deficit",
-      "visibility",
-      "weather_code",
-      "wind_direction_10m",
-      "wind_direction_10m_dominant",
-      "wind_direction_120m ",
-      "wind_direction_180m ",
-      "wind_direction_80m ",
-      "wind_gusts_10m ",
-      "wind_gusts_10m_max ",
-      "wind_speed_10m ",
-      "wind_speed_10m_max ",
-      "wind_speed_120m ",
-      "wind_speed_180m",
-      "wind_speed_80m",
-      "uv_index",
-      "max_params",
-      nullptr,
-  };
-  return names;
+  // nullptr terminated, as the other EnumNames tables.
+  static const std::array<const char *, max_params + 2> names = [] {
+    std::array<const char *, max_params + 2> names{};
+    for (const ParamName &entry : paramNames)
+      names[entry.param] = entry.name;
+    return names;
+  }();
+  return names.data();
 }
 
 const char *const *EnumNamesTemperatureUnit() {
@@ -141,6 +196,25 @@ const char *const *EnumNamesCellSelection() {
   return names;
 }
 
+uint32_t ModelUpdateInterval(openmeteo_sdk::Model model) {
+  switch (model) {
+  case openmeteo_sdk::Model_gfs_hrrr:
+    return 1 * 3600;
+  case openmeteo_sdk::Model_icon_d2:
+  case openmeteo_sdk::Model_icon_eu:
+  case openmeteo_sdk::Model_meteofrance_arome_france_hd:
+    return 3 * 3600;
+  case openmeteo_sdk::Model_gfs_seamless:
+  case openmeteo_sdk::Model_gfs_global:
+  case openmeteo_sdk::Model_icon_global:
+  case openmeteo_sdk::Model_ecmwf_ifs04:
+    return 6 * 3600;
+  default:
+    break;
+  }
+  return 0;
+}
+
 const char *EnumNamesWeatherCode(WeatherCode code) {
   switch (code) {
   case Clear_sky:
@@ -206,7 +280,7 @@ const char *EnumNamesWeatherCode(WeatherCode code) {
   return "unknown";
 }
 
-const TimeParam currentFilter[] = {
+constexpr TimeParam currentFilter[] = {
     undefined,
     apparent_temperature,
     cape,
@@ -261,7 +335,7 @@ const TimeParam currentFilter[] = {
     wind_speed_80m,
 };
 
-const TimeParam hourlyFilter[] = {
+constexpr TimeParam hourlyFilter[] = {
     undefined,
     temperature_2m,
     relative_humidity_2m,
@@ -313,7 +387,7 @@ const TimeParam hourlyFilter[] = {
     uv_index,
 };
 
-const TimeParam minutely_15Filter[]{
+constexpr TimeParam minutely_15Filter[] = {
     undefined,
     temperature_2m,
     relative_humidity_2m,
@@ -343,7 +417,7 @@ const TimeParam minutely_15Filter[]{
     weather_code,
 };
 
-const TimeParam dailyFilter[] = {
+constexpr TimeParam dailyFilter[] = {
     undefined,
     temperature_2m_max,
     temperature_2m_min,
@@ -371,21 +445,283 @@ const TimeParam dailyFilter[] = {
     uv_index_clear_sky_max,
 };
 
-void filterTimeParams(TimeParam *params, const TimeParam *filter,
-                      const int filter_size) {
-  if (!params || !filter)
-    return;
-  TimeParam *value = params;
-  while (value && *value != max_params) {
-    int i = 0;
-    while (i < filter_size && filter[i] != *value) {
-      ++i;
-    }
-    if (i == filter_size) {
-      *value = undefined;
-    }
-    ++value;
-  }
+// Air quality, marine, archive and ensemble tables. Air quality and marine
+// accept the same variables in the current and hourly sections.
+constexpr TimeParam airQualityFilter[] = {
+    undefined,
+    pm10,
+    pm2_5,
+    carbon_monoxide,
+    nitrogen_dioxide,
+    sulphur_dioxide,
+    ozone,
+    aerosol_optical_depth,
+    dust,
+    uv_index,
+    uv_index_clear_sky,
+    ammonia,
+    alder_pollen,
+    birch_pollen,
+    grass_pollen,
+    mugwort_pollen,
+    olive_pollen,
+    ragweed_pollen,
+    european_aqi,
+    us_aqi,
+};
+
+constexpr TimeParam marineFilter[] = {
+    undefined,
+    wave_height,
+    wave_direction,
+    wave_period,
+    wind_wave_height,
+    wind_wave_direction,
+    wind_wave_period,
+    wind_wave_peak_period,
+    swell_wave_height,
+    swell_wave_direction,
+    swell_wave_period,
+    swell_wave_peak_period,
+    ocean_current_velocity,
+    ocean_current_direction,
+};
+
+constexpr TimeParam marineDailyFilter[] = {
+    undefined,
+    wave_height_max,
+    wave_direction_dominant,
+    wave_period_max,
+};
+
+constexpr TimeParam archiveHourlyFilter[] = {
+    undefined,
+    temperature_2m,
+    relative_humidity_2m,
+    dew_point_2m,
+    apparent_temperature,
+    pressure_msl,
+    surface_pressure,
+    cloud_cover,
+    cloud_cover_low,
+    cloud_cover_mid,
+    cloud_cover_high,
+    wind_speed_10m,
+    wind_direction_10m,
+    wind_gusts_10m,
+    shortwave_radiation,
+    direct_radiation,
+    direct_normal_irradiance,
+    diffuse_radiation,
+    global_tilted_irradiance,
+    vapour_pressure_deficit,
+    et0_fao_evapotranspiration,
+    precipitation,
+    snowfall,
+    rain,
+    weather_code,
+    snow_depth,
+    sunshine_duration,
+    is_day,
+};
+
+constexpr TimeParam archiveDailyFilter[] = {
+    undefined,
+    temperature_2m_max,
+    temperature_2m_min,
+    apparent_temperature_max,
+    apparent_temperature_min,
+    precipitation_sum,
+    rain_sum,
+    snowfall_sum,
+    precipitation_hours,
+    weather_code,
+    sunrise,
+    sunset,
+    sunshine_duration,
+    daylight_duration,
+    wind_speed_10m_max,
+    wind_gusts_10m_max,
+    wind_direction_10m_dominant,
+    shortwave_radiation_sum,
+    et0_fao_evapotranspiration,
+};
+
+constexpr TimeParam ensembleHourlyFilter[] = {
+    undefined,
+    temperature_2m,
+    relative_humidity_2m,
+    dew_point_2m,
+    apparent_temperature,
+    pressure_msl,
+    surface_pressure,
+    cloud_cover,
+    wind_speed_10m,
+    wind_speed_80m,
+    wind_speed_120m,
+    wind_direction_10m,
+    wind_direction_80m,
+    wind_direction_120m,
+    wind_gusts_10m,
+    shortwave_radiation,
+    direct_radiation,
+    direct_normal_irradiance,
+    diffuse_radiation,
+    global_tilted_irradiance,
+    vapour_pressure_deficit,
+    cape,
+    et0_fao_evapotranspiration,
+    precipitation,
+    snowfall,
+    rain,
+    weather_code,
+    snow_depth,
+    freezing_level_height,
+    visibility,
+    sunshine_duration,
+    uv_index,
+};
+
+constexpr TimeParam ensembleDailyFilter[] = {
+    undefined,
+    temperature_2m_max,
+    temperature_2m_min,
+    apparent_temperature_max,
+    apparent_temperature_min,
+    precipitation_sum,
+    rain_sum,
+    snowfall_sum,
+    precipitation_hours,
+    wind_speed_10m_max,
+    wind_gusts_10m_max,
+    wind_direction_10m_dominant,
+    shortwave_radiation_sum,
+    et0_fao_evapotranspiration,
+};
+
+template <size_t N>
+constexpr TimeParamSet filterMask(const TimeParam (&filter)[N]) {
+  TimeParamSet mask;
+  for (TimeParam param : filter)
+    mask = mask | TimeParamSet{param};
+  return mask;
+}
+
+constexpr TimeParamSet currentMask = filterMask(currentFilter);
+constexpr TimeParamSet hourlyMask = filterMask(hourlyFilter);
+constexpr TimeParamSet minutely_15Mask = filterMask(minutely_15Filter);
+constexpr TimeParamSet dailyMask = filterMask(dailyFilter);
+constexpr TimeParamSet airQualityMask = filterMask(airQualityFilter);
+constexpr TimeParamSet marineMask = filterMask(marineFilter);
+constexpr TimeParamSet marineDailyMask = filterMask(marineDailyFilter);
+constexpr TimeParamSet archiveHourlyMask = filterMask(archiveHourlyFilter);
+constexpr TimeParamSet archiveDailyMask = filterMask(archiveDailyFilter);
+constexpr TimeParamSet ensembleHourlyMask = filterMask(ensembleHourlyFilter);
+constexpr TimeParamSet ensembleDailyMask = filterMask(ensembleDailyFilter);
+
+// Every table starts with undefined, which no mask holds, followed by
+// distinct values.
+static_assert(currentMask.size() == ARRAY_LENGTH(currentFilter) - 1,
+              "currentFilter holds a duplicate");
+static_assert(hourlyMask.size() == ARRAY_LENGTH(hourlyFilter) - 1,
+              "hourlyFilter holds a duplicate");
+static_assert(minutely_15Mask.size() == ARRAY_LENGTH(minutely_15Filter) - 1,
+              "minutely_15Filter holds a duplicate");
+static_assert(dailyMask.size() == ARRAY_LENGTH(dailyFilter) - 1,
+              "dailyFilter holds a duplicate");
+static_assert(airQualityMask.size() == ARRAY_LENGTH(airQualityFilter) - 1,
+              "airQualityFilter holds a duplicate");
+static_assert(marineMask.size() == ARRAY_LENGTH(marineFilter) - 1,
+              "marineFilter holds a duplicate");
+static_assert(marineDailyMask.size() == ARRAY_LENGTH(marineDailyFilter) - 1,
+              "marineDailyFilter holds a duplicate");
+static_assert(archiveHourlyMask.size() == ARRAY_LENGTH(archiveHourlyFilter) - 1,
+              "archiveHourlyFilter holds a duplicate");
+static_assert(archiveDailyMask.size() == ARRAY_LENGTH(archiveDailyFilter) - 1,
+              "archiveDailyFilter holds a duplicate");
+static_assert(ensembleHourlyMask.size() ==
+                  ARRAY_LENGTH(ensembleHourlyFilter) - 1,
+              "ensembleHourlyFilter holds a duplicate");
+static_assert(ensembleDailyMask.size() == ARRAY_LENGTH(ensembleDailyFilter) - 1,
+              "ensembleDailyFilter holds a duplicate");
+static_assert(hourlyMask.contains(uv_index) && !hourlyMask.contains(sunrise),
+              "hourly mask out of sync with hourlyFilter");
+static_assert(dailyMask.contains(sunrise) && !dailyMask.contains(rain),
+              "daily mask out of sync with dailyFilter");
+static_assert(currentMask.contains(is_day) && !currentMask.contains(uv_index),
+              "current mask out of sync with currentFilter");
+static_assert(minutely_15Mask.contains(lightning_potential) &&
+                  !minutely_15Mask.contains(pressure_msl),
+              "minutely_15 mask out of sync with minutely_15Filter");
+
+const Endpoint forecast_endpoint = {
+    WEB_URL,
+    FORECAST,
+    currentMask,
+    hourlyMask,
+    dailyMask,
+    minutely_15Mask,
+    PAST_DAY_MAX,
+    FORCAST_DAY_MAX,
+    7,
+    0,
+};
+
+const Endpoint air_quality_endpoint = {
+    AIR_QUALITY_URL,
+    AIR_QUALITY,
+    airQualityMask,
+    airQualityMask,
+    TimeParamSet{},
+    TimeParamSet{},
+    PAST_DAY_MAX,
+    7,
+    5,
+    0,
+};
+
+const Endpoint marine_endpoint = {
+    MARINE_URL,
+    MARINE,
+    marineMask,
+    marineMask,
+    marineDailyMask,
+    TimeParamSet{},
+    PAST_DAY_MAX,
+    8,
+    7,
+    0,
+};
+
+const Endpoint archive_endpoint = {
+    ARCHIVE_URL,
+    ARCHIVE,
+    TimeParamSet{},
+    archiveHourlyMask,
+    archiveDailyMask,
+    TimeParamSet{},
+    0,
+    0,
+    0,
+    92,
+};
+
+const Endpoint ensemble_endpoint = {
+    ENSEMBLE_URL,
+    ENSEMBLE,
+    TimeParamSet{},
+    ensembleHourlyMask,
+    ensembleDailyMask,
+    TimeParamSet{},
+    PAST_DAY_MAX,
+    35,
+    7,
+    0,
+};
+
+static TimeParamSet selection(const TimeParamSet &set, const TimeParam *array,
+                              const TimeParamSet &mask) {
+  return (set | TimeParamSet::from_array(array)) & mask;
 }
 
 void validate_time_interval(time_t *t1, time_t *t2) {
@@ -401,186 +737,145 @@ void validate_time_interval(time_t *t1, time_t *t2) {
 }
 
 void validateParams(OpenMeteoParams *params) {
-  filterTimeParams(params->hourly, hourlyFilter, ARRAY_LENGTH(hourlyFilter));
-  filterTimeParams(params->daily, dailyFilter, ARRAY_LENGTH(dailyFilter));
-  filterTimeParams(params->minutely_15, minutely_15Filter,
-                   ARRAY_LENGTH(minutely_15Filter));
-  filterTimeParams(params->current, currentFilter, ARRAY_LENGTH(currentFilter));
-  if (params->past_days >= PAST_DAY_MAX) {
-    params->past_days = PAST_DAY_MAX;
+  validateParams(forecast_endpoint, params);
+}
+
+void validateParams(const Endpoint &endpoint, OpenMeteoParams *params) {
+  if (params->past_days >= endpoint.past_days_max) {
+    params->past_days = endpoint.past_days_max;
   }
-  if (params->forecast_days >= FORCAST_DAY_MAX) {
-    params->forecast_days = FORCAST_DAY_MAX;
+  if (params->forecast_days >= endpoint.forecast_days_max) {
+    params->forecast_days = endpoint.forecast_days_max;
   }
   validate_time_interval(&params->start_date, &params->end_date);
   validate_time_interval(&params->start_hour, &params->end_hour);
   validate_time_interval(&params->start_minutely_15, &params->end_minutely_15);
 }
 
-std::string add(time_t value, const char *name, const char *format) {
-  struct tm timeinfo;
-  localtime_r(&value, &timeinfo);
-  char strftime_buf[17] = {0};
-  strftime(strftime_buf, ARRAY_LENGTH(strftime_buf), format, &timeinfo);
-  std::stringstream ss;
+void add(QueryBuilder *q, time_t value, const char *name, const char *format) {
   if (value != 0)
-    ss << "&" << name << "=" << strftime_buf;
-  return ss.str();
+    q->append("&").append(name).append("=").append_time(value, format);
 }
 
-std::string add(int8_t value, const char *name) {
-  std::stringstream ss;
+void add(QueryBuilder *q, int8_t value, const char *name) {
   if (value > 0)
-    ss << "&" << name << "=" << (int)value;
-  return ss.str();
+    q->append("&").append(name).append("=").append((int)value);
 }
 
-std::string timeParamstoString(TimeParam *params) {
-  if (!params)
-    return "";
-  std::stringstream ss;
-  TimeParam *param = params;
-  while (param && *param != max_params) {
-    if (*param != undefined) {
-      ss << EnumNamesTimeParams()[*param];
-      break;
-    }
-    param++;
-  }
-  param++;
-  while (param && *param != max_params) {
-    if (*param != undefined)
-      ss << "," << EnumNamesTimeParams()[*param];
-    param++;
-  }
-  return ss.str();
+void timeParams_to_args(QueryBuilder *q, const TimeParamSet &params,
+                        const char *str) {
+  const char *separator = str;
+  params.for_each([&](TimeParam param) {
+    q->append(separator).append(EnumNamesTimeParams()[param]);
+    separator = ",";
+  });
 }
 
-std::string timeParams_to_args(TimeParam *params, const char *str) {
-  if (!params)
-    return "";
-  std::stringstream ss;
-  std::string value = timeParamstoString(params);
-  if (value.empty())
-    return "";
-  ss << str << value;
-  return ss.str();
+bool paramsToString(const OpenMeteoParams *p, QueryBuilder *q) {
+  const Location location = {p->latitude, p->longitude};
+  return paramsToString(p, &location, 1, q);
 }
 
-std::string paramsToString(const OpenMeteoParams *p) {
-  std::stringstream ss;
-  ss << "?latitude=" << p->latitude << "&longitude=" << p->longitude
-     << "&format=flatbuffers";
+bool paramsToString(const OpenMeteoParams *p, const Location *locations,
+                    size_t count, QueryBuilder *q) {
+  return paramsToString(forecast_endpoint, p, locations, count, q);
+}
+
+bool paramsToString(const Endpoint &endpoint, const OpenMeteoParams *p,
+                    const Location *locations, size_t count, QueryBuilder *q) {
+  q->append("?latitude=");
+  for (size_t i = 0; i < count; ++i) {
+    if (i)
+      q->append(",");
+    q->append(locations[i].latitude);
+  }
+  q->append("&longitude=");
+  for (size_t i = 0; i < count; ++i) {
+    if (i)
+      q->append(",");
+    q->append(locations[i].longitude);
+  }
+  q->append("&format=flatbuffers");
   if (strcmp(CONFIG_OPEN_METEO_API_KEY, "")) {
-    ss << ",apikey=" CONFIG_OPEN_METEO_API_KEY;
+    q->append(",apikey=" CONFIG_OPEN_METEO_API_KEY);
   }
   bool force_timezone_to_auto = false;
   if (!p->elevation_default)
-    ss << "&elevation=" << p->elevation;
-  ss << timeParams_to_args(p->hourly, "&hourly=")
-     << timeParams_to_args(p->minutely_15, "&minutely_15=")
-     << timeParams_to_args(p->current, "&current=");
-  if (p->daily) {
-    ss << timeParams_to_args(p->daily, "&daily=");
+    q->append("&elevation=").append(p->elevation);
+  timeParams_to_args(q, selection(p->hourly_set, p->hourly, endpoint.hourly),
+                     "&hourly=");
+  timeParams_to_args(
+      q, selection(p->minutely_15_set, p->minutely_15, endpoint.minutely_15),
+      "&minutely_15=");
+  timeParams_to_args(
+      q, selection(p->current_set, p->current, endpoint.current), "&current=");
+  const TimeParamSet daily = selection(p->daily_set, p->daily, endpoint.daily);
+  if (!daily.empty()) {
+    timeParams_to_args(q, daily, "&daily=");
     force_timezone_to_auto = true;
   }
   if (p->temperature_unit != undefined_tmp_unit)
-    ss << "&temperature_unit="
-       << EnumNamesTemperatureUnit()[p->temperature_unit];
+    q->append("&temperature_unit=")
+        .append(EnumNamesTemperatureUnit()[p->temperature_unit]);
   if (p->wind_speed_unit != undefined_wind_unit)
-    ss << "&wind_speed_unit=" << EnumNamesWindSpeedUnit()[p->wind_speed_unit];
+    q->append("&wind_speed_unit=")
+        .append(EnumNamesWindSpeedUnit()[p->wind_speed_unit]);
   if (p->precipitation_unit != undefined_precipitation_unit)
-    ss << "&precipitation_unit="
-       << EnumNamesPrecipitationUnit()[p->precipitation_unit];
+    q->append("&precipitation_unit=")
+        .append(EnumNamesPrecipitationUnit()[p->precipitation_unit]);
   if (p->timeformat != undefined_timeformat)
-    ss << "&timeformat=" << EnumNamesTimeFormat()[p->timeformat];
+    q->append("&timeformat=").append(EnumNamesTimeFormat()[p->timeformat]);
   if (force_timezone_to_auto) {
-    ss << "&timezone=auto";
+    q->append("&timezone=auto");
   } else if (p->timezone) {
-    ss << "&timezone=" << p->timezone;
+    q->append("&timezone=").append(p->timezone);
   }
 
-  ss << add(p->past_days, "past_days") << add(p->forecast_days, "forecast_days")
-     << add(p->forecast_hours, "forecast_hours")
-     << add(p->forecast_minutely_15, "forecast_minutely_15")
-     << add(p->past_hours, "past_hours")
-     << add(p->past_minutely_15, "pas_minutely_15")
-     << add(p->start_date, "start_date", "%F")
-     << add(p->end_date, "end_date", "%F")
-     << add(p->start_hour, "start_hour", "%FT%T")
-     << add(p->end_hour, "end_hour", "%FT%T")
-     << add(p->start_minutely_15, "start_minutely_15", "%FT%T")
-     << add(p->end_minutely_15, "end_minutely_15", "%FT%T");
+  add(q, p->past_days, "past_days");
+  add(q, p->forecast_days, "forecast_days");
+  add(q, p->forecast_hours, "forecast_hours");
+  add(q, p->forecast_minutely_15, "forecast_minutely_15");
+  add(q, p->past_hours, "past_hours");
+  add(q, p->past_minutely_15, "pas_minutely_15");
+  add(q, p->start_date, "start_date", "%F");
+  add(q, p->end_date, "end_date", "%F");
+  add(q, p->start_hour, "start_hour", "%FT%H:%M");
+  add(q, p->end_hour, "end_hour", "%FT%H:%M");
+  add(q, p->start_minutely_15, "start_minutely_15", "%FT%H:%M");
+  add(q, p->end_minutely_15, "end_minutely_15", "%FT%H:%M");
   if (p->models) {
     openmeteo_sdk::Model *models = p->models;
-    ss << "&model=";
+    q->append("&model=");
     if (*models != openmeteo_sdk::Model_undefined) {
-      ss << EnumNameModel(*models);
+      q->append(EnumNameModel(*models));
       models++;
     }
     while (*models != openmeteo_sdk::Model_undefined) {
-      ss << "," << EnumNameModel(*models);
+      q->append(",").append(EnumNameModel(*models));
       models++;
     }
   }
   if (p->cell_selection != undefined_selection)
-    ss << "&cell_selection=" << EnumNamesCellSelection()[p->cell_selection];
-  return ss.str();
+    q->append("&cell_selection=")
+        .append(EnumNamesCellSelection()[p->cell_selection]);
+  return !q->overflow();
 }
 
-int https_with_hostname_params(const char *path, const OpenMeteoParams *params,
-                               openmeteo_sdk::WeatherApiResponse **output);
-
-int get_weather(OpenMeteoParams *params,
-                openmeteo_sdk::WeatherApiResponse **output) {
-  if (!params)
-    return -1;
-  validateParams(params);
-  return https_with_hostname_params(FORECAST, params, output);
+int get_weather(OpenMeteoParams *params, WeatherResponse *output) {
+  Client client;
+  return client.get_weather(params, output);
 }
 
-int https_with_hostname_params(const char *path, const OpenMeteoParams *params,
-                               openmeteo_sdk::WeatherApiResponse **output) {
-  esp_http_client_config_t config = {};
-  memset(&config, 0, sizeof(config));
-  char *output_buffer = NULL;
-  const std::string url = std::string(WEB_URL) + path + paramsToString(params);
-  ESP_LOGI(TAG, "%s", url.c_str());
-  config.url = url.c_str();
-  config.crt_bundle_attach = esp_crt_bundle_attach;
-  config.transport_type = HTTP_TRANSPORT_OVER_SSL;
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  esp_http_client_set_method(client, HTTP_METHOD_GET);
-  int data_len = 0;
-  char *data = NULL;
-  esp_err_t err = esp_http_client_open(client, data_len);
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-  } else if (data != NULL &&
-             esp_http_client_write(client, data, data_len) < 0) {
-    ESP_LOGE(TAG, "Write failed");
-  } else if (esp_http_client_fetch_headers(client) < 0) {
-    ESP_LOGE(TAG, "HTTP client fetch headers failed");
-  } else {
-    output_buffer = (char *)calloc(MAX_HTTP_OUTPUT_BUFFER_CALLOC, 1);
-    int total_read = 0;
-    int read = 0;
-    do {
-      read = esp_http_client_read_response(client, output_buffer + total_read,
-                                           MAX_HTTP_OUTPUT_BUFFER_CALLOC -
-                                               total_read);
-      total_read += read;
-    } while (read > 0);
-    if (output) {
-      *output = (openmeteo_sdk::WeatherApiResponse *)
-          openmeteo_sdk::GetSizePrefixedWeatherApiResponse(output_buffer);
-    }
-    free(output_buffer);
-  }
+int get_weather(OpenMeteoParams *params, ForecastCache *cache,
+                SharedResponse *output) {
+  Client client;
+  client.set_cache(cache);
+  return client.get_weather(params, output);
+}
 
-  esp_http_client_close(client);
-  const int status_code = esp_http_client_get_status_code(client);
-  esp_http_client_cleanup(client);
-  return status_code;
+int get_weather_batch(OpenMeteoParams *params, const Location *locations,
+                      size_t count, WeatherBatch *output) {
+  Client client;
+  return client.get_weather_batch(params, locations, count, output);
 }
-} // namespace OM_SDK
\ No newline at end of file
+} // namespace OM_SDK
@@ -0,0 +1,160 @@
+#include "om_accessor.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <weather_api_generated.h>
+
+using namespace OM_SDK;
+using namespace openmeteo_sdk;
+
+namespace {
+
+const int64_t start = 1710979200; // 2024-03-21
+
+// Current, six hours of an ensemble with members 0 to 2, and two days.
+std::vector<uint8_t> response() {
+  flatbuffers::FlatBufferBuilder builder;
+  const auto current = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_none, 0, {}, {}, 12.5f},
+       {Variable_is_day, 0, Aggregation_none, 0, {}, {}, 1.f}},
+      start + 900, 0, 0);
+  const auto hourly = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_none, 2, {21, 22, 23, 24, 25, 26}},
+       {Variable_temperature, 2, Aggregation_none, 0, {1, 2, 3, 4, 5, 6}},
+       {Variable_precipitation, 0, Aggregation_none, 0, {0, 0, .5f, 1, 0, 0}},
+       {Variable_temperature, 2, Aggregation_none, 1, {11, 12, 13, 14, 15, 16}},
+       // Not a TimeParam: skipped.
+       {Variable_temperature, 500, Aggregation_none, 0, {9, 9, 9, 9, 9, 9}}},
+      start, start + 6 * 3600, 3600);
+  const auto daily = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_maximum, 0, {14, 16}},
+       {Variable_temperature, 2, Aggregation_minimum, 0, {2, 3}},
+       {Variable_sunrise,
+        0,
+        Aggregation_none,
+        0,
+        {},
+        {start + 6 * 3600 + 1, start + 86400 + 6 * 3600 - 1}}},
+      start, start + 2 * 86400, 86400);
+  WeatherApiResponseBuilder result(builder);
+  result.add_current(current);
+  result.add_hourly(hourly);
+  result.add_daily(daily);
+  FinishSizePrefixedWeatherApiResponseBuffer(builder, result.Finish());
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+template <typename T> std::vector<T> to_vector(Span<T> span) {
+  return std::vector<T>(span.begin(), span.end());
+}
+
+std::vector<int64_t> to_vector(const TimeAxis &axis) {
+  std::vector<int64_t> times;
+  for (int64_t time : axis)
+    times.push_back(time);
+  return times;
+}
+
+} // namespace
+
+TEST(Accessor, FindsEveryParamOfEverySection) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const ResponseIndex index(api);
+  EXPECT_EQ(index.hourly().find(temperature_2m)->ensemble_member(), 0);
+  EXPECT_NE(index.hourly().find(precipitation), nullptr);
+  EXPECT_EQ(index.hourly().find(rain), nullptr);
+  EXPECT_EQ(index.hourly().find(max_params), nullptr);
+  EXPECT_EQ(index.daily().find(temperature_2m_max)->aggregation(),
+            Aggregation_maximum);
+  EXPECT_EQ(index.daily().find(temperature_2m_min)->aggregation(),
+            Aggregation_minimum);
+  EXPECT_EQ(index.daily().find(temperature_2m), nullptr);
+  EXPECT_EQ(index.minutely_15().find(precipitation), nullptr);
+  EXPECT_EQ(index.minutely_15().section(), nullptr);
+  EXPECT_FLOAT_EQ(index.current().value(temperature_2m), 12.5f);
+  EXPECT_FLOAT_EQ(index.current().value(is_day), 1.f);
+  EXPECT_FLOAT_EQ(index.current().value(rain, -1.f), -1.f);
+}
+
+TEST(Accessor, SpansPointIntoTheResponse) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const SectionIndex hourly(api->hourly());
+  const Span<float> precipitation_values = hourly.values(precipitation);
+  EXPECT_EQ(to_vector(precipitation_values),
+            (std::vector<float>{0, 0, .5f, 1, 0, 0}));
+  EXPECT_GE((const uint8_t *)precipitation_values.data(), body.data());
+  EXPECT_LT((const uint8_t *)precipitation_values.data(),
+            body.data() + body.size());
+  EXPECT_TRUE(hourly.values(rain).empty());
+  EXPECT_TRUE(hourly.values_int64(precipitation).empty());
+
+  const SectionIndex daily(api->daily());
+  EXPECT_EQ(to_vector(daily.values_int64(sunrise)),
+            (std::vector<int64_t>{start + 6 * 3600 + 1,
+                                  start + 86400 + 6 * 3600 - 1}));
+  EXPECT_TRUE(daily.values(sunrise).empty());
+  EXPECT_EQ(to_vector(daily.values(temperature_2m_max)),
+            (std::vector<float>{14, 16}));
+}
+
+TEST(Accessor, FindsEnsembleMembers) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const SectionIndex hourly(api->hourly());
+  EXPECT_EQ(to_vector(hourly.values(temperature_2m)),
+            (std::vector<float>{1, 2, 3, 4, 5, 6}));
+  EXPECT_EQ(to_vector(hourly.values(temperature_2m, 1)),
+            (std::vector<float>{11, 12, 13, 14, 15, 16}));
+  EXPECT_EQ(to_vector(hourly.values(temperature_2m, 2)),
+            (std::vector<float>{21, 22, 23, 24, 25, 26}));
+  EXPECT_EQ(hourly.find(temperature_2m, 3), nullptr);
+  EXPECT_EQ(hourly.find(precipitation, 1), nullptr);
+  EXPECT_EQ(hourly.find(max_params, 1), nullptr);
+}
+
+TEST(Accessor, TimeAxesIterateEveryTimestamp) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const ResponseIndex index(api);
+  const TimeAxis hourly = index.hourly().time();
+  ASSERT_EQ(hourly.size(), 6u);
+  EXPECT_EQ(hourly[5], start + 5 * 3600);
+  EXPECT_EQ(to_vector(hourly),
+            (std::vector<int64_t>{start, start + 3600, start + 7200,
+                                  start + 10800, start + 14400,
+                                  start + 18000}));
+  EXPECT_EQ(to_vector(index.daily().time()),
+            (std::vector<int64_t>{start, start + 86400}));
+  // No interval: the single timestamp of current.
+  const TimeAxis current = index.current().time();
+  EXPECT_EQ(current.size(), 1u);
+  EXPECT_EQ(current.interval(), 0);
+  EXPECT_EQ(to_vector(current), std::vector<int64_t>{start + 900});
+  EXPECT_EQ(to_vector(index.minutely_15().time()), std::vector<int64_t>{});
+  EXPECT_EQ(to_vector(TimeAxis(start, 0, 1)), std::vector<int64_t>{start});
+}
+
+TEST(Accessor, ViewsCutSpansAndAxes) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const ResponseIndex index(api);
+  const SectionView hourly(&index.hourly(), {precipitation}, 2, 3);
+  EXPECT_EQ(to_vector(hourly.values(precipitation)),
+            (std::vector<float>{.5f, 1, 0}));
+  EXPECT_TRUE(hourly.values(temperature_2m).empty());
+  EXPECT_EQ(to_vector(hourly.time()),
+            (std::vector<int64_t>{start + 7200, start + 10800,
+                                  start + 14400}));
+  const SectionView past_end(&index.hourly(), {precipitation}, 5, 10);
+  EXPECT_EQ(past_end.values(precipitation).size(), 1u);
+  EXPECT_EQ(past_end.time().size(), 1u);
+  const SectionView current(&index.current(), {temperature_2m}, 4, 2);
+  EXPECT_FLOAT_EQ(current.value(temperature_2m), 12.5f);
+  EXPECT_EQ(to_vector(current.time()), std::vector<int64_t>{start + 900});
+}
@@ -0,0 +1,170 @@
+#include "om_aggregate.hpp"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Weather-like values with NaNs, signed zeros, denormals and infinities
+// mixed in, from a fixed seed.
+std::vector<float> values(size_t count, uint32_t seed) {
+  std::vector<float> output(count);
+  uint32_t random = seed;
+  float level = 10.f;
+  for (float &value : output) {
+    random = random * 1664525 + 1013904223;
+    level += (float(random >> 16) / 65536.f - 0.5f) * 3.f;
+    switch (random % 61) {
+    case 0:
+      value = NAN;
+      break;
+    case 1:
+      value = -0.f;
+      break;
+    case 2:
+      value = 0.f;
+      break;
+    case 3:
+      value = std::numeric_limits<float>::denorm_min() * (random >> 20);
+      break;
+    default:
+      value = level;
+    }
+  }
+  return output;
+}
+
+bool same_bits(float a, float b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+void expect_identical(const Summary &simd, const Summary &scalar,
+                      size_t offset, size_t count) {
+  EXPECT_EQ(simd.count, scalar.count) << offset << " " << count;
+  EXPECT_TRUE(same_bits(simd.sum, scalar.sum))
+      << offset << " " << count << ": " << simd.sum << " " << scalar.sum;
+  EXPECT_TRUE(same_bits(simd.min, scalar.min)) << offset << " " << count;
+  EXPECT_TRUE(same_bits(simd.max, scalar.max)) << offset << " " << count;
+}
+
+} // namespace
+
+// Every length around the vector widths, from every alignment.
+TEST(Aggregate, SummarizeMatchesScalarBitForBit) {
+  const std::vector<float> data = values(4096, 7);
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t count = 0; count <= 100; ++count)
+      expect_identical(Summarize(data.data() + offset, count),
+                       SummarizeScalar(data.data() + offset, count), offset,
+                       count);
+  }
+  for (uint32_t seed = 1; seed <= 20; ++seed) {
+    const std::vector<float> series = values(3000 + seed, seed);
+    expect_identical(Summarize(series.data(), series.size()),
+                     SummarizeScalar(series.data(), series.size()), 0,
+                     series.size());
+  }
+}
+
+TEST(Aggregate, SummarizeHandlesSpecialValues) {
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> data(37, NAN);
+  data[3] = inf;
+  data[20] = -inf;
+  data[36] = 1.f;
+  const Summary all = Summarize(data.data(), data.size());
+  expect_identical(all, SummarizeScalar(data.data(), data.size()), 0,
+                   data.size());
+  EXPECT_EQ(all.count, 3u);
+  EXPECT_EQ(all.min, -inf);
+  EXPECT_EQ(all.max, inf);
+  // Only NaN: nothing counted.
+  const Summary none = Summarize(data.data() + 4, 16);
+  EXPECT_EQ(none.count, 0u);
+  EXPECT_EQ(none.mean(), 0.f);
+}
+
+TEST(Aggregate, CountsMatchScalar) {
+  const std::vector<float> data = values(1000, 11);
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t count = 0; count <= 64; ++count) {
+      for (const float threshold : {0.f, -0.f, 10.f, 25.f}) {
+        EXPECT_EQ(CountAbove(data.data() + offset, count, threshold),
+                  CountAboveScalar(data.data() + offset, count, threshold));
+        EXPECT_EQ(CountBelow(data.data() + offset, count, threshold),
+                  CountBelowScalar(data.data() + offset, count, threshold));
+      }
+    }
+  }
+  // NaN is neither above nor below.
+  const float nan[9] = {NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN};
+  EXPECT_EQ(CountAbove(nan, 9, 0.f), 0u);
+  EXPECT_EQ(CountBelow(nan, 9, 0.f), 0u);
+}
+
+TEST(Aggregate, WindowsMatchSummarize) {
+  const std::vector<float> data = values(24 * 16 + 5, 3);
+  std::vector<Summary> daily(20);
+  const size_t days =
+      SummarizeWindows(data.data(), data.size(), 24, daily.data(), 20);
+  ASSERT_EQ(days, 17u);
+  for (size_t day = 0; day < days; ++day) {
+    const size_t size = std::min<size_t>(24, data.size() - day * 24);
+    expect_identical(daily[day],
+                     SummarizeScalar(data.data() + day * 24, size), day,
+                     size);
+  }
+  EXPECT_EQ(SummarizeWindows(data.data(), data.size(), 24, daily.data(), 3),
+            3u);
+  EXPECT_EQ(SummarizeWindows(data.data(), data.size(), 0, daily.data(), 20),
+            0u);
+}
+
+// Sums in one pass match summing each window on its own in double, far
+// along a long series.
+TEST(Aggregate, RollingSumMatchesEachWindow) {
+  std::vector<float> data = values(24 * 365 * 2, 5);
+  for (float &value : data) {
+    // Hundredths, as precipitation comes.
+    if (value == value)
+      value = std::round(std::fabs(value) * 100.f) / 100.f;
+  }
+  for (const size_t window : {size_t(1), size_t(3), size_t(24), size_t(168)}) {
+    std::vector<float> sums(data.size());
+    const size_t written =
+        RollingSum(data.data(), data.size(), window, sums.data(), sums.size());
+    ASSERT_EQ(written, data.size() - window + 1);
+    for (size_t i = 0; i < written; ++i) {
+      double expected = 0.;
+      for (size_t j = i; j < i + window; ++j)
+        expected += data[j] == data[j] ? data[j] : 0.f;
+      ASSERT_TRUE(same_bits(sums[i], float(expected)))
+          << window << " " << i << ": " << sums[i] << " " << expected;
+    }
+  }
+}
+
+TEST(Aggregate, RollingSumBounds) {
+  const float data[5] = {1.f, NAN, 2.f, 3.f, 4.f};
+  float sums[5] = {-1.f, -1.f, -1.f, -1.f, -1.f};
+  EXPECT_EQ(RollingSum(data, 5, 2, sums, 5), 4u);
+  EXPECT_EQ(sums[0], 1.f);
+  EXPECT_EQ(sums[1], 2.f);
+  EXPECT_EQ(sums[2], 5.f);
+  EXPECT_EQ(sums[3], 7.f);
+  EXPECT_EQ(sums[4], -1.f);
+  EXPECT_EQ(RollingSum(data, 5, 2, sums, 2), 2u);
+  EXPECT_EQ(RollingSum(data, 5, 6, sums, 5), 0u);
+  EXPECT_EQ(RollingSum(data, 5, 0, sums, 5), 0u);
+  sums[0] = -1.f;
+  EXPECT_EQ(RollingSum(data, 5, 2, sums, 0), 0u);
+  EXPECT_EQ(sums[0], -1.f);
+}
+
+TEST(Aggregate, CountsCrossings) {
+  const float data[] = {1.f, NAN, 3.f, -1.f, NAN, -2.f, 0.f, 5.f, -5.f};
+  EXPECT_EQ(Crossings(data, 9, 0.f), 3u);
+  EXPECT_EQ(Crossings(data, 0, 0.f), 0u);
+}
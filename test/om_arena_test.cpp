@@ -0,0 +1,201 @@
+#include "om_arena.hpp"
+#include "om_client.hpp"
+#include "om_response.hpp"
+#include "om_transport.hpp"
+#include "synthetic_response.hpp"
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Fills `response` with `size` bytes of `fill`, growing it in `step` sized
+// reads as the client does.
+bool receive(WeatherResponse *response, size_t size, uint8_t fill,
+             size_t step) {
+  response->clear();
+  while (response->size() < size) {
+    const size_t chunk = std::min(step, size - response->size());
+    if (!response->reserve(response->size() + chunk))
+      return false;
+    memset(response->tail(), fill, chunk);
+    response->commit(chunk);
+  }
+  return true;
+}
+
+bool intact(const WeatherResponse &response, size_t size, uint8_t fill) {
+  if (response.size() != size)
+    return false;
+  for (size_t i = 0; i < size; ++i) {
+    if (response.data()[i] != fill)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(ResponseArena, ReusesTheHoleOfAReleasedResponse) {
+  ResponseArena arena(16 * 1024);
+  WeatherResponse a(&arena), b(&arena), c(&arena);
+  ASSERT_TRUE(receive(&a, 1000, 1, 1000));
+  ASSERT_TRUE(receive(&b, 1000, 2, 1000));
+  ASSERT_TRUE(receive(&c, 1000, 3, 1000));
+  const uint8_t *hole = b.data();
+  const size_t used = arena.used();
+  b.reset();
+  EXPECT_LT(arena.used(), used);
+  WeatherResponse d(&arena);
+  ASSERT_TRUE(receive(&d, 900, 4, 900));
+  EXPECT_EQ(d.data(), hole);
+  EXPECT_TRUE(intact(a, 1000, 1));
+  EXPECT_TRUE(intact(c, 1000, 3));
+  EXPECT_EQ(arena.live(), 3u);
+}
+
+TEST(ResponseArena, MergesNeighbouringHoles) {
+  ResponseArena arena(16 * 1024);
+  WeatherResponse a(&arena), b(&arena), c(&arena), d(&arena);
+  ASSERT_TRUE(receive(&a, 1000, 1, 1000));
+  ASSERT_TRUE(receive(&b, 1000, 2, 1000));
+  ASSERT_TRUE(receive(&c, 1000, 3, 1000));
+  ASSERT_TRUE(receive(&d, 1000, 4, 1000));
+  const uint8_t *start = b.data();
+  c.reset();
+  b.reset();
+  WeatherResponse e(&arena);
+  ASSERT_TRUE(receive(&e, 2000, 5, 2000));
+  EXPECT_EQ(e.data(), start);
+  EXPECT_TRUE(intact(a, 1000, 1));
+  EXPECT_TRUE(intact(d, 1000, 4));
+}
+
+TEST(ResponseArena, GrowsTheNewestInPlaceAndMovesOlderOnes) {
+  ResponseArena arena(16 * 1024);
+  WeatherResponse a(&arena), b(&arena);
+  ASSERT_TRUE(receive(&a, 1000, 1, 100));
+  const uint8_t *first = a.data();
+  ASSERT_TRUE(receive(&a, 3000, 1, 100));
+  EXPECT_EQ(a.data(), first);
+  ASSERT_TRUE(receive(&b, 1000, 2, 1000));
+  // a is not the newest any more and has no hole after it.
+  ASSERT_TRUE(a.reserve(5000));
+  EXPECT_NE(a.data(), first);
+  EXPECT_TRUE(intact(a, 3000, 1));
+  EXPECT_TRUE(intact(b, 1000, 2));
+  // Its old space is free again.
+  WeatherResponse c(&arena);
+  ASSERT_TRUE(receive(&c, 3000, 3, 3000));
+  EXPECT_EQ(c.data(), first);
+}
+
+TEST(ResponseArena, FailsWhenFullAndKeepsTheBlock) {
+  ResponseArena arena(4096);
+  WeatherResponse a(&arena), b(&arena);
+  ASSERT_TRUE(receive(&a, 2000, 1, 2000));
+  ASSERT_TRUE(receive(&b, 1000, 2, 1000));
+  EXPECT_FALSE(b.reserve(4096));
+  EXPECT_TRUE(intact(b, 1000, 2));
+  EXPECT_FALSE(arena.largest_free() >= 2000);
+  a.reset();
+  EXPECT_GE(arena.largest_free(), 2000u);
+}
+
+TEST(ResponseArena, EmptiesCompletely) {
+  char buffer[8192 + 3];
+  // Unaligned on purpose.
+  ResponseArena arena(buffer + 3, 8192);
+  const size_t largest = arena.largest_free();
+  EXPECT_GE(largest, 8000u);
+  {
+    WeatherResponse a(&arena), b(&arena), c(&arena);
+    ASSERT_TRUE(receive(&a, 500, 1, 100));
+    ASSERT_TRUE(receive(&b, 1500, 2, 100));
+    ASSERT_TRUE(receive(&c, 700, 3, 100));
+    EXPECT_EQ((uintptr_t)b.data() % 8, 0u);
+    a.reset();
+    c.reset();
+  }
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.live(), 0u);
+  EXPECT_EQ(arena.largest_free(), largest);
+}
+
+// 100k requests of 1 to 6 KB, like a cache keeping the last few responses
+// for a while: the arena never runs out although older responses outlive
+// newer ones, the free space does not fragment further as the run goes on,
+// and the arena ends empty.
+TEST(ResponseArena, Soak100kRequests) {
+  ResponseArena arena(64 * 1024);
+  std::minstd_rand random(42);
+  struct Kept {
+    WeatherResponse response;
+    size_t size;
+    uint8_t fill;
+  };
+  std::deque<Kept> kept;
+  size_t peak_live = 0;
+  // Sum of largest_free() over each tenth of the run.
+  std::vector<size_t> largest_free(10, 0);
+  for (size_t request = 0; request < 100000; ++request) {
+    const size_t size = 1024 + random() % (5 * 1024);
+    const uint8_t fill = request & 0xff;
+    WeatherResponse response(&arena);
+    ASSERT_TRUE(receive(&response, size, fill, 512 + random() % 2048))
+        << "request " << request << ", " << arena.live() << " live, "
+        << arena.used() << " bytes used";
+    // Half of them are kept, up to 6 at a time, dropped in random order.
+    if (random() % 2) {
+      kept.push_back({std::move(response), size, fill});
+      if (kept.size() > 6) {
+        const size_t drop = random() % kept.size();
+        ASSERT_TRUE(intact(kept[drop].response, kept[drop].size,
+                           kept[drop].fill))
+            << "request " << request;
+        kept.erase(kept.begin() + drop);
+      }
+    }
+    peak_live = std::max(peak_live, arena.live());
+    largest_free[request / 10000] += arena.largest_free();
+  }
+  EXPECT_LE(peak_live, 8u);
+  // On average the largest free block stays within 5% of where it started.
+  for (size_t tenth = 1; tenth < largest_free.size(); ++tenth)
+    EXPECT_GE(largest_free[tenth], largest_free[0] / 20 * 19) << tenth;
+  for (const Kept &k : kept)
+    EXPECT_TRUE(intact(k.response, k.size, k.fill));
+  kept.clear();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.live(), 0u);
+  EXPECT_GE(arena.largest_free(), 64 * 1024 - 64u);
+}
+
+// The same through a client, responses kept by the caller while it fetches.
+TEST(ResponseArena, ClientKeepsFetchingWhileResponsesAreHeld) {
+  ResponseArena arena(32 * 1024);
+  ReplayTransport transport;
+  ReplayTransport::Response reply;
+  reply.status_code = 200;
+  reply.body = synthetic_response(4096);
+  transport.push(reply);
+  transport.set_repeat(true);
+  Client client(&transport);
+  client.set_arena(&arena);
+  OpenMeteoParams params = {};
+  std::deque<WeatherResponse> kept;
+  for (size_t request = 0; request < 2000; ++request) {
+    WeatherResponse response;
+    ASSERT_EQ(client.get_weather(&params, &response), 200) << request;
+    ASSERT_EQ(response.arena(), &arena);
+    kept.push_back(std::move(response));
+    // The oldest is dropped first, never the newest.
+    if (kept.size() > 4)
+      kept.pop_front();
+  }
+  kept.clear();
+  EXPECT_EQ(arena.used(), 0u);
+}
@@ -0,0 +1,193 @@
+#include "om_async.hpp"
+#include "om_client.hpp"
+#include "om_transport.hpp"
+#include "synthetic_response.hpp"
+#include <condition_variable>
+#include <future>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Replays responses, holding each request until the test lets it through.
+class GatedTransport : public ReplayTransport {
+public:
+  esp_err_t open() override {
+    std::unique_lock<std::mutex> lock(_mutex);
+    ++_waiting;
+    _cv.notify_all();
+    _cv.wait(lock, [this] { return _passes > 0; });
+    --_passes;
+    --_waiting;
+    lock.unlock();
+    return ReplayTransport::open();
+  }
+
+  void pass(size_t count = 1) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _passes += count;
+    _cv.notify_all();
+  }
+
+  // Until a request waits in open().
+  void wait_for_request() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _waiting > 0; });
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  size_t _passes{0};
+  size_t _waiting{0};
+};
+
+ReplayTransport::Response ok() {
+  ReplayTransport::Response response;
+  response.status_code = 200;
+  response.body = synthetic_response(512);
+  return response;
+}
+
+// Callback results in the order they ran, by the tag of each request.
+struct Results {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::pair<int, int>> calls;
+
+  WeatherCallback callback(int tag) {
+    return [this, tag](int status_code, SharedResponse response) {
+      std::lock_guard<std::mutex> lock(mutex);
+      EXPECT_EQ(status_code == 200, response && *response);
+      calls.emplace_back(tag, status_code);
+      cv.notify_all();
+    };
+  }
+
+  void wait_for(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10),
+                            [&] { return calls.size() >= count; }));
+  }
+};
+
+OpenMeteoParams forecast_params() {
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  return params;
+}
+
+} // namespace
+
+TEST(AsyncClient, RunsRequestsInSubmissionOrder) {
+  GatedTransport transport;
+  transport.push(ok());
+  transport.set_repeat(true);
+  transport.pass(3);
+  Client client(&transport);
+  Results results;
+  {
+    AsyncClient async(&client);
+    for (int tag = 0; tag < 3; ++tag)
+      async.submit(forecast_params(), results.callback(tag));
+    results.wait_for(3);
+    EXPECT_EQ(async.pending(), 0u);
+  }
+  ASSERT_EQ(results.calls.size(), 3u);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(results.calls[i], std::make_pair(i, 200));
+  EXPECT_EQ(transport.urls().size(), 3u);
+}
+
+TEST(AsyncClient, CancelsQueuedAndDropsInFlightResults) {
+  GatedTransport transport;
+  transport.push(ok());
+  transport.set_repeat(true);
+  Client client(&transport);
+  Results results;
+  AsyncClient async(&client);
+  const RequestId first = async.submit(forecast_params(), results.callback(1));
+  const RequestId second =
+      async.submit(forecast_params(), results.callback(2));
+  async.submit(forecast_params(), results.callback(3));
+  transport.wait_for_request();
+  EXPECT_EQ(async.pending(), 3u);
+  // Queued: its callback runs right away, on this thread.
+  EXPECT_TRUE(async.cancel(second));
+  results.wait_for(1);
+  EXPECT_EQ(results.calls[0], std::make_pair(2, (int)status_cancelled));
+  // In flight: it completes but reports cancelled.
+  EXPECT_TRUE(async.cancel(first));
+  EXPECT_FALSE(async.cancel(12345));
+  transport.pass(2);
+  results.wait_for(3);
+  EXPECT_EQ(results.calls[1], std::make_pair(1, (int)status_cancelled));
+  EXPECT_EQ(results.calls[2], std::make_pair(3, 200));
+  EXPECT_EQ(transport.urls().size(), 2u);
+}
+
+TEST(AsyncClient, TimesOutRequestsThatWaitedTooLong) {
+  GatedTransport transport;
+  transport.push(ok());
+  transport.set_repeat(true);
+  Client client(&transport);
+  Results results;
+  AsyncClient async(&client);
+  async.submit(forecast_params(), results.callback(1));
+  async.submit(forecast_params(), results.callback(2), 20);
+  transport.wait_for_request();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  transport.pass(2);
+  results.wait_for(2);
+  EXPECT_EQ(results.calls[0], std::make_pair(1, 200));
+  EXPECT_EQ(results.calls[1], std::make_pair(2, (int)status_timeout));
+  // The timed out one never reached the transport.
+  EXPECT_EQ(transport.urls().size(), 1u);
+}
+
+TEST(AsyncClient, TimesOutRequestsThatFinishLate) {
+  GatedTransport transport;
+  transport.push(ok());
+  transport.set_repeat(true);
+  Client client(&transport);
+  Results results;
+  AsyncClient async(&client);
+  async.submit(forecast_params(), results.callback(1), 20);
+  async.submit(forecast_params(), results.callback(2), 10000);
+  transport.wait_for_request();
+  // The first one is on the network past its deadline.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  transport.pass(2);
+  results.wait_for(2);
+  EXPECT_EQ(results.calls[0], std::make_pair(1, (int)status_timeout));
+  EXPECT_EQ(results.calls[1], std::make_pair(2, 200));
+  EXPECT_EQ(transport.urls().size(), 2u);
+}
+
+TEST(AsyncClient, DestructionCancelsPendingRequests) {
+  GatedTransport transport;
+  transport.push(ok());
+  transport.set_repeat(true);
+  Client client(&transport);
+  Results results;
+  std::future<void> released;
+  {
+    AsyncClient async(&client);
+    for (int tag = 0; tag < 3; ++tag)
+      async.submit(forecast_params(), results.callback(tag));
+    transport.wait_for_request();
+    // Lets the request in flight finish while the destructor waits for it.
+    released = std::async(std::launch::async, [&transport] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      transport.pass();
+    });
+  }
+  released.wait();
+  ASSERT_EQ(results.calls.size(), 3u);
+  for (const auto &call : results.calls)
+    EXPECT_EQ(call.second, (int)status_cancelled);
+  EXPECT_EQ(transport.urls().size(), 1u);
+}
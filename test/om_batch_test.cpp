@@ -0,0 +1,184 @@
+#include "om_client.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// A canned multi-location response: one message per place, each built on
+// its own as the expected entry.
+struct BatchFixture {
+  struct Place {
+    Location location;
+    size_t bytes;
+    uint32_t seed;
+  };
+
+  explicit BatchFixture(std::vector<Place> places)
+      : places(std::move(places)) {
+    for (const Place &place : this->places) {
+      messages.push_back(synthetic_response(place.bytes, place.seed,
+                                            place.location.latitude,
+                                            place.location.longitude));
+      locations.push_back(place.location);
+    }
+  }
+
+  // The messages of places [first, first + count), back to back.
+  std::vector<uint8_t> body(size_t first, size_t count) const {
+    std::vector<uint8_t> output;
+    for (size_t i = first; i < first + count; ++i)
+      output.insert(output.end(), messages[i].begin(), messages[i].end());
+    return output;
+  }
+
+  // Compares entry `index` of `batch` with the message of place `index`.
+  void expect_entry(const WeatherBatch &batch, size_t index) const {
+    const openmeteo_sdk::WeatherApiResponse *entry = batch[index];
+    const openmeteo_sdk::WeatherApiResponse *expected =
+        openmeteo_sdk::GetSizePrefixedWeatherApiResponse(
+            messages[index].data());
+    ASSERT_NE(entry, nullptr) << index;
+    EXPECT_FLOAT_EQ(entry->latitude(), places[index].location.latitude)
+        << index;
+    EXPECT_FLOAT_EQ(entry->longitude(), places[index].location.longitude)
+        << index;
+    ASSERT_TRUE(entry->hourly() && entry->hourly()->variables()) << index;
+    EXPECT_EQ(entry->hourly()->time(), expected->hourly()->time()) << index;
+    EXPECT_EQ(entry->hourly()->interval(), expected->hourly()->interval());
+    const auto *variables = entry->hourly()->variables();
+    const auto *expected_variables = expected->hourly()->variables();
+    ASSERT_EQ(variables->size(), expected_variables->size()) << index;
+    for (size_t v = 0; v < variables->size(); ++v) {
+      const auto *values = variables->Get(v)->values();
+      const auto *expected_values = expected_variables->Get(v)->values();
+      EXPECT_EQ(variables->Get(v)->variable(),
+                expected_variables->Get(v)->variable());
+      ASSERT_EQ(values->size(), expected_values->size()) << index << " " << v;
+      // Bytes, NaNs included.
+      EXPECT_EQ(memcmp(values->data(), expected_values->data(),
+                       values->size() * sizeof(float)),
+                0)
+          << index << " " << v;
+    }
+  }
+
+  std::vector<Place> places;
+  std::vector<std::vector<uint8_t>> messages;
+  std::vector<Location> locations;
+};
+
+ReplayTransport::Response ok(std::vector<uint8_t> body) {
+  ReplayTransport::Response response;
+  response.status_code = 200;
+  response.body = std::move(body);
+  return response;
+}
+
+OpenMeteoParams batch_params() {
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m, precipitation};
+  return params;
+}
+
+// Answers each request with the fixture messages of the locations its URL
+// lists, in order.
+class FixtureTransport : public ReplayTransport {
+public:
+  explicit FixtureTransport(const BatchFixture &fixture) : _fixture(fixture) {}
+
+  esp_err_t prepare(const char *url) override {
+    const std::string query = url;
+    size_t count = 1;
+    for (size_t at = query.find("latitude="); query[at] != '&'; ++at)
+      count += query[at] == ',';
+    push(ok(_fixture.body(_done, count)));
+    _done += count;
+    return ReplayTransport::prepare(url);
+  }
+
+private:
+  const BatchFixture &_fixture;
+  size_t _done{0};
+};
+
+} // namespace
+
+TEST(WeatherBatch, ParsesEachLocation) {
+  const BatchFixture fixture({{{52.52f, 13.41f}, 2048, 1},
+                              {{48.85f, 2.35f}, 512, 2},
+                              {{-33.87f, 151.21f}, 8192, 3},
+                              {{40.71f, -74.01f}, 64, 4},
+                              {{64.15f, -21.94f}, 4096, 5}});
+  ReplayTransport transport;
+  transport.push(ok(fixture.body(0, 5)));
+  Client client(&transport);
+  OpenMeteoParams params = batch_params();
+  WeatherBatch batch;
+  ASSERT_EQ(client.get_weather_batch(&params, fixture.locations.data(), 5,
+                                     &batch),
+            200);
+  ASSERT_EQ(batch.size(), 5u);
+  EXPECT_EQ(batch.requests(), 1u);
+  for (size_t i = 0; i < batch.size(); ++i)
+    fixture.expect_entry(batch, i);
+  ASSERT_EQ(transport.urls().size(), 1u);
+  const std::string &url = transport.urls()[0];
+  EXPECT_NE(url.find("latitude=52.52,48.85,-33.87,40.71,64.15&"),
+            std::string::npos)
+      << url;
+  EXPECT_NE(url.find("longitude=13.41,2.35,151.21,-74.01,-21.94&"),
+            std::string::npos)
+      << url;
+
+  // An entry copied out is the message of that place alone.
+  WeatherResponse copy;
+  ASSERT_TRUE(batch.copy(2, &copy));
+  ASSERT_EQ(copy.size(), fixture.messages[2].size());
+  EXPECT_EQ(memcmp(copy.data(), fixture.messages[2].data(), copy.size()), 0);
+  EXPECT_FALSE(batch.copy(5, &copy));
+}
+
+// Locations the URL has no room for go out in further requests, the
+// entries still in request order.
+TEST(WeatherBatch, SplitsLongUrlsKeepingTheOrder) {
+  std::vector<BatchFixture::Place> places;
+  for (uint32_t i = 0; i < 120; ++i)
+    places.push_back({{-60.f + i * 0.987f, -170.f + i * 2.831f}, 64, i + 1});
+  const BatchFixture fixture(std::move(places));
+  FixtureTransport transport(fixture);
+  Client client(&transport);
+  OpenMeteoParams params = batch_params();
+  WeatherBatch batch;
+  ASSERT_EQ(client.get_weather_batch(&params, fixture.locations.data(),
+                                     fixture.locations.size(), &batch),
+            200);
+  ASSERT_EQ(batch.size(), fixture.locations.size());
+  EXPECT_GT(batch.requests(), 1u);
+  EXPECT_EQ(batch.requests(), transport.urls().size());
+  for (const std::string &url : transport.urls())
+    EXPECT_LE(url.size(), (size_t)CONFIG_OPEN_METEO_MAX_URL_LENGTH);
+  for (size_t i = 0; i < batch.size(); ++i)
+    fixture.expect_entry(batch, i);
+}
+
+TEST(WeatherBatch, FailsResponsesMissingLocations) {
+  const BatchFixture fixture(
+      {{{52.52f, 13.41f}, 256, 1}, {{48.85f, 2.35f}, 256, 2},
+       {{45.76f, 4.84f}, 256, 3}});
+  ReplayTransport transport;
+  transport.push(ok(fixture.body(0, 2)));
+  Client client(&transport);
+  OpenMeteoParams params = batch_params();
+  WeatherBatch batch;
+  EXPECT_EQ(client.get_weather_batch(&params, fixture.locations.data(), 3,
+                                     &batch),
+            -1);
+  EXPECT_EQ(batch.size(), 0u);
+}
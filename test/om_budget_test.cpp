@@ -0,0 +1,164 @@
+#include "om_budget.hpp"
+#include "om_client.hpp"
+#include "om_endpoint.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+
+using namespace OM_SDK;
+
+namespace {
+
+// A budget on simulated time: sleeping moves the clock.
+struct SimulatedBudget {
+  explicit SimulatedBudget(const BudgetLimits &limits, uint32_t seed = 1)
+      : budget(
+            limits, [this] { return now; },
+            [this](int64_t ms) {
+              slept += ms;
+              now += ms;
+            },
+            seed) {}
+
+  int64_t now{1000};
+  int64_t slept{0};
+  RequestBudget budget;
+};
+
+BudgetLimits day_only() {
+  BudgetLimits limits;
+  limits.per_minute = 1e6f;
+  limits.per_hour = 1e7f;
+  limits.per_day = 10000.f;
+  limits.max_wait_ms = 0;
+  return limits;
+}
+
+size_t drain(RequestBudget *budget) {
+  size_t admitted = 0;
+  while (budget->try_acquire(1.f))
+    ++admitted;
+  return admitted;
+}
+
+} // namespace
+
+TEST(RequestBudget, AdmitsAMinuteThenWaitsForTheRefill) {
+  SimulatedBudget sim{BudgetLimits()};
+  EXPECT_EQ(drain(&sim.budget), 600u);
+  int64_t wait = 0;
+  EXPECT_FALSE(sim.budget.try_acquire(1.f, &wait));
+  // 600 a minute is one every 100 ms.
+  EXPECT_GE(wait, 100);
+  EXPECT_LE(wait, 101);
+  sim.now += wait;
+  EXPECT_TRUE(sim.budget.try_acquire(1.f));
+  EXPECT_EQ(sim.budget.stats().admitted, 601u);
+}
+
+// Polled every millisecond, the per day bucket still refills: about 1.2e-4
+// calls a millisecond, below the float resolution of a half full bucket.
+TEST(RequestBudget, DayRefillsWhenPolledEveryMillisecond) {
+  SimulatedBudget sim{day_only()};
+  ASSERT_TRUE(sim.budget.try_acquire(5000.f));
+  for (int64_t ms = 0; ms < 3600000; ++ms) {
+    ++sim.now;
+    sim.budget.low();
+  }
+  // 5000 left and an hour of 10000 a day.
+  EXPECT_EQ(drain(&sim.budget), 5000u + 416u);
+}
+
+TEST(RequestBudget, AcquireSleepsForTheRefill) {
+  BudgetLimits limits;
+  limits.max_wait_ms = 250;
+  SimulatedBudget sim{limits};
+  ASSERT_TRUE(sim.budget.acquire(600.f));
+  EXPECT_TRUE(sim.budget.acquire(2.f));
+  EXPECT_GE(sim.slept, 200);
+  EXPECT_LE(sim.slept, 250);
+  EXPECT_EQ(sim.budget.stats().waited, 1u);
+  // 5 calls take 500 ms, over max_wait_ms: fails without sleeping.
+  const int64_t slept = sim.slept;
+  EXPECT_FALSE(sim.budget.acquire(5.f));
+  EXPECT_EQ(sim.slept, slept);
+  EXPECT_EQ(sim.budget.stats().rejected, 1u);
+}
+
+TEST(RequestBudget, QueriesLargerThanAWindowWaitForItToFill) {
+  BudgetLimits limits;
+  limits.per_minute = 10.f;
+  limits.max_wait_ms = 120000;
+  SimulatedBudget sim{limits};
+  ASSERT_TRUE(sim.budget.acquire(5.f));
+  EXPECT_TRUE(sim.budget.acquire(50.f));
+  EXPECT_GE(sim.slept, 30000);
+  EXPECT_LE(sim.slept, 30001);
+}
+
+TEST(RequestBudget, RetryAfterHoldsRequestsBack) {
+  SimulatedBudget sim{BudgetLimits()};
+  sim.budget.on_response(429, 30);
+  EXPECT_EQ(sim.budget.backoff_remaining(), 30000);
+  EXPECT_TRUE(sim.budget.low());
+  int64_t wait = 0;
+  EXPECT_FALSE(sim.budget.try_acquire(1.f, &wait));
+  EXPECT_GE(wait, 30000);
+  sim.now += 30000;
+  EXPECT_EQ(sim.budget.backoff_remaining(), 0);
+  // The minute restarted empty at the 429 and refilled in 30 s.
+  EXPECT_EQ(drain(&sim.budget), 300u);
+  EXPECT_EQ(sim.budget.stats().throttled, 1u);
+}
+
+TEST(RequestBudget, BackoffDoublesWithJitterAndResets) {
+  BudgetLimits limits;
+  limits.backoff_ms = 1000;
+  limits.max_backoff_ms = 8000;
+  SimulatedBudget sim{limits, 7};
+  int64_t ceiling = 1000;
+  for (int i = 0; i < 6; ++i) {
+    sim.budget.on_response(429);
+    const int64_t delay = sim.budget.backoff_remaining();
+    EXPECT_GE(delay, ceiling / 2) << i;
+    EXPECT_LE(delay, ceiling) << i;
+    sim.now += delay;
+    ceiling = std::min<int64_t>(ceiling * 2, 8000);
+  }
+  sim.budget.on_response(200);
+  sim.budget.on_response(429);
+  EXPECT_LE(sim.budget.backoff_remaining(), 1000);
+}
+
+TEST(RequestBudget, WeightsByLocationsVariablesAndDays) {
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  EXPECT_FLOAT_EQ(QueryWeight(forecast_endpoint, params), 1.f);
+  EXPECT_FLOAT_EQ(QueryWeight(forecast_endpoint, params, 3), 3.f);
+  params.forecast_days = 16;
+  params.past_days = 12;
+  EXPECT_FLOAT_EQ(QueryWeight(forecast_endpoint, params), 2.f);
+}
+
+TEST(RequestBudget, ClientFailsOverBudgetWithoutSending) {
+  BudgetLimits limits;
+  limits.per_minute = 2.f;
+  limits.max_wait_ms = 0;
+  SimulatedBudget sim{limits};
+  ReplayTransport transport;
+  ReplayTransport::Response reply;
+  reply.status_code = 200;
+  reply.body = synthetic_response(256);
+  transport.push(reply);
+  transport.set_repeat(true);
+  Client client(&transport);
+  client.set_budget(&sim.budget);
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  WeatherResponse response;
+  EXPECT_EQ(client.get_weather(&params, &response), 200);
+  EXPECT_EQ(client.get_weather(&params, &response), 200);
+  EXPECT_EQ(client.get_weather(&params, &response), status_over_budget);
+  EXPECT_EQ(transport.urls().size(), 2u);
+}
@@ -0,0 +1,139 @@
+#include "om_cache.hpp"
+#include "synthetic_response.hpp"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace OM_SDK;
+
+namespace {
+
+const time_t now = 1791792000; // 2026-10-12
+
+// A response of `model` in a buffer of exactly `capacity` bytes.
+SharedResponse
+response(size_t capacity,
+         openmeteo_sdk::Model model = openmeteo_sdk::Model_undefined) {
+  const std::vector<uint8_t> body =
+      synthetic_response(256, 12345, 52.52f, 13.41f, model);
+  auto output = std::make_shared<WeatherResponse>();
+  EXPECT_TRUE(output->reserve(std::max(capacity, body.size())));
+  memcpy(output->tail(), body.data(), body.size());
+  output->commit(body.size());
+  return output;
+}
+
+Validators etag(const char *value) {
+  Validators validators = {};
+  strncpy(validators.etag, value, sizeof(validators.etag) - 1);
+  return validators;
+}
+
+} // namespace
+
+TEST(ForecastCache, HitsShareTheBuffer) {
+  ForecastCache cache(1 << 20, 600);
+  const SharedResponse stored = response(4096);
+  cache.insert(1, stored, now);
+  EXPECT_EQ(cache.find(1, now), stored);
+  EXPECT_EQ(cache.find(2, now), nullptr);
+  const CacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_EQ(stats.bytes, 4096u);
+
+  // Replacing a key keeps one entry.
+  cache.insert(1, response(8192), now);
+  EXPECT_EQ(cache.stats().entries, 1u);
+  EXPECT_EQ(cache.stats().bytes, 8192u);
+  cache.erase(1);
+  EXPECT_EQ(cache.find(1, now), nullptr);
+  EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+TEST(ForecastCache, EvictsLeastRecentlyUsedWithinTheBudget) {
+  ForecastCache cache(3 * 4096, 600);
+  cache.insert(1, response(4096), now);
+  cache.insert(2, response(4096), now);
+  cache.insert(3, response(4096), now);
+  // 1 becomes the most recently used, 2 the least.
+  ASSERT_NE(cache.find(1, now), nullptr);
+  cache.insert(4, response(4096), now);
+  EXPECT_EQ(cache.find(2, now), nullptr);
+  EXPECT_NE(cache.find(1, now), nullptr);
+  EXPECT_NE(cache.find(3, now), nullptr);
+  EXPECT_NE(cache.find(4, now), nullptr);
+  EXPECT_EQ(cache.stats().evictions, 1u);
+
+  // A large entry pushes out as many as it needs, oldest first.
+  cache.insert(5, response(2 * 4096), now);
+  EXPECT_EQ(cache.find(1, now), nullptr);
+  EXPECT_EQ(cache.find(3, now), nullptr);
+  EXPECT_NE(cache.find(4, now), nullptr);
+  EXPECT_NE(cache.find(5, now), nullptr);
+  const CacheStats stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 3u);
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.bytes, 3u * 4096);
+
+  // Over the whole budget: not cached, nothing evicted.
+  cache.insert(6, response(4 * 4096), now);
+  EXPECT_EQ(cache.find(6, now), nullptr);
+  EXPECT_EQ(cache.stats().entries, 2u);
+
+  cache.clear();
+  EXPECT_EQ(cache.stats().entries, 0u);
+  EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+TEST(ForecastCache, ExpiresAfterTheTtl) {
+  ForecastCache cache(1 << 20, 600);
+  cache.insert(1, response(4096), now);
+  EXPECT_NE(cache.find(1, now + 599), nullptr);
+  EXPECT_EQ(cache.find(1, now + 600), nullptr);
+  // Without validators the entry is gone.
+  EXPECT_EQ(cache.stats().entries, 0u);
+  EXPECT_EQ(cache.stats().expirations, 1u);
+  EXPECT_EQ(response_expiry(WeatherResponse(), now, 600), now + 600);
+}
+
+TEST(ForecastCache, ExpiresWithTheModelUpdateInterval) {
+  ForecastCache cache(1 << 20, 600);
+  cache.insert(1, response(4096, openmeteo_sdk::Model_icon_d2), now);
+  cache.insert(2, response(4096, openmeteo_sdk::Model_gfs_seamless), now);
+  EXPECT_NE(cache.find(1, now + 3 * 3600 - 1), nullptr);
+  EXPECT_EQ(cache.find(1, now + 3 * 3600), nullptr);
+  EXPECT_NE(cache.find(2, now + 6 * 3600 - 1), nullptr);
+  EXPECT_EQ(cache.find(2, now + 6 * 3600), nullptr);
+  EXPECT_EQ(cache.stats().expirations, 2u);
+}
+
+TEST(ForecastCache, CountsAnExpiredEntryOnce) {
+  ForecastCache cache(1 << 20, 600);
+  const Validators validators = etag("\"v1\"");
+  const SharedResponse stored = response(4096);
+  cache.insert(1, stored, now, &validators);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(cache.find(1, now + 600 + i), nullptr);
+  CacheStats stats = cache.stats();
+  EXPECT_EQ(stats.expirations, 1u);
+  EXPECT_EQ(stats.misses, 5u);
+  // Kept for revalidation.
+  EXPECT_EQ(stats.entries, 1u);
+  Validators sent = {};
+  EXPECT_EQ(cache.find_stale(1, &sent), stored);
+  EXPECT_STREQ(sent.etag, "\"v1\"");
+
+  // Not modified: fresh again, and counted again once it expires anew.
+  ASSERT_TRUE(cache.refresh(1, now + 1000));
+  EXPECT_EQ(cache.find(1, now + 1599), stored);
+  EXPECT_EQ(cache.find(1, now + 1600), nullptr);
+  EXPECT_EQ(cache.find(1, now + 1700), nullptr);
+  stats = cache.stats();
+  EXPECT_EQ(stats.expirations, 2u);
+  EXPECT_FALSE(cache.refresh(2, now));
+  Validators none = {};
+  EXPECT_EQ(cache.find_stale(2, &none), nullptr);
+}
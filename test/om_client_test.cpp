@@ -0,0 +1,196 @@
+#include "om_client.hpp"
+#include "om_endpoint.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+
+using namespace OM_SDK;
+
+namespace {
+
+OpenMeteoParams forecast_params() {
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = 13.41f;
+  params.hourly_set = {temperature_2m};
+  return params;
+}
+
+ReplayTransport::Response ok(std::vector<uint8_t> body) {
+  ReplayTransport::Response response;
+  response.status_code = 200;
+  response.body = std::move(body);
+  return response;
+}
+
+// Hands out the body in reads of 1 to 2 * `mean` bytes, like TLS records
+// and TCP segments do, optionally without a Content-Length: chunked bodies
+// report 0.
+class ChoppyTransport : public ReplayTransport {
+public:
+  ChoppyTransport(uint32_t seed, size_t mean, bool content_length)
+      : _random(seed), _mean(mean), _content_length(content_length) {}
+
+  int64_t fetch_headers() override {
+    const int64_t length = ReplayTransport::fetch_headers();
+    return _content_length ? length : 0;
+  }
+
+  int read(uint8_t *buffer, size_t size) override {
+    _random = _random * 1664525 + 1013904223;
+    const size_t chunk = 1 + (_random >> 8) % (2 * _mean);
+    ++_reads;
+    return ReplayTransport::read(buffer, std::min(size, chunk));
+  }
+
+  size_t reads() const { return _reads; }
+
+private:
+  uint32_t _random;
+  const size_t _mean;
+  const bool _content_length;
+  size_t _reads{0};
+};
+
+} // namespace
+
+TEST(Client, ReadsLargeBodies) {
+  // Close to CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE.
+  const std::vector<uint8_t> body =
+      synthetic_response(CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE - 4096);
+  ASSERT_LE(body.size(), (size_t)CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE);
+  ReplayTransport transport;
+  transport.push(ok(body));
+  Client client(&transport);
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  ASSERT_TRUE(response);
+  ASSERT_EQ(response.size(), body.size());
+  EXPECT_EQ(memcmp(response.data(), body.data(), body.size()), 0);
+  EXPECT_EQ(response->hourly()->variables()->size(),
+            sizeof(synthetic_hourly) / sizeof(synthetic_hourly[0]));
+}
+
+TEST(Client, FailsBodiesOverTheLimit) {
+  ReplayTransport transport;
+  transport.push(ok(synthetic_response(CONFIG_OPEN_METEO_MAX_RESPONSE_SIZE)));
+  Client client(&transport);
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  EXPECT_EQ(client.get_weather(&params, &response), -1);
+  EXPECT_FALSE(response);
+  EXPECT_EQ(response.size(), 0u);
+  EXPECT_EQ(client.last_outcome(), outcome_failed);
+}
+
+TEST(Client, FailsTruncatedBodies) {
+  const std::vector<uint8_t> body = synthetic_response(64 * 1024);
+  for (const size_t kept : {size_t(2), size_t(4), size_t(100),
+                            body.size() / 2, body.size() - 1}) {
+    ReplayTransport transport;
+    transport.push(ok(std::vector<uint8_t>(body.begin(), body.begin() + kept)));
+    Client client(&transport);
+    OpenMeteoParams params = forecast_params();
+    WeatherResponse response;
+    EXPECT_EQ(client.get_weather(&params, &response), -1) << kept;
+    EXPECT_FALSE(response) << kept;
+    EXPECT_EQ(client.last_outcome(), outcome_failed) << kept;
+  }
+}
+
+TEST(Client, RetriesATruncatedBodyOnAFreshConnection) {
+  const std::vector<uint8_t> body = synthetic_response(32 * 1024);
+  ReplayTransport transport;
+  transport.push(ok(body));
+  transport.push(ok(std::vector<uint8_t>(body.begin(), body.begin() + 1000)));
+  transport.push(ok(body));
+  Client client(&transport);
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  // The kept-alive connection broke off mid-body, the retry succeeds.
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.size(), body.size());
+  EXPECT_EQ(transport.urls().size(), 3u);
+  EXPECT_EQ(client.requests(), 2u);
+}
+
+TEST(Client, ChunkedRangeWithoutOutputOnlyReportsTheStatus) {
+  ReplayTransport transport;
+  transport.push(ok(synthetic_response(1024)));
+  transport.set_repeat(true);
+  Client client(&transport);
+  OpenMeteoParams params = forecast_params();
+  params.start_date = 1672574400; // 2023-01-01
+  params.end_date = params.start_date + 364 * 86400;
+  const size_t chunks =
+      SplitDateRange(archive_endpoint, params.start_date, params.end_date)
+          .size();
+  ASSERT_GT(chunks, 1u);
+  EXPECT_EQ(client.get(archive_endpoint, &params, (WeatherResponse *)nullptr),
+            200);
+  EXPECT_EQ(transport.urls().size(), chunks);
+}
+
+TEST(Client, ReadsBodiesInShortRandomChunks) {
+  // Three locations, one message each.
+  std::vector<uint8_t> body;
+  for (uint32_t seed = 1; seed <= 3; ++seed) {
+    const std::vector<uint8_t> message =
+        synthetic_response(3000 * seed, seed, 40.f + seed);
+    body.insert(body.end(), message.begin(), message.end());
+  }
+  for (uint32_t seed = 1; seed <= 40; ++seed) {
+    for (const size_t mean : {size_t(1), size_t(7), size_t(300)}) {
+      ChoppyTransport transport(seed, mean, seed % 2);
+      transport.push(ok(body));
+      Client client(&transport);
+      OpenMeteoParams params = forecast_params();
+      WeatherResponse response;
+      ASSERT_EQ(client.get_weather(&params, &response), 200)
+          << seed << " " << mean;
+      ASSERT_EQ(response.size(), body.size()) << seed << " " << mean;
+      EXPECT_EQ(memcmp(response.data(), body.data(), body.size()), 0);
+      const openmeteo_sdk::WeatherApiResponse *messages[4];
+      ASSERT_EQ(response.messages(messages, 4), 3u) << seed << " " << mean;
+      for (size_t i = 0; i < 3; ++i)
+        EXPECT_FLOAT_EQ(messages[i]->latitude(), 41.f + i);
+      EXPECT_GT(transport.reads(), body.size() / (2 * mean));
+    }
+  }
+}
+
+// A body cut short anywhere, the size prefix included, fails however it
+// was chopped.
+TEST(Client, FailsTruncatedBodiesReadInShortChunks) {
+  const std::vector<uint8_t> body = synthetic_response(2048);
+  for (uint32_t seed = 1; seed <= 40; ++seed) {
+    const size_t kept = 1 + seed * 997 % (body.size() - 1);
+    ChoppyTransport transport(seed, 5, false);
+    transport.push(ok(std::vector<uint8_t>(body.begin(), body.begin() + kept)));
+    Client client(&transport);
+    OpenMeteoParams params = forecast_params();
+    WeatherResponse response;
+    EXPECT_EQ(client.get_weather(&params, &response), -1) << kept;
+    EXPECT_FALSE(response) << kept;
+  }
+}
+
+TEST(Client, FailsWhenTheHeadersBreakOff) {
+  struct BrokenHeaders : ReplayTransport {
+    int64_t fetch_headers() override {
+      ReplayTransport::fetch_headers();
+      return -1;
+    }
+  } transport;
+  transport.push(ok(synthetic_response(1024)));
+  Client client(&transport);
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  EXPECT_EQ(client.get_weather(&params, &response), -1);
+  EXPECT_FALSE(response);
+  EXPECT_EQ(client.last_outcome(), outcome_failed);
+}
@@ -0,0 +1,118 @@
+#include "om_client.hpp"
+#include "om_coalesce.hpp"
+#include "stand_in_server.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Waits up to 10 s for `done`.
+template <typename Predicate> bool eventually(Predicate done) {
+  for (int i = 0; i < 10000 && !done(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return done();
+}
+
+} // namespace
+
+// N clients on their own threads ask for the same forecast at once: the
+// server sees one request and everyone gets its buffer.
+TEST(RequestCoalescer, IdenticalConcurrentRequestsFetchOnce) {
+  const size_t threads = 8;
+  RequestCoalescer coalescer;
+  const std::vector<uint8_t> body = synthetic_response(8192);
+  // Answers once every other client is waiting on the fetch.
+  StandInServer server([&](const StandInRequest &) {
+    eventually([&] { return coalescer.stats().coalesced == threads - 1; });
+    StandInReply reply;
+    reply.body.assign(body.begin(), body.end());
+    return reply;
+  });
+  ASSERT_NE(server.start(), 0);
+  const std::string base_url = server.base_url();
+
+  std::vector<int> status_codes(threads, 0);
+  std::vector<SharedResponse> responses(threads);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      Client client;
+      client.set_base_url(base_url.c_str());
+      client.set_coalescer(&coalescer);
+      OpenMeteoParams params = {};
+      params.latitude = 52.52f;
+      params.longitude = 13.41f;
+      params.hourly_set = {temperature_2m, precipitation};
+      status_codes[i] = client.get_weather(&params, &responses[i]);
+    });
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+
+  EXPECT_EQ(server.requests(), 1u);
+  const CoalescerStats stats = coalescer.stats();
+  EXPECT_EQ(stats.fetches, 1u);
+  EXPECT_EQ(stats.coalesced, threads - 1);
+  EXPECT_EQ(stats.in_flight, 0u);
+  for (size_t i = 0; i < threads; ++i) {
+    EXPECT_EQ(status_codes[i], 200) << i;
+    ASSERT_TRUE(responses[i]) << i;
+    EXPECT_EQ(responses[i], responses[0]) << i;
+  }
+  EXPECT_EQ(responses[0]->size(), body.size());
+}
+
+TEST(RequestCoalescer, DifferentQueriesAreNotShared) {
+  RequestCoalescer coalescer;
+  const std::vector<uint8_t> body = synthetic_response(1024);
+  StandInServer server(body, 20);
+  ASSERT_NE(server.start(), 0);
+  const std::string base_url = server.base_url();
+  std::vector<std::thread> workers;
+  std::vector<int> status_codes(4, 0);
+  for (size_t i = 0; i < 4; ++i) {
+    workers.emplace_back([&, i] {
+      Client client;
+      client.set_base_url(base_url.c_str());
+      client.set_coalescer(&coalescer);
+      OpenMeteoParams params = {};
+      params.latitude = 45.f + i;
+      params.hourly_set = {temperature_2m};
+      SharedResponse response;
+      status_codes[i] = client.get_weather(&params, &response);
+    });
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+  EXPECT_EQ(server.requests(), 4u);
+  EXPECT_EQ(coalescer.stats().fetches, 4u);
+  EXPECT_EQ(coalescer.stats().coalesced, 0u);
+  for (const int status_code : status_codes)
+    EXPECT_EQ(status_code, 200);
+}
+
+// Waiters get the failure of the fetch they joined, and the next caller
+// fetches again.
+TEST(RequestCoalescer, WaitersShareAFailure) {
+  RequestCoalescer coalescer;
+  int status_code = 0;
+  SharedResponse response;
+  ASSERT_TRUE(coalescer.join(1, &status_code, &response));
+  std::thread waiter([&] {
+    int waited_status = 0;
+    SharedResponse waited;
+    EXPECT_FALSE(coalescer.join(1, &waited_status, &waited));
+    EXPECT_EQ(waited_status, 503);
+    EXPECT_FALSE(waited);
+  });
+  ASSERT_TRUE(eventually([&] { return coalescer.stats().coalesced == 1; }));
+  coalescer.complete(1, 503, nullptr);
+  waiter.join();
+  EXPECT_TRUE(coalescer.join(1, &status_code, &response));
+  coalescer.complete(1, 200, nullptr);
+  EXPECT_EQ(coalescer.stats().fetches, 2u);
+}
@@ -0,0 +1,287 @@
+#include "om_endpoint.hpp"
+#include "synthetic_response.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <weather_api_generated.h>
+
+using namespace OM_SDK;
+using namespace openmeteo_sdk;
+
+namespace {
+
+// Splits local dates of Berlin, which switches to summer time on the last
+// Sunday of March.
+class SplitDateRangeTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    const char *tz = getenv("TZ");
+    _had_tz = tz != nullptr;
+    if (tz)
+      _tz = tz;
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+  }
+
+  void TearDown() override {
+    if (_had_tz)
+      setenv("TZ", _tz.c_str(), 1);
+    else
+      unsetenv("TZ");
+    tzset();
+  }
+
+  static time_t local(int year, int month, int day, int hour = 0) {
+    struct tm timeinfo = {};
+    timeinfo.tm_year = year - 1900;
+    timeinfo.tm_mon = month - 1;
+    timeinfo.tm_mday = day;
+    timeinfo.tm_hour = hour;
+    timeinfo.tm_isdst = -1;
+    return mktime(&timeinfo);
+  }
+
+  // The range as local "month-day" pairs, checking both ends are at noon.
+  static std::vector<std::pair<std::string, std::string>>
+  dates(const std::vector<DateRange> &ranges) {
+    std::vector<std::pair<std::string, std::string>> output;
+    for (const DateRange &range : ranges)
+      output.emplace_back(date(range.start), date(range.end));
+    return output;
+  }
+
+  static std::string date(time_t value) {
+    struct tm timeinfo;
+    localtime_r(&value, &timeinfo);
+    EXPECT_EQ(timeinfo.tm_hour, 12);
+    char text[8];
+    strftime(text, sizeof(text), "%m-%d", &timeinfo);
+    return text;
+  }
+
+  // The archive endpoint, splitting every `days` days.
+  static Endpoint every(uint16_t days) {
+    Endpoint endpoint = archive_endpoint;
+    endpoint.range_days_max = days;
+    return endpoint;
+  }
+
+private:
+  bool _had_tz{false};
+  std::string _tz;
+};
+
+typedef std::vector<std::pair<std::string, std::string>> Dates;
+
+const int64_t start = 1710979200; // 2024-03-21
+
+std::vector<float> ramp(float first, size_t count) {
+  std::vector<float> values(count);
+  for (size_t i = 0; i < count; ++i)
+    values[i] = first + i;
+  return values;
+}
+
+// One chunk from `from`: hourly temperatures, and when given daily maxima
+// and sunrises, then the current temperature.
+WeatherResponse chunk(int64_t from, const std::vector<float> &hourly,
+                      const std::vector<float> &daily, float current,
+                      Variable variable = Variable_temperature,
+                      int32_t interval = 3600) {
+  flatbuffers::FlatBufferBuilder builder;
+  const auto current_section = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_none, 0, {}, {}, current}}, from,
+      0, 0);
+  const auto hourly_section = synthetic_section(
+      builder, {{variable, 2, Aggregation_none, 0, hourly}}, from,
+      from + (int64_t)hourly.size() * interval, interval);
+  flatbuffers::Offset<VariablesWithTime> daily_section;
+  if (!daily.empty()) {
+    std::vector<int64_t> sunrises;
+    for (size_t i = 0; i < daily.size(); ++i)
+      sunrises.push_back(from + (int64_t)i * 86400 + 21600);
+    daily_section = synthetic_section(
+        builder,
+        {{Variable_temperature, 2, Aggregation_maximum, 0, daily},
+         {Variable_sunrise, 0, Aggregation_none, 0, {}, sunrises}},
+        from, from + (int64_t)daily.size() * 86400, 86400);
+  }
+  const auto timezone = builder.CreateString("Europe/Berlin");
+  WeatherApiResponseBuilder result(builder);
+  result.add_latitude(52.52f);
+  result.add_longitude(13.41f);
+  result.add_utc_offset_seconds(3600);
+  result.add_model(Model_best_match);
+  result.add_timezone(timezone);
+  result.add_current(current_section);
+  result.add_hourly(hourly_section);
+  if (!daily.empty())
+    result.add_daily(daily_section);
+  FinishSizePrefixedWeatherApiResponseBuffer(builder, result.Finish());
+  WeatherResponse response;
+  EXPECT_TRUE(response.reserve(builder.GetSize()));
+  memcpy(response.tail(), builder.GetBufferPointer(), builder.GetSize());
+  response.commit(builder.GetSize());
+  return response;
+}
+
+template <typename T>
+std::vector<T> to_vector(const flatbuffers::Vector<T> *values) {
+  std::vector<T> output;
+  for (size_t i = 0; values && i < values->size(); ++i)
+    output.push_back(values->Get(i));
+  return output;
+}
+
+} // namespace
+
+TEST_F(SplitDateRangeTest, SplitsAtTheRangeLimit) {
+  // Exactly one chunk long.
+  EXPECT_EQ(dates(SplitDateRange(every(7), local(2024, 1, 1),
+                                 local(2024, 1, 7))),
+            (Dates{{"01-01", "01-07"}}));
+  // One day more.
+  EXPECT_EQ(dates(SplitDateRange(every(7), local(2024, 1, 1),
+                                 local(2024, 1, 8))),
+            (Dates{{"01-01", "01-07"}, {"01-08", "01-08"}}));
+  // Two full chunks, then a shorter one. Times of day do not matter.
+  EXPECT_EQ(dates(SplitDateRange(every(7), local(2024, 1, 1, 23),
+                                 local(2024, 1, 17, 1))),
+            (Dates{{"01-01", "01-07"},
+                   {"01-08", "01-14"},
+                   {"01-15", "01-17"}}));
+  // A single day, and a reversed range.
+  EXPECT_EQ(dates(SplitDateRange(every(1), local(2024, 1, 3),
+                                 local(2024, 1, 1))),
+            (Dates{{"01-01", "01-01"},
+                   {"01-02", "01-02"},
+                   {"01-03", "01-03"}}));
+  // The archive's own limit.
+  const std::vector<DateRange> year =
+      SplitDateRange(archive_endpoint, local(2023, 1, 1), local(2023, 12, 31));
+  ASSERT_EQ(year.size(), 4u);
+  EXPECT_EQ(date(year[1].start), "04-03");
+  EXPECT_EQ(date(year[3].end), "12-31");
+}
+
+TEST_F(SplitDateRangeTest, KeepsLocalDatesAcrossDaylightSaving) {
+  // 2024-03-31 has 23 hours, 2024-10-27 has 25.
+  EXPECT_EQ(dates(SplitDateRange(every(7), local(2024, 3, 25),
+                                 local(2024, 4, 10))),
+            (Dates{{"03-25", "03-31"},
+                   {"04-01", "04-07"},
+                   {"04-08", "04-10"}}));
+  EXPECT_EQ(dates(SplitDateRange(every(3), local(2024, 10, 26),
+                                 local(2024, 10, 31))),
+            (Dates{{"10-26", "10-28"}, {"10-29", "10-31"}}));
+  // Both ends of the switch day are on the same local date.
+  EXPECT_EQ(dates(SplitDateRange(every(1), local(2024, 3, 30),
+                                 local(2024, 4, 1))),
+            (Dates{{"03-30", "03-30"},
+                   {"03-31", "03-31"},
+                   {"04-01", "04-01"}}));
+}
+
+TEST_F(SplitDateRangeTest, NeedsARange) {
+  EXPECT_TRUE(SplitDateRange(archive_endpoint, 0, local(2024, 1, 1)).empty());
+  EXPECT_TRUE(SplitDateRange(archive_endpoint, local(2024, 1, 1), 0).empty());
+  // Without a limit the range is passed through as it is.
+  const std::vector<DateRange> whole =
+      SplitDateRange(every(0), local(2020, 1, 1), local(2024, 1, 1));
+  ASSERT_EQ(whole.size(), 1u);
+  EXPECT_EQ(whole[0].start, local(2020, 1, 1));
+  EXPECT_EQ(whole[0].end, local(2024, 1, 1));
+}
+
+TEST(MergeTimeSeries, JoinsHourlyAndDailySections) {
+  WeatherResponse parts[3] = {
+      chunk(start, ramp(0, 24), {10}, 1.f),
+      chunk(start + 86400, ramp(24, 24), {11}, 2.f),
+      chunk(start + 2 * 86400, ramp(48, 24), {12}, 3.f)};
+  WeatherResponse merged;
+  ASSERT_TRUE(MergeTimeSeries(parts, 3, &merged));
+  ASSERT_TRUE(merged);
+  EXPECT_EQ(merged.verified(), verify_full);
+  EXPECT_FLOAT_EQ(merged->latitude(), 52.52f);
+  EXPECT_EQ(merged->model(), Model_best_match);
+  EXPECT_STREQ(merged->timezone()->c_str(), "Europe/Berlin");
+
+  const VariablesWithTime *hourly = merged->hourly();
+  EXPECT_EQ(hourly->time(), start);
+  EXPECT_EQ(hourly->time_end(), start + 3 * 86400);
+  EXPECT_EQ(hourly->interval(), 3600);
+  ASSERT_EQ(hourly->variables()->size(), 1u);
+  EXPECT_EQ(to_vector(hourly->variables()->Get(0)->values()), ramp(0, 72));
+
+  const VariablesWithTime *daily = merged->daily();
+  EXPECT_EQ(daily->time(), start);
+  EXPECT_EQ(daily->time_end(), start + 3 * 86400);
+  EXPECT_EQ(daily->interval(), 86400);
+  ASSERT_EQ(daily->variables()->size(), 2u);
+  EXPECT_EQ(daily->variables()->Get(0)->aggregation(), Aggregation_maximum);
+  EXPECT_EQ(to_vector(daily->variables()->Get(0)->values()),
+            (std::vector<float>{10, 11, 12}));
+  EXPECT_EQ(to_vector(daily->variables()->Get(1)->values_int64()),
+            (std::vector<int64_t>{start + 21600, start + 86400 + 21600,
+                                  start + 2 * 86400 + 21600}));
+  EXPECT_EQ(daily->variables()->Get(1)->values(), nullptr);
+
+  // Current from the last chunk, no 15 minutely data in any.
+  EXPECT_FLOAT_EQ(merged->current()->variables()->Get(0)->value(), 3.f);
+  EXPECT_EQ(merged->current()->time(), start + 2 * 86400);
+  EXPECT_EQ(merged->minutely_15(), nullptr);
+
+  // A single part comes back as it was.
+  ASSERT_TRUE(MergeTimeSeries(parts, 1, &merged));
+  EXPECT_EQ(to_vector(merged->hourly()->variables()->Get(0)->values()),
+            ramp(0, 24));
+}
+
+TEST(MergeTimeSeries, RejectsAxesThatDoNotLineUp) {
+  WeatherResponse merged;
+  const auto merges = [&merged](WeatherResponse second) {
+    WeatherResponse parts[2] = {chunk(start, ramp(0, 24), {10}, 1.f),
+                                std::move(second)};
+    return MergeTimeSeries(parts, 2, &merged);
+  };
+  EXPECT_TRUE(merges(chunk(start + 86400, ramp(24, 24), {11}, 2.f)));
+  // A gap, an overlap, and chunks out of order.
+  EXPECT_FALSE(merges(chunk(start + 86400 + 3600, ramp(24, 24), {11}, 2.f)));
+  EXPECT_FALSE(merges(chunk(start + 86400 - 3600, ramp(24, 24), {11}, 2.f)));
+  EXPECT_FALSE(merges(chunk(start - 86400, ramp(24, 24), {11}, 2.f)));
+  // Another interval or variable.
+  EXPECT_FALSE(merges(chunk(start + 86400, ramp(24, 12), {11}, 2.f,
+                            Variable_temperature, 7200)));
+  EXPECT_FALSE(merges(
+      chunk(start + 86400, ramp(24, 24), {11}, 2.f, Variable_dew_point)));
+
+  // Nothing to merge, or a part that is no response.
+  WeatherResponse parts[2] = {chunk(start, ramp(0, 24), {10}, 1.f),
+                              WeatherResponse()};
+  EXPECT_FALSE(MergeTimeSeries(parts, 0, &merged));
+  EXPECT_FALSE(MergeTimeSeries(parts, 2, &merged));
+  EXPECT_FALSE(MergeTimeSeries(nullptr, 2, &merged));
+  EXPECT_FALSE(MergeTimeSeries(parts, 1, nullptr));
+}
+
+TEST(MergeTimeSeries, RejectsSectionsMissingFromSomeParts) {
+  WeatherResponse merged;
+  WeatherResponse later_without_daily[2] = {
+      chunk(start, ramp(0, 24), {10}, 1.f),
+      chunk(start + 86400, ramp(24, 24), {}, 2.f)};
+  EXPECT_FALSE(MergeTimeSeries(later_without_daily, 2, &merged));
+  WeatherResponse first_without_daily[2] = {
+      chunk(start, ramp(0, 24), {}, 1.f),
+      chunk(start + 86400, ramp(24, 24), {11}, 2.f)};
+  EXPECT_FALSE(MergeTimeSeries(first_without_daily, 2, &merged));
+  // Missing from all of them is fine.
+  WeatherResponse none_daily[2] = {chunk(start, ramp(0, 24), {}, 1.f),
+                                   chunk(start + 86400, ramp(24, 24), {}, 2.f)};
+  ASSERT_TRUE(MergeTimeSeries(none_daily, 2, &merged));
+  EXPECT_EQ(merged->daily(), nullptr);
+  EXPECT_EQ(merged->hourly()->variables()->Get(0)->values()->size(), 48u);
+}
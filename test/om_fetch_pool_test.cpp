@@ -0,0 +1,217 @@
+#include "om_endpoint.hpp"
+#include "om_fetch_pool.hpp"
+#include "om_transport.hpp"
+#include "stand_in_server.hpp"
+#include "synthetic_response.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <string>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Value of `key` in the query of `path`, empty when missing.
+std::string query_value(const std::string &path, const char *key) {
+  const std::string needle = std::string(key) + "=";
+  size_t at = path.find("?" + needle);
+  if (at == std::string::npos)
+    at = path.find("&" + needle);
+  if (at == std::string::npos)
+    return std::string();
+  at += needle.size() + 1;
+  return path.substr(at, path.find('&', at) - at);
+}
+
+// An archive answering each site with a response at its latitude, after a
+// latency varying by request. Latitude 43 always fails, latitude 41 fails
+// the first try of every window.
+class ArchiveServer {
+public:
+  ArchiveServer()
+      : _server([this](const StandInRequest &request) {
+          return reply(request);
+        }) {}
+
+  bool start() { return _server.start() != 0; }
+  std::string base_url() const { return _server.base_url(); }
+
+  size_t max_concurrent() const { return _max_concurrent; }
+  // Requests per site and window, by their latitude and start_date.
+  std::map<std::pair<std::string, std::string>, size_t> requests() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests;
+  }
+
+private:
+  StandInReply reply(const StandInRequest &request) {
+    const size_t concurrent = ++_concurrent;
+    size_t seen = _max_concurrent;
+    while (concurrent > seen &&
+           !_max_concurrent.compare_exchange_weak(seen, concurrent)) {
+    }
+    const std::string latitude = query_value(request.path, "latitude");
+    size_t tries;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      tries = ++_requests[{latitude,
+                           query_value(request.path, "start_date")}];
+    }
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(std::hash<std::string>()(request.path) % 8));
+    StandInReply reply;
+    if (latitude == "43" || (latitude == "41" && tries == 1)) {
+      reply.status_code = latitude == "43" ? 500 : 503;
+    } else {
+      const std::vector<uint8_t> body = synthetic_response(
+          512, tries, strtof(latitude.c_str(), nullptr), 7.f);
+      reply.body.assign(body.begin(), body.end());
+    }
+    --_concurrent;
+    return reply;
+  }
+
+  mutable std::mutex _mutex;
+  std::map<std::pair<std::string, std::string>, size_t> _requests;
+  std::atomic<size_t> _concurrent{0};
+  std::atomic<size_t> _max_concurrent{0};
+  StandInServer _server;
+};
+
+} // namespace
+
+TEST(FetchPool, CountsCorruptBodiesAsFailed) {
+  std::vector<uint8_t> corrupt = synthetic_response(1024);
+  corrupt.resize(corrupt.size() - 16);
+  const uint32_t size = corrupt.size() - 4;
+  memcpy(corrupt.data(), &size, sizeof(size));
+  FetchPoolOptions options;
+  options.connections = 2;
+  options.max_attempts = 2;
+  options.backoff_ms = 1;
+  options.verify = {verify_full};
+  options.transport = [&corrupt] {
+    std::unique_ptr<ReplayTransport> transport(new ReplayTransport());
+    ReplayTransport::Response reply;
+    reply.status_code = 200;
+    reply.body = corrupt;
+    transport->push(reply);
+    transport->set_repeat(true);
+    return std::unique_ptr<Transport>(std::move(transport));
+  };
+  FetchPool pool(options);
+  const Location sites[] = {{45.f, 7.f}, {46.f, 8.f}, {47.f, 9.f}};
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  size_t seen = 0;
+  const size_t failed = pool.run(
+      forecast_endpoint, params, sites, 3,
+      [&seen](const FetchJob &, int status_code, WeatherResponse &&response) {
+        ++seen;
+        EXPECT_EQ(status_code, status_invalid_response);
+        EXPECT_FALSE(response);
+      });
+  EXPECT_EQ(seen, 3u);
+  EXPECT_EQ(failed, 3u);
+  EXPECT_EQ(pool.stats().failed, 3u);
+  // Corrupt bodies are retried like network errors.
+  EXPECT_EQ(pool.stats().requests, 6u);
+  EXPECT_EQ(pool.stats().bytes, 0u);
+}
+
+TEST(FetchPool, FillsEverySiteAndWindowOnceInOrder) {
+  ArchiveServer server;
+  ASSERT_TRUE(server.start());
+  const std::string base_url = server.base_url();
+  FetchPoolOptions options;
+  options.connections = 3;
+  options.max_attempts = 2;
+  options.backoff_ms = 1;
+  options.base_url = base_url.c_str();
+  FetchPool pool(options);
+  const Location sites[] = {
+      {40.f, 7.f}, {41.f, 7.f}, {42.f, 7.f}, {43.f, 7.f}, {44.f, 7.f}};
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  params.start_date = 1672574400; // 2023-01-01
+  params.end_date = params.start_date + 364 * 86400;
+  const std::vector<DateRange> windows =
+      SplitDateRange(archive_endpoint, params.start_date, params.end_date);
+  ASSERT_GT(windows.size(), 1u);
+
+  std::vector<std::pair<size_t, time_t>> order;
+  std::vector<int> statuses;
+  const size_t failed = pool.run(
+      archive_endpoint, params, sites, 5,
+      [&](const FetchJob &job, int status_code, WeatherResponse &&response) {
+        order.emplace_back(job.site, job.range.start);
+        statuses.push_back(status_code);
+        if (status_code == 200) {
+          ASSERT_TRUE(response);
+          EXPECT_FLOAT_EQ(response->latitude(), sites[job.site].latitude);
+        } else {
+          EXPECT_FALSE(response);
+        }
+      });
+
+  // Site by site, each in date order.
+  std::vector<std::pair<size_t, time_t>> expected;
+  for (size_t site = 0; site < 5; ++site) {
+    for (const DateRange &window : windows)
+      expected.emplace_back(site, window.start);
+  }
+  EXPECT_EQ(order, expected);
+  for (size_t i = 0; i < statuses.size(); ++i)
+    EXPECT_EQ(statuses[i], order[i].first == 3 ? 500 : 200) << i;
+
+  EXPECT_EQ(failed, windows.size());
+  const FetchPoolStats &stats = pool.stats();
+  EXPECT_EQ(stats.jobs, 5 * windows.size());
+  EXPECT_EQ(stats.failed, windows.size());
+  // Sites 41 and 43 took two tries per window.
+  EXPECT_EQ(stats.retries, 2 * windows.size());
+  EXPECT_EQ(stats.requests, stats.jobs + stats.retries);
+  EXPECT_LE(server.max_concurrent(), options.connections);
+
+  const auto requests = server.requests();
+  EXPECT_EQ(requests.size(), 5 * windows.size());
+  for (const auto &request : requests) {
+    const bool retried =
+        request.first.first == "41" || request.first.first == "43";
+    EXPECT_EQ(request.second, retried ? 2u : 1u)
+        << request.first.first << " " << request.first.second;
+  }
+}
+
+TEST(FetchPool, RunsWithoutADateRange) {
+  ArchiveServer server;
+  ASSERT_TRUE(server.start());
+  const std::string base_url = server.base_url();
+  FetchPoolOptions options;
+  options.connections = 8;
+  options.base_url = base_url.c_str();
+  FetchPool pool(options);
+  std::vector<Location> sites;
+  for (int i = 0; i < 20; ++i)
+    sites.push_back({50.f + i, 7.f});
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  std::vector<size_t> order;
+  EXPECT_EQ(pool.run(forecast_endpoint, params, sites.data(), sites.size(),
+                     [&](const FetchJob &job, int status_code,
+                         WeatherResponse &&response) {
+                       EXPECT_EQ(status_code, 200);
+                       EXPECT_EQ(job.range.start, 0);
+                       EXPECT_FLOAT_EQ(response->latitude(),
+                                       sites[job.site].latitude);
+                       order.push_back(job.site);
+                     }),
+            0u);
+  ASSERT_EQ(order.size(), sites.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    EXPECT_EQ(order[i], i);
+  EXPECT_EQ(pool.stats().requests, sites.size());
+}
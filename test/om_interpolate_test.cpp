@@ -0,0 +1,196 @@
+#include "om_interpolate.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+const int64_t start = 1710979200; // 2024-03-21
+
+// `count` outputs evenly spread over the whole axis of `values`.
+std::vector<float> sample(const std::vector<float> &values, size_t count,
+                          Interpolation mode) {
+  const TimeAxis axis(start, 3600, values.size());
+  const int32_t step = (int32_t)((values.size() - 1) * 3600 / (count - 1));
+  std::vector<TimeWeight> weights(count);
+  TimeWeights(axis, start, step, count, weights.data());
+  std::vector<float> output(count);
+  Interpolate(Span<float>(values.data(), values.size()), weights.data(),
+              count, mode, output.data());
+  return output;
+}
+
+// Degrees between two angles, through the shorter arc.
+float arc(float a, float b) {
+  const float turn = std::fabs(std::fmod(a - b, 360.f));
+  return turn > 180.f ? 360.f - turn : turn;
+}
+
+} // namespace
+
+TEST(Interpolate, WeightsClampOutsideTheAxis) {
+  const TimeAxis axis(start, 3600, 4);
+  const int64_t times[] = {start - 7200, start, start + 5400,
+                           start + 3 * 3600, start + 86400};
+  TimeWeight weights[5];
+  ASSERT_EQ(TimeWeights(axis, times, 5, weights), 5u);
+  EXPECT_EQ(weights[0].index, 0u);
+  EXPECT_FLOAT_EQ(weights[0].t, 0.f);
+  EXPECT_EQ(weights[1].index, 0u);
+  EXPECT_FLOAT_EQ(weights[1].t, 0.f);
+  EXPECT_EQ(weights[2].index, 1u);
+  EXPECT_FLOAT_EQ(weights[2].t, .5f);
+  EXPECT_EQ(weights[3].index, 2u);
+  EXPECT_FLOAT_EQ(weights[3].t, 1.f);
+  EXPECT_EQ(weights[4].index, 2u);
+  EXPECT_FLOAT_EQ(weights[4].t, 1.f);
+
+  const float values[] = {1, 3, 7, 5};
+  float output[5];
+  Interpolate(Span<float>(values, 4), weights, 5, interpolation_linear,
+              output);
+  EXPECT_FLOAT_EQ(output[0], 1.f);
+  EXPECT_FLOAT_EQ(output[2], 5.f);
+  EXPECT_FLOAT_EQ(output[3], 5.f);
+  EXPECT_FLOAT_EQ(output[4], 5.f);
+
+  // A single sample holds its value everywhere.
+  TimeWeights(TimeAxis(start, 3600, 1), times, 5, weights);
+  Interpolate(Span<float>(values, 1), weights, 5, interpolation_cubic, output);
+  for (float value : output)
+    EXPECT_FLOAT_EQ(value, 1.f);
+}
+
+TEST(Interpolate, CubicDoesNotOvershootSteps) {
+  const std::vector<float> step = {0, 0, 0, 10, 10, 10};
+  const std::vector<float> output = sample(step, 51, interpolation_cubic);
+  for (size_t i = 0; i < output.size(); ++i) {
+    EXPECT_GE(output[i], 0.f) << i;
+    EXPECT_LE(output[i], 10.f) << i;
+    if (i > 0)
+      EXPECT_GE(output[i], output[i - 1]) << i;
+  }
+  // Flat on both sides of the step, and through the samples.
+  EXPECT_FLOAT_EQ(output[5], 0.f);
+  EXPECT_FLOAT_EQ(output[15], 0.f);
+  EXPECT_FLOAT_EQ(output[30], 10.f);
+  EXPECT_FLOAT_EQ(output[45], 10.f);
+}
+
+TEST(Interpolate, CubicFollowsSmoothData) {
+  const std::vector<float> values = {0, 1, 4, 9, 16, 25};
+  const std::vector<float> output = sample(values, 11, interpolation_cubic);
+  for (size_t i = 0; i < output.size(); i += 2)
+    EXPECT_FLOAT_EQ(output[i], values[i / 2]);
+  // Between samples, closer to the parabola than a straight line.
+  EXPECT_NEAR(output[5], 6.25f, .5f);
+  EXPECT_GT(output[5], 4.f);
+  EXPECT_LT(output[5], 6.5f);
+}
+
+TEST(Interpolate, NanSamplesGiveNan) {
+  const std::vector<float> values = {1, NAN, 3, 4, 5};
+  const std::vector<float> linear = sample(values, 9, interpolation_linear);
+  // Both segments touching the NaN, their ends included.
+  for (size_t i = 0; i < 4; ++i)
+    EXPECT_TRUE(std::isnan(linear[i])) << i;
+  EXPECT_FLOAT_EQ(linear[4], 3.f);
+  EXPECT_FLOAT_EQ(linear[5], 3.5f);
+  // An outer NaN neighbour leaves the cubic segment straight.
+  const std::vector<float> cubic = sample(values, 9, interpolation_cubic);
+  EXPECT_FLOAT_EQ(cubic[5], 3.5f);
+
+  float output[2];
+  const TimeWeight weights[2] = {{0, 0.f}, {1, .5f}};
+  Interpolate(Span<float>(), weights, 2, interpolation_linear, output);
+  EXPECT_TRUE(std::isnan(output[0]));
+  EXPECT_TRUE(std::isnan(output[1]));
+}
+
+TEST(Interpolate, AnglesTakeTheShorterArc) {
+  const std::vector<float> output =
+      sample({350, 10}, 5, interpolation_angle);
+  EXPECT_FLOAT_EQ(output[0], 350.f);
+  EXPECT_FLOAT_EQ(output[1], 355.f);
+  EXPECT_NEAR(output[2], 0.f, 1e-3f);
+  EXPECT_FLOAT_EQ(output[3], 5.f);
+  EXPECT_FLOAT_EQ(output[4], 10.f);
+
+  const std::vector<float> back = sample({10, 350}, 3, interpolation_angle);
+  EXPECT_NEAR(back[1], 0.f, 1e-3f);
+  EXPECT_FLOAT_EQ(sample({90, 180}, 3, interpolation_angle)[1], 135.f);
+  // Linear goes the long way round.
+  EXPECT_FLOAT_EQ(sample({350, 10}, 3, interpolation_linear)[1], 180.f);
+
+  EXPECT_EQ(DefaultInterpolation(wind_direction_10m), interpolation_angle);
+  EXPECT_EQ(DefaultInterpolation(wind_direction_120m), interpolation_angle);
+  EXPECT_EQ(DefaultInterpolation(temperature_2m), interpolation_linear);
+}
+
+TEST(Interpolate, BilinearWeights) {
+  GridWeights weights;
+  ASSERT_TRUE(BilinearWeights({50, 10}, {51, 12}, {50.25f, 11.5f}, &weights));
+  EXPECT_FLOAT_EQ(weights.weight[0], .75f * .25f);
+  EXPECT_FLOAT_EQ(weights.weight[1], .75f * .75f);
+  EXPECT_FLOAT_EQ(weights.weight[2], .25f * .25f);
+  EXPECT_FLOAT_EQ(weights.weight[3], .25f * .75f);
+
+  // Clamped to the edges of the box.
+  ASSERT_TRUE(BilinearWeights({50, 10}, {51, 12}, {49, 13}, &weights));
+  EXPECT_FLOAT_EQ(weights.weight[1], 1.f);
+  EXPECT_FLOAT_EQ(weights.weight[0] + weights.weight[2] + weights.weight[3],
+                  0.f);
+
+  // A single grid point.
+  ASSERT_TRUE(BilinearWeights({50, 10}, {50, 10}, {50.5f, 9}, &weights));
+  EXPECT_FLOAT_EQ(weights.weight[0], 1.f);
+
+  EXPECT_FALSE(BilinearWeights({51, 10}, {50, 12}, {50, 11}, &weights));
+  EXPECT_FALSE(BilinearWeights({50, 10}, {51, 12}, {50, 11}, nullptr));
+}
+
+TEST(Interpolate, BilinearWeightsAcrossTheAntimeridian) {
+  GridWeights weights;
+  // 179.5 east to 179.5 west.
+  ASSERT_TRUE(
+      BilinearWeights({-17, 179.5f}, {-16, -179.5f}, {-16.5f, -179.75f},
+                      &weights));
+  EXPECT_FLOAT_EQ(weights.weight[0], .5f * .25f);
+  EXPECT_FLOAT_EQ(weights.weight[1], .5f * .75f);
+  ASSERT_TRUE(BilinearWeights({-17, 179.5f}, {-16, -179.5f}, {-17, 179.75f},
+                              &weights));
+  EXPECT_FLOAT_EQ(weights.weight[0], .75f);
+  EXPECT_FLOAT_EQ(weights.weight[1], .25f);
+  // Outside, to the nearer edge.
+  ASSERT_TRUE(BilinearWeights({-17, 179.5f}, {-16, -179.5f}, {-17, 170},
+                              &weights));
+  EXPECT_FLOAT_EQ(weights.weight[0], 1.f);
+  ASSERT_TRUE(BilinearWeights({-17, 179.5f}, {-16, -179.5f}, {-17, -170},
+                              &weights));
+  EXPECT_FLOAT_EQ(weights.weight[1], 1.f);
+}
+
+TEST(Interpolate, BlendsCorners) {
+  const float sw[] = {0, 350, 90};
+  const float se[] = {4, 10, 90};
+  const float nw[] = {8, 350, 180};
+  const float ne[] = {12, 10, 180};
+  const float *const corners[4] = {sw, se, nw, ne};
+  GridWeights weights;
+  ASSERT_TRUE(BilinearWeights({50, 10}, {51, 12}, {50.5f, 11}, &weights));
+
+  float output[3];
+  Blend(corners, weights, 3, interpolation_linear, output);
+  EXPECT_FLOAT_EQ(output[0], 6.f);
+  EXPECT_FLOAT_EQ(output[1], 180.f);
+
+  Blend(corners, weights, 3, interpolation_angle, output);
+  EXPECT_NEAR(arc(output[1], 0.f), 0.f, 1e-3f);
+  EXPECT_NEAR(output[2], 135.f, 1e-3f);
+  for (float angle : output) {
+    EXPECT_GE(angle, 0.f);
+    EXPECT_LT(angle, 360.f);
+  }
+}
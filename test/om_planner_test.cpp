@@ -0,0 +1,146 @@
+#include "om_client.hpp"
+#include "om_endpoint.hpp"
+#include "om_planner.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Runs a test in Central European time, DST starting on 2024-03-31.
+class QueryPlannerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    const char *tz = getenv("TZ");
+    _had_tz = tz != nullptr;
+    if (tz)
+      _tz = tz;
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    ReplayTransport::Response reply;
+    reply.status_code = 200;
+    // 10 days of hours.
+    reply.body = synthetic_response(240 * 16 * sizeof(float));
+    transport.push(reply);
+    transport.set_repeat(true);
+  }
+
+  void TearDown() override {
+    if (_had_tz)
+      setenv("TZ", _tz.c_str(), 1);
+    else
+      unsetenv("TZ");
+    tzset();
+  }
+
+  ReplayTransport transport;
+  Client client{&transport};
+  QueryPlanner planner{&client, PlannerConfig(), [] { return int64_t(0); }};
+
+private:
+  bool _had_tz{false};
+  std::string _tz;
+};
+
+OpenMeteoParams archive_params(time_t start_date, time_t end_date) {
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = 13.41f;
+  params.hourly_set = {temperature_2m};
+  params.start_date = start_date;
+  params.end_date = end_date;
+  return params;
+}
+
+// The first and count of the hourly values of `param` in a view.
+struct Window {
+  long first{-1};
+  size_t count{0};
+};
+
+ViewCallback record(Window *window, TimeParam param = temperature_2m) {
+  return [window, param](int status_code, const ResponseView &view) {
+    ASSERT_EQ(status_code, 200);
+    ASSERT_TRUE(view.hourly().find(param));
+    const float *all = view.hourly().find(param)->values()->data();
+    const Span<float> values = view.hourly().values(param);
+    window->first = values.data() - all;
+    window->count = values.size();
+  };
+}
+
+} // namespace
+
+// Offsets follow the dates the requests send, not elapsed time: these are
+// 1.9 days apart over the DST change but a day apart on the calendar.
+TEST_F(QueryPlannerTest, DaysFollowTheCalendar) {
+  const time_t march_30 = 1711755000;    // 2024-03-30 00:30 CET
+  const time_t april_5 = 1712311200;     // 2024-04-05 12:00 CEST
+  const time_t march_31 = 1711920600;    // 2024-03-31 23:30 CEST
+  const time_t april_2 = 1712010600;     // 2024-04-02 00:30 CEST
+  Window wide, narrow;
+  ASSERT_TRUE(planner.submit(archive_endpoint,
+                             archive_params(march_30, april_5),
+                             record(&wide)));
+  ASSERT_TRUE(planner.submit(archive_endpoint,
+                             archive_params(march_31, april_2),
+                             record(&narrow)));
+  EXPECT_EQ(planner.flush(), 1u);
+  EXPECT_EQ(wide.first, 0);
+  EXPECT_EQ(wide.count, 7u * 24);
+  // March 31 to April 2.
+  EXPECT_EQ(narrow.first, 24);
+  EXPECT_EQ(narrow.count, 3u * 24);
+}
+
+TEST_F(QueryPlannerTest, DaysMergeOnlyInUtc) {
+  char utc[] = "UTC";
+  char berlin[] = "Europe/Berlin";
+  OpenMeteoParams first = archive_params(1711755000, 1712311200);
+  OpenMeteoParams second = archive_params(1711920600, 1712010600);
+  first.timezone = second.timezone = utc;
+  Window windows[6];
+  ASSERT_TRUE(planner.submit(archive_endpoint, first, record(&windows[0])));
+  ASSERT_TRUE(planner.submit(archive_endpoint, second, record(&windows[1])));
+  EXPECT_EQ(planner.flush(), 1u);
+
+  first.timezone = second.timezone = berlin;
+  ASSERT_TRUE(planner.submit(archive_endpoint, first, record(&windows[2])));
+  ASSERT_TRUE(planner.submit(archive_endpoint, second, record(&windows[3])));
+  EXPECT_EQ(planner.flush(), 2u);
+
+  // Same days: one request, each view the whole response.
+  OpenMeteoParams other = first;
+  other.hourly_set = {precipitation};
+  ASSERT_TRUE(planner.submit(archive_endpoint, first, record(&windows[4])));
+  ASSERT_TRUE(planner.submit(archive_endpoint, other,
+                             record(&windows[5], precipitation)));
+  EXPECT_EQ(planner.flush(), 1u);
+  EXPECT_EQ(windows[4].first, 0);
+  EXPECT_EQ(windows[4].count, 240u);
+  EXPECT_EQ(windows[5].first, 0);
+  EXPECT_EQ(windows[5].count, 240u);
+  EXPECT_EQ(planner.stats().round_trips, 4u);
+}
+
+// Daily values come in the timezone of the place, their queries do not
+// merge days with hourly ones in UTC.
+TEST_F(QueryPlannerTest, DailyQueriesKeepTheirDays) {
+  OpenMeteoParams hourly = archive_params(1711755000, 1712311200);
+  OpenMeteoParams daily = archive_params(1711920600, 1712010600);
+  daily.daily_set = {temperature_2m_max};
+  Window windows[2];
+  ASSERT_TRUE(planner.submit(archive_endpoint, hourly, record(&windows[0])));
+  ASSERT_TRUE(planner.submit(archive_endpoint, daily, record(&windows[1])));
+  EXPECT_EQ(planner.flush(), 2u);
+  ASSERT_EQ(transport.urls().size(), 2u);
+  EXPECT_EQ(transport.urls()[0].find("timezone="), std::string::npos);
+  EXPECT_NE(transport.urls()[1].find("timezone=auto"), std::string::npos);
+}
@@ -0,0 +1,156 @@
+#include "om_internal.hpp"
+#include "om_query.hpp"
+#include "open_meteo.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace OM_SDK;
+
+namespace {
+
+// Formats times in UTC, as the golden urls were recorded.
+class QueryBuilderTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    const char *tz = getenv("TZ");
+    _had_tz = tz != nullptr;
+    if (tz)
+      _tz = tz;
+    setenv("TZ", "UTC0", 1);
+    tzset();
+  }
+
+  void TearDown() override {
+    if (_had_tz)
+      setenv("TZ", _tz.c_str(), 1);
+    else
+      unsetenv("TZ");
+    tzset();
+  }
+
+private:
+  bool _had_tz{false};
+  std::string _tz;
+};
+
+// Every field set, daily included so the timezone is forced to auto.
+OpenMeteoParams all_fields() {
+  static openmeteo_sdk::Model models[] = {openmeteo_sdk::Model_icon_d2,
+                                          openmeteo_sdk::Model_gfs_seamless,
+                                          openmeteo_sdk::Model_undefined};
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = -13.4125f;
+  params.elevation = 38.5f;
+  params.elevation_default = false;
+  params.hourly_set = {temperature_2m, relative_humidity_2m, precipitation,
+                       weather_code, visibility};
+  params.daily_set = {temperature_2m_max, temperature_2m_min, sunrise,
+                      sunset, precipitation_sum};
+  params.minutely_15_set = {precipitation, lightning_potential};
+  params.current_set = {temperature_2m, is_day};
+  params.temperature_unit = fahrenheit;
+  params.wind_speed_unit = kn;
+  params.precipitation_unit = inch;
+  params.timeformat = unixtime;
+  params.past_days = 2;
+  params.forecast_days = 7;
+  params.forecast_hours = 48;
+  params.forecast_minutely_15 = 24;
+  params.past_hours = 6;
+  params.past_minutely_15 = 8;
+  params.start_date = 1710979200;        // 2024-03-21
+  params.end_date = 1711584000;          // 2024-03-28
+  params.start_hour = 1711022400;        // 2024-03-21T12:00
+  params.end_hour = 1711058400;          // 2024-03-21T22:00
+  params.start_minutely_15 = 1711023300; // 2024-03-21T12:15
+  params.end_minutely_15 = 1711026000;   // 2024-03-21T13:00
+  params.models = models;
+  params.cell_selection = nearest;
+  return params;
+}
+
+} // namespace
+
+// The urls the stringstream builder produced before the QueryBuilder.
+TEST_F(QueryBuilderTest, MatchesTheStringstreamUrls) {
+  StaticQueryBuilder<CONFIG_OPEN_METEO_MAX_URL_LENGTH> query;
+  OpenMeteoParams params = all_fields();
+  ASSERT_TRUE(paramsToString(&params, &query));
+  EXPECT_STREQ(
+      query.c_str(),
+      "?latitude=52.52&longitude=-13.4125&format=flatbuffers"
+      "&elevation=38.5"
+      "&hourly=precipitation,relative_humidity_2m,temperature_2m,"
+      "visibility,weather_code"
+      "&minutely_15=lightning_potential,precipitation"
+      "&current=is_day,temperature_2m"
+      "&daily=precipitation_sum,sunrise,sunset,temperature_2m_max,"
+      "temperature_2m_min"
+      "&temperature_unit=fahrenheit&wind_speed_unit=kn"
+      "&precipitation_unit=inch&timeformat=unixtime&timezone=auto"
+      "&past_days=2&forecast_days=7&forecast_hours=48"
+      "&forecast_minutely_15=24&past_hours=6&pas_minutely_15=8"
+      "&start_date=2024-03-21&end_date=2024-03-28"
+      "&start_hour=2024-03-21T12:00&end_hour=2024-03-21T22:00"
+      "&start_minutely_15=2024-03-21T12:15"
+      "&end_minutely_15=2024-03-21T13:00"
+      "&model=icon_d2,gfs_seamless&cell_selection=nearest");
+
+  // Without daily values the caller's timezone is sent.
+  static char timezone[] = "Europe/Berlin";
+  params = {};
+  params.latitude = -33.8688f;
+  params.longitude = 151.209f;
+  params.hourly_set = {temperature_2m};
+  params.timezone = timezone;
+  query.clear();
+  ASSERT_TRUE(paramsToString(&params, &query));
+  EXPECT_STREQ(query.c_str(),
+               "?latitude=-33.8688&longitude=151.209&format=flatbuffers"
+               "&hourly=temperature_2m&timezone=Europe/Berlin");
+}
+
+TEST_F(QueryBuilderTest, ReportsOverflow) {
+  const OpenMeteoParams params = all_fields();
+  StaticQueryBuilder<CONFIG_OPEN_METEO_MAX_URL_LENGTH> full;
+  ASSERT_TRUE(paramsToString(&params, &full));
+  // One byte short of the url and its terminator.
+  char buffer[CONFIG_OPEN_METEO_MAX_URL_LENGTH];
+  QueryBuilder query(buffer, full.size());
+  EXPECT_FALSE(paramsToString(&params, &query));
+  EXPECT_TRUE(query.overflow());
+  EXPECT_LT(query.size(), full.size());
+  // What was written is a null terminated prefix.
+  EXPECT_EQ(std::string(full.c_str()).compare(0, query.size(), query.c_str()),
+            0);
+
+  // Exactly large enough.
+  QueryBuilder exact(buffer, full.size() + 1);
+  EXPECT_TRUE(paramsToString(&params, &exact));
+  EXPECT_FALSE(exact.overflow());
+  EXPECT_STREQ(exact.c_str(), full.c_str());
+}
+
+TEST_F(QueryBuilderTest, StopsAppendingOnceFull) {
+  char buffer[8];
+  QueryBuilder query(buffer, sizeof(buffer));
+  query.append("abc").append(12);
+  EXPECT_STREQ(query.c_str(), "abc12");
+  // Formatted values that do not fit leave the content as it was.
+  query.append(1.5f);
+  EXPECT_TRUE(query.overflow());
+  EXPECT_STREQ(query.c_str(), "abc12");
+  query.append("d");
+  EXPECT_STREQ(query.c_str(), "abc12");
+  query.clear();
+  EXPECT_FALSE(query.overflow());
+  EXPECT_EQ(query.size(), 0u);
+  query.append_time(1711022400, "%FT%H:%M");
+  EXPECT_TRUE(query.overflow());
+
+  QueryBuilder empty(buffer, 0);
+  EXPECT_TRUE(empty.overflow());
+}
@@ -0,0 +1,168 @@
+#include "om_accessor.hpp"
+#include "om_client.hpp"
+#include "om_response.hpp"
+#include "om_transport.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+
+using namespace OM_SDK;
+using namespace openmeteo_sdk;
+
+namespace {
+
+// Reads every field of every table, as an application would.
+double walk(const VariablesWithTime *section) {
+  if (!section)
+    return 0.;
+  double sum = section->time() + section->time_end() + section->interval();
+  if (!section->variables())
+    return sum;
+  for (const VariableWithValues *variable : *section->variables()) {
+    sum += variable->variable() + variable->unit() + variable->value() +
+           variable->altitude() + variable->aggregation() +
+           variable->pressure_level() + variable->depth() +
+           variable->depth_to() + variable->ensemble_member() +
+           variable->previous_day();
+    if (variable->values()) {
+      for (const float value : *variable->values())
+        sum += value == value ? value : 0.;
+    }
+    if (variable->values_int64()) {
+      for (const int64_t value : *variable->values_int64())
+        sum += value;
+    }
+  }
+  return sum;
+}
+
+double walk(const WeatherApiResponse *response) {
+  double sum = response->latitude() + response->longitude() +
+               response->elevation() +
+               response->generation_time_milliseconds() +
+               response->location_id() + response->model() +
+               response->utc_offset_seconds();
+  if (response->timezone())
+    sum += strlen(response->timezone()->c_str());
+  if (response->timezone_abbreviation())
+    sum += strlen(response->timezone_abbreviation()->c_str());
+  sum += walk(response->current()) + walk(response->daily()) +
+         walk(response->hourly()) + walk(response->minutely_15()) +
+         walk(response->six_hourly());
+  ResponseIndex index(response);
+  return sum + index.hourly().time().size();
+}
+
+VerifyOptions full() {
+  VerifyOptions options;
+  options.mode = verify_full;
+  return options;
+}
+
+VerifyOptions header() {
+  VerifyOptions options;
+  options.mode = verify_header;
+  return options;
+}
+
+bool cut(size_t i) { return i % 4 >= 2; }
+
+} // namespace
+
+TEST(VerifyMessages, AcceptsIntactBodies) {
+  for (const size_t bytes : {size_t(64), size_t(4096), size_t(64 * 1024)}) {
+    const std::vector<uint8_t> body = synthetic_response(bytes);
+    EXPECT_TRUE(VerifyMessages(body.data(), body.size(), full()));
+    EXPECT_TRUE(VerifyMessages(body.data(), body.size(), header()));
+  }
+}
+
+TEST(VerifyMessages, RejectsEmptyAndShortBodies) {
+  const std::vector<uint8_t> body = synthetic_response(256);
+  for (size_t size = 0; size < 8; ++size) {
+    EXPECT_FALSE(VerifyMessages(body.data(), size, full())) << size;
+    EXPECT_FALSE(VerifyMessages(body.data(), size, header())) << size;
+  }
+}
+
+// Corrupt bodies never crash the verifier, cut ones are always rejected,
+// and whatever full verification accepts can be read entirely.
+TEST(VerifyMessages, FuzzMutatedBodies) {
+  for (const size_t bytes : {size_t(64), size_t(1024), size_t(16 * 1024)}) {
+    const std::vector<uint8_t> body = synthetic_response(bytes, bytes);
+    for (const uint32_t seed : {1u, 0x9e3779b9u, 0xdeadbeefu, 12345u}) {
+      const std::vector<std::vector<uint8_t>> mutated =
+          mutations(body, 512, seed);
+      for (size_t i = 0; i < mutated.size(); ++i) {
+        const std::vector<uint8_t> &payload = mutated[i];
+        const bool accepted =
+            VerifyMessages(payload.data(), payload.size(), full());
+        VerifyMessages(payload.data(), payload.size(), header());
+        if (cut(i) && payload.size() < body.size()) {
+          EXPECT_FALSE(accepted)
+              << bytes << " bytes, seed " << seed << ", copy " << i
+              << " cut to " << payload.size();
+        }
+        if (accepted)
+          walk(GetSizePrefixedWeatherApiResponse(payload.data()));
+      }
+    }
+  }
+}
+
+// Through the client: each corrupt body fails with -1 when it did not
+// arrive whole and status_invalid_response when it did, never with a 200
+// the verifier would refuse.
+TEST(Client, FuzzMutatedBodies) {
+  const std::vector<uint8_t> body = synthetic_response(2048);
+  const std::vector<std::vector<uint8_t>> mutated = mutations(body, 256);
+  OpenMeteoParams params = {};
+  params.hourly_set = {temperature_2m};
+  for (size_t i = 0; i < mutated.size(); ++i) {
+    ReplayTransport transport;
+    ReplayTransport::Response reply;
+    reply.status_code = 200;
+    reply.body = mutated[i];
+    transport.push(reply);
+    Client client(&transport);
+    client.set_verify(full());
+    WeatherResponse response;
+    const int status_code = client.get_weather(&params, &response);
+    if (status_code == 200) {
+      EXPECT_TRUE(VerifyMessages(reply.body.data(), reply.body.size(),
+                                 full()))
+          << "copy " << i;
+      ASSERT_TRUE(response);
+      walk(response.get());
+    } else {
+      EXPECT_TRUE(status_code == -1 || status_code == status_invalid_response)
+          << "copy " << i << ": " << status_code;
+      EXPECT_FALSE(response);
+      EXPECT_EQ(client.last_outcome(), outcome_failed);
+    }
+    if (i % 4 == 3 && reply.body.size() > 4 &&
+        reply.body.size() < body.size()) {
+      EXPECT_EQ(status_code, status_invalid_response) << "copy " << i;
+    }
+  }
+}
+
+TEST(Client, CorruptBodyIsNotRetriedOnTheSameRequest) {
+  std::vector<uint8_t> body = synthetic_response(1024);
+  body.resize(body.size() / 2);
+  const uint32_t size = body.size() - 4;
+  memcpy(body.data(), &size, sizeof(size));
+  ReplayTransport transport;
+  ReplayTransport::Response reply;
+  reply.status_code = 200;
+  reply.body = synthetic_response(1024);
+  transport.push(reply);
+  reply.body = body;
+  transport.push(reply);
+  Client client(&transport);
+  client.set_verify({verify_full});
+  OpenMeteoParams params = {};
+  WeatherResponse response;
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  EXPECT_EQ(client.get_weather(&params, &response), status_invalid_response);
+  EXPECT_EQ(transport.urls().size(), 2u);
+}
@@ -0,0 +1,176 @@
+#include "om_cache.hpp"
+#include "om_client.hpp"
+#include "stand_in_server.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// A forecast the server versions by ETag and Last-Modified, answering 304
+// when either validator sent back still matches.
+class VersionedServer {
+public:
+  VersionedServer()
+      : _server([this](const StandInRequest &request) {
+          return reply(request);
+        }) {}
+
+  bool start() { return _server.start() != 0; }
+  std::string base_url() const { return _server.base_url(); }
+  const StandInServer &server() const { return _server; }
+
+  // A new version of the forecast, `etag` empty to send none.
+  void publish(uint32_t seed, const char *etag, const char *last_modified) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::vector<uint8_t> body = synthetic_response(4096, seed);
+    _body.assign(body.begin(), body.end());
+    _etag = etag;
+    _last_modified = last_modified;
+  }
+
+  // Validators of each request received, in order.
+  std::vector<std::pair<std::string, std::string>> sent() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _sent;
+  }
+
+  size_t body_size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _body.size();
+  }
+
+private:
+  StandInReply reply(const StandInRequest &request) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::string etag = request.header("If-None-Match");
+    const std::string since = request.header("If-Modified-Since");
+    _sent.emplace_back(etag, since);
+    StandInReply reply;
+    // An ETag decides alone, Last-Modified only counts without one.
+    const bool current = !etag.empty()    ? etag == _etag
+                         : !since.empty() ? since == _last_modified
+                                          : false;
+    if (current) {
+      reply.status_code = 304;
+      return reply;
+    }
+    reply.body = _body;
+    if (!_etag.empty())
+      reply.headers.emplace_back("ETag", _etag);
+    reply.headers.emplace_back("Last-Modified", _last_modified);
+    return reply;
+  }
+
+  mutable std::mutex _mutex;
+  std::string _body;
+  std::string _etag;
+  std::string _last_modified;
+  std::vector<std::pair<std::string, std::string>> _sent;
+  StandInServer _server;
+};
+
+OpenMeteoParams forecast_params() {
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = 13.41f;
+  params.hourly_set = {temperature_2m};
+  return params;
+}
+
+const char *monday = "Mon, 12 Oct 2026 06:00:00 GMT";
+const char *tuesday = "Tue, 13 Oct 2026 06:00:00 GMT";
+
+} // namespace
+
+// Entries expire at once, every request after the first revalidates.
+TEST(Revalidation, RoundTripsTheValidators) {
+  VersionedServer versions;
+  versions.publish(1, "\"v1\"", monday);
+  ASSERT_TRUE(versions.start());
+  const std::string base_url = versions.base_url();
+  ForecastCache cache(1 << 20, 0);
+  Client client;
+  client.set_base_url(base_url.c_str());
+  client.set_cache(&cache);
+  OpenMeteoParams params = forecast_params();
+
+  SharedResponse first;
+  ASSERT_EQ(client.get_weather(&params, &first), 200);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(client.last_outcome(), outcome_fetched);
+  EXPECT_EQ(client.not_modified(), 0u);
+
+  SharedResponse second;
+  ASSERT_EQ(client.get_weather(&params, &second), 200);
+  EXPECT_EQ(client.last_outcome(), outcome_not_modified);
+  // The cached buffer, not a copy.
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(client.not_modified(), 1u);
+  EXPECT_EQ(client.bytes_saved(), first->size());
+
+  // A new version: fetched in full, then revalidated with its own ETag.
+  versions.publish(2, "\"v2\"", tuesday);
+  SharedResponse third;
+  ASSERT_EQ(client.get_weather(&params, &third), 200);
+  EXPECT_EQ(client.last_outcome(), outcome_fetched);
+  ASSERT_TRUE(third);
+  EXPECT_NE(third, first);
+  EXPECT_EQ(third->size(), versions.body_size());
+  ASSERT_EQ(client.get_weather(&params, &third), 200);
+  EXPECT_EQ(client.not_modified(), 2u);
+  EXPECT_EQ(client.bytes_saved(), first->size() + third->size());
+
+  const auto sent = versions.sent();
+  ASSERT_EQ(sent.size(), 4u);
+  EXPECT_EQ(sent[0], std::make_pair(std::string(), std::string()));
+  EXPECT_EQ(sent[1], std::make_pair(std::string("\"v1\""),
+                                    std::string(monday)));
+  EXPECT_EQ(sent[2], sent[1]);
+  EXPECT_EQ(sent[3], std::make_pair(std::string("\"v2\""),
+                                    std::string(tuesday)));
+  // 304s carry no body, the connection stays usable.
+  EXPECT_EQ(versions.server().connections_opened(), 1u);
+}
+
+TEST(Revalidation, FallsBackToLastModified) {
+  VersionedServer versions;
+  versions.publish(1, "", monday);
+  ASSERT_TRUE(versions.start());
+  const std::string base_url = versions.base_url();
+  ForecastCache cache(1 << 20, 0);
+  Client client;
+  client.set_base_url(base_url.c_str());
+  client.set_cache(&cache);
+  OpenMeteoParams params = forecast_params();
+  SharedResponse response;
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  EXPECT_EQ(client.not_modified(), 1u);
+  const auto sent = versions.sent();
+  ASSERT_EQ(sent.size(), 2u);
+  EXPECT_EQ(sent[1], std::make_pair(std::string(), std::string(monday)));
+}
+
+// Without a cache there is nothing to revalidate: no validators go out and
+// every request is a full fetch.
+TEST(Revalidation, SendsNoValidatorsWithoutACache) {
+  VersionedServer versions;
+  versions.publish(1, "\"v1\"", monday);
+  ASSERT_TRUE(versions.start());
+  const std::string base_url = versions.base_url();
+  Client client;
+  client.set_base_url(base_url.c_str());
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  for (int i = 0; i < 3; ++i)
+    ASSERT_EQ(client.get_weather(&params, &response), 200);
+  EXPECT_EQ(client.not_modified(), 0u);
+  EXPECT_EQ(client.bytes_saved(), 0u);
+  for (const auto &validators : versions.sent())
+    EXPECT_EQ(validators, std::make_pair(std::string(), std::string()));
+}
@@ -0,0 +1,191 @@
+#include "om_client.hpp"
+#include "om_scheduler.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// A run of the 3 hourly models, 2026-10-17 09:00 UTC.
+const time_t run = 1792227600;
+const uint32_t three_hours = 3 * 3600;
+
+ReplayTransport::Response reply(int status_code, std::vector<uint8_t> body) {
+  ReplayTransport::Response response;
+  response.status_code = status_code;
+  response.body = std::move(body);
+  return response;
+}
+
+std::vector<uint8_t> icon_d2(size_t locations = 1) {
+  std::vector<uint8_t> body;
+  for (size_t i = 0; i < locations; ++i) {
+    const std::vector<uint8_t> message = synthetic_response(
+        256, i + 1, 50.f + i, 10.f, openmeteo_sdk::Model_icon_d2);
+    body.insert(body.end(), message.begin(), message.end());
+  }
+  return body;
+}
+
+OpenMeteoParams forecast_params(float latitude = 50.f) {
+  OpenMeteoParams params = {};
+  params.latitude = latitude;
+  params.longitude = 10.f;
+  params.hourly_set = {temperature_2m};
+  return params;
+}
+
+SchedulerConfig no_jitter() {
+  SchedulerConfig config;
+  config.jitter = 0;
+  return config;
+}
+
+// A scheduler on a clock the test moves.
+struct SimulatedScheduler {
+  explicit SimulatedScheduler(const SchedulerConfig &config = no_jitter(),
+                              uint32_t seed = 1)
+      : client(&transport),
+        scheduler(&client, config, [this] { return now; }, seed) {}
+
+  // Callback recording the status codes it got.
+  WeatherCallback record() {
+    return [this](int status_code, SharedResponse) {
+      statuses.push_back(status_code);
+    };
+  }
+
+  time_t now{run + 1000};
+  ReplayTransport transport;
+  Client client;
+  RefreshScheduler scheduler;
+  std::vector<int> statuses;
+};
+
+} // namespace
+
+TEST(RefreshScheduler, RefreshesWhenTheNextRunIsServed) {
+  SimulatedScheduler sim;
+  const RefreshScheduler &scheduler = sim.scheduler;
+  const openmeteo_sdk::Model model = openmeteo_sdk::Model_icon_d2;
+  // Served 15 minutes after the run.
+  EXPECT_EQ(scheduler.next_refresh(model, run + 1000),
+            run + three_hours + 900);
+  EXPECT_EQ(scheduler.next_refresh(model, run + 900), run + three_hours + 900);
+  // The run of 09:00 is not served yet at 09:14:59.
+  EXPECT_EQ(scheduler.next_refresh(model, run + 899), run + 900);
+  EXPECT_EQ(scheduler.next_refresh(model, run - 1), run + 900);
+  // Unknown cadences use default_interval.
+  EXPECT_EQ(
+      scheduler.next_refresh(openmeteo_sdk::Model_best_match, run + 1000),
+      run + 3600 + 900);
+}
+
+TEST(RefreshScheduler, PollsOnlyWhatIsDue) {
+  SimulatedScheduler sim;
+  sim.transport.push(reply(200, icon_d2()));
+  sim.transport.set_repeat(true);
+  const QueryId id = sim.scheduler.add(forecast_params(), sim.record());
+  EXPECT_EQ(sim.scheduler.due(id), sim.now);
+  EXPECT_EQ(sim.scheduler.poll(), 1u);
+  EXPECT_EQ(sim.statuses, std::vector<int>{200});
+  const time_t next = run + three_hours + 900;
+  EXPECT_EQ(sim.scheduler.due(id), next);
+  EXPECT_EQ(sim.scheduler.next_due(), next);
+
+  // Nothing until the next run is served.
+  for (sim.now = run + 1000; sim.now < next; sim.now += 600)
+    EXPECT_EQ(sim.scheduler.poll(), 0u);
+  sim.now = next;
+  EXPECT_EQ(sim.scheduler.poll(), 1u);
+  EXPECT_EQ(sim.scheduler.due(id), next + three_hours);
+  EXPECT_EQ(sim.transport.urls().size(), 2u);
+}
+
+TEST(RefreshScheduler, RetriesFailuresAfterTheRetryDelay) {
+  SimulatedScheduler sim;
+  sim.transport.push(reply(503, {}));
+  sim.transport.push(reply(200, icon_d2()));
+  const QueryId id = sim.scheduler.add(forecast_params(), sim.record());
+  EXPECT_EQ(sim.scheduler.poll(), 1u);
+  EXPECT_EQ(sim.scheduler.due(id), sim.now + 300);
+  sim.now += 299;
+  EXPECT_EQ(sim.scheduler.poll(), 0u);
+  sim.now += 1;
+  EXPECT_EQ(sim.scheduler.poll(), 1u);
+  EXPECT_EQ(sim.statuses, (std::vector<int>{503, 200}));
+  EXPECT_EQ(sim.scheduler.due(id), run + three_hours + 900);
+}
+
+TEST(RefreshScheduler, FetchesDueLocationsTogether) {
+  SimulatedScheduler sim;
+  sim.transport.push(reply(200, icon_d2(3)));
+  std::vector<float> latitudes;
+  for (int i = 0; i < 3; ++i) {
+    sim.scheduler.add(forecast_params(50.f + i),
+                      [&latitudes](int status_code, SharedResponse response) {
+                        ASSERT_EQ(status_code, 200);
+                        latitudes.push_back((*response)->latitude());
+                      });
+  }
+  EXPECT_EQ(sim.scheduler.poll(), 1u);
+  EXPECT_EQ(latitudes, (std::vector<float>{50.f, 51.f, 52.f}));
+  ASSERT_EQ(sim.transport.urls().size(), 1u);
+  EXPECT_NE(sim.transport.urls()[0].find("latitude=50,51,52&"),
+            std::string::npos)
+      << sim.transport.urls()[0];
+}
+
+// The same seed gives the same refresh times, each within the jitter of
+// the run.
+TEST(RefreshScheduler, JitterIsBoundedAndSeeded) {
+  SchedulerConfig config;
+  config.jitter = 120;
+  std::vector<time_t> dues[2];
+  for (std::vector<time_t> &due : dues) {
+    SimulatedScheduler sim(config, 42);
+    sim.transport.push(reply(200, icon_d2()));
+    sim.transport.set_repeat(true);
+    std::vector<QueryId> ids;
+    for (int i = 0; i < 8; ++i) {
+      OpenMeteoParams params = forecast_params();
+      // Different variables, fetched one by one.
+      params.hourly_set = {synthetic_hourly[i].param};
+      ids.push_back(sim.scheduler.add(params, nullptr));
+    }
+    EXPECT_EQ(sim.scheduler.poll(), 8u);
+    for (const QueryId id : ids) {
+      due.push_back(sim.scheduler.due(id));
+      EXPECT_GE(due.back(), run + three_hours + 900);
+      EXPECT_LE(due.back(), run + three_hours + 900 + 120);
+    }
+  }
+  EXPECT_EQ(dues[0], dues[1]);
+  // Not all the same.
+  EXPECT_NE(*std::min_element(dues[0].begin(), dues[0].end()),
+            *std::max_element(dues[0].begin(), dues[0].end()));
+}
+
+TEST(RefreshScheduler, CallbacksMayRemoveQueries) {
+  SimulatedScheduler sim;
+  sim.transport.push(reply(200, icon_d2()));
+  sim.transport.set_repeat(true);
+  QueryId first = 0;
+  first = sim.scheduler.add(forecast_params(),
+                            [&](int, SharedResponse) {
+                              EXPECT_TRUE(sim.scheduler.remove(first));
+                            });
+  OpenMeteoParams other = forecast_params();
+  other.hourly_set = {precipitation};
+  const QueryId second = sim.scheduler.add(other, sim.record());
+  EXPECT_EQ(sim.scheduler.poll(), 2u);
+  EXPECT_EQ(sim.scheduler.due(first), 0);
+  EXPECT_EQ(sim.scheduler.next_due(), sim.scheduler.due(second));
+  EXPECT_EQ(sim.statuses, std::vector<int>{200});
+}
@@ -0,0 +1,280 @@
+#include "om_snapshot.hpp"
+#include "synthetic_response.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+#include <weather_api_generated.h>
+
+using namespace OM_SDK;
+using namespace openmeteo_sdk;
+
+namespace {
+
+const int64_t start = 1710979200; // 2024-03-21
+
+// Every section, an int64 column, a NaN gap and values finer than their
+// snapshot decimals.
+std::vector<uint8_t> response() {
+  flatbuffers::FlatBufferBuilder builder;
+  const auto current = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_none, 0, {}, {}, 12.34f},
+       {Variable_is_day, 0, Aggregation_none, 0, {}, {}, 1.f}},
+      start + 900, 0, 0);
+  const auto hourly = synthetic_section(
+      builder,
+      {{Variable_temperature,
+        2,
+        Aggregation_none,
+        0,
+        {1.24f, 2.26f, NAN, 4.f, -5.55f, 6.f, 7.f, 8.f}},
+       {Variable_weather_code, 0, Aggregation_none, 0, {0, 1, 2, 3, 61.4f}},
+       {Variable_snow_depth, 0, Aggregation_none, 0, {.123f, .456f}},
+       {Variable_precipitation, 0, Aggregation_none, 0, {1, 1, 1, 1}}},
+      start, start + 8 * 3600, 3600);
+  const auto daily = synthetic_section(
+      builder,
+      {{Variable_temperature, 2, Aggregation_maximum, 0, {14.06f, 16, 18}},
+       {Variable_sunrise,
+        0,
+        Aggregation_none,
+        0,
+        {},
+        {start + 21600, start + 86400 + 21540, INT64_MIN}}},
+      start, start + 3 * 86400, 86400);
+  const auto minutely_15 = synthetic_section(
+      builder,
+      {{Variable_precipitation, 0, Aggregation_none, 0, {0, .25f, .5f, 0}}},
+      start, start + 3600, 900);
+  WeatherApiResponseBuilder result(builder);
+  result.add_latitude(52.5244f);
+  result.add_longitude(-13.4105f);
+  result.add_elevation(38.f);
+  result.add_utc_offset_seconds(3600);
+  result.add_model(Model_icon_d2);
+  result.add_current(current);
+  result.add_hourly(hourly);
+  result.add_daily(daily);
+  result.add_minutely_15(minutely_15);
+  FinishSizePrefixedWeatherApiResponseBuffer(builder, result.Finish());
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+SnapshotSelection everything() {
+  SnapshotSelection selection;
+  selection.current = {temperature_2m, is_day};
+  selection.hourly = {temperature_2m, weather_code, snow_depth};
+  selection.daily = {temperature_2m_max, sunrise};
+  selection.minutely_15 = {precipitation};
+  return selection;
+}
+
+std::vector<uint8_t> encode(const SnapshotSelection &selection) {
+  const std::vector<uint8_t> body = response();
+  std::vector<uint8_t> blob(1024);
+  const size_t size = EncodeSnapshot(
+      GetSizePrefixedWeatherApiResponse(body.data()), selection, blob.data(),
+      blob.size());
+  blob.resize(size);
+  return blob;
+}
+
+template <typename T> std::vector<T> to_vector(Span<T> span) {
+  return std::vector<T>(span.begin(), span.end());
+}
+
+void varint(std::vector<uint8_t> *blob, uint64_t value) {
+  while (value >= 0x80) {
+    blob->push_back((uint8_t)value | 0x80);
+    value >>= 7;
+  }
+  blob->push_back((uint8_t)value);
+}
+
+// A snapshot header with only the hourly section, which starts at 0 every
+// hour with `steps` steps and `variables` variables.
+std::vector<uint8_t> hourly_header(uint64_t steps, uint64_t variables) {
+  std::vector<uint8_t> blob = {'O', 'S', 1, 0, 0, 0, 0, Model_undefined, 0x2};
+  varint(&blob, 0);
+  varint(&blob, 3600);
+  varint(&blob, steps);
+  varint(&blob, variables);
+  return blob;
+}
+
+} // namespace
+
+TEST(Snapshot, RoundTripsEverySection) {
+  const std::vector<uint8_t> blob = encode(everything());
+  ASSERT_GT(blob.size(), 0u);
+  Snapshot snapshot;
+  ASSERT_TRUE(snapshot.decode(blob.data(), blob.size()));
+  EXPECT_NEAR(snapshot.latitude(), 52.5244f, 1e-4f);
+  EXPECT_NEAR(snapshot.longitude(), -13.4105f, 1e-4f);
+  EXPECT_FLOAT_EQ(snapshot.elevation(), 38.f);
+  EXPECT_EQ(snapshot.utc_offset_seconds(), 3600);
+  EXPECT_EQ(snapshot.model(), Model_icon_d2);
+
+  EXPECT_FLOAT_EQ(snapshot.current().value(temperature_2m), 12.3f);
+  EXPECT_FLOAT_EQ(snapshot.current().value(is_day), 1.f);
+  EXPECT_EQ(snapshot.current().time().size(), 1u);
+  EXPECT_EQ(snapshot.current().time()[0], start + 900);
+
+  const SnapshotSection &hourly = snapshot.hourly();
+  EXPECT_EQ(hourly.time().size(), 8u);
+  EXPECT_EQ(hourly.time().interval(), 3600);
+  EXPECT_EQ(hourly.time()[0], start);
+  const std::vector<float> temperature =
+      to_vector(hourly.values(temperature_2m));
+  ASSERT_EQ(temperature.size(), 8u);
+  EXPECT_FLOAT_EQ(temperature[0], 1.2f);
+  EXPECT_FLOAT_EQ(temperature[1], 2.3f);
+  EXPECT_TRUE(std::isnan(temperature[2]));
+  EXPECT_FLOAT_EQ(temperature[3], 4.f);
+  EXPECT_FLOAT_EQ(temperature[4], -5.6f);
+  EXPECT_FLOAT_EQ(temperature[7], 8.f);
+  // Shorter columns are padded with gaps.
+  const std::vector<float> codes = to_vector(hourly.values(weather_code));
+  ASSERT_EQ(codes.size(), 8u);
+  EXPECT_FLOAT_EQ(codes[4], 61.f);
+  EXPECT_TRUE(std::isnan(codes[5]));
+  const std::vector<float> snow = to_vector(hourly.values(snow_depth));
+  EXPECT_FLOAT_EQ(snow[0], .12f);
+  EXPECT_FLOAT_EQ(snow[1], .46f);
+  // In the response, not in the selection.
+  EXPECT_FALSE(hourly.has(precipitation));
+  EXPECT_TRUE(hourly.values(precipitation).empty());
+
+  const SnapshotSection &daily = snapshot.daily();
+  EXPECT_EQ(to_vector(daily.values(temperature_2m_max)),
+            (std::vector<float>{14.1f, 16, 18}));
+  EXPECT_EQ(to_vector(daily.values_int64(sunrise)),
+            (std::vector<int64_t>{start + 21600, start + 86400 + 21540,
+                                  INT64_MIN}));
+  EXPECT_TRUE(daily.values(sunrise).empty());
+  EXPECT_TRUE(daily.values_int64(temperature_2m_max).empty());
+
+  EXPECT_EQ(to_vector(snapshot.minutely_15().values(precipitation)),
+            (std::vector<float>{0, .3f, .5f, 0}));
+  EXPECT_EQ(snapshot.minutely_15().time().interval(), 900);
+}
+
+TEST(Snapshot, QuantizesBySnapshotDecimals) {
+  EXPECT_EQ(SnapshotDecimals(temperature_2m), 1);
+  EXPECT_EQ(SnapshotDecimals(weather_code), 0);
+  EXPECT_EQ(SnapshotDecimals(cloud_cover), 0);
+  EXPECT_EQ(SnapshotDecimals(snow_depth), 2);
+  EXPECT_EQ(SnapshotDecimals(soil_moisture_0_to_1cm), 3);
+}
+
+TEST(Snapshot, SelectsSteps) {
+  SnapshotSelection selection = everything();
+  selection.stride = 2;
+  selection.from = start + 1;
+  selection.max_steps = 2;
+  const std::vector<uint8_t> blob = encode(selection);
+  Snapshot snapshot;
+  ASSERT_TRUE(snapshot.decode(blob.data(), blob.size()));
+
+  // From the second hour, every other one, two of them.
+  const SnapshotSection &hourly = snapshot.hourly();
+  EXPECT_EQ(hourly.time().size(), 2u);
+  EXPECT_EQ(hourly.time()[0], start + 3600);
+  EXPECT_EQ(hourly.time().interval(), 7200);
+  EXPECT_EQ(to_vector(hourly.values(temperature_2m)),
+            (std::vector<float>{2.3f, 4.f}));
+  // Daily is cut but not downsampled.
+  const SnapshotSection &daily = snapshot.daily();
+  EXPECT_EQ(daily.time()[0], start + 86400);
+  EXPECT_EQ(daily.time().interval(), 86400);
+  EXPECT_EQ(to_vector(daily.values(temperature_2m_max)),
+            (std::vector<float>{16, 18}));
+  EXPECT_EQ(to_vector(snapshot.minutely_15().values(precipitation)),
+            (std::vector<float>{.3f, 0}));
+  // Current keeps its one value.
+  EXPECT_FLOAT_EQ(snapshot.current().value(temperature_2m), 12.3f);
+
+  // Sections without a selected variable are left out.
+  selection = SnapshotSelection();
+  selection.hourly = {rain, temperature_2m};
+  const std::vector<uint8_t> hourly_only = encode(selection);
+  ASSERT_TRUE(snapshot.decode(hourly_only.data(), hourly_only.size()));
+  EXPECT_TRUE(snapshot.hourly().has(temperature_2m));
+  EXPECT_FALSE(snapshot.hourly().has(rain));
+  EXPECT_EQ(snapshot.current().time().size(), 0u);
+  EXPECT_EQ(snapshot.daily().time().size(), 0u);
+  EXPECT_FALSE(snapshot.current().has(temperature_2m));
+}
+
+TEST(Snapshot, EncodeNeedsTheWholeCapacity) {
+  const std::vector<uint8_t> body = response();
+  const auto *api = GetSizePrefixedWeatherApiResponse(body.data());
+  const size_t size = encode(everything()).size();
+  std::vector<uint8_t> blob(size);
+  EXPECT_EQ(EncodeSnapshot(api, everything(), blob.data(), size - 1), 0u);
+  EXPECT_EQ(EncodeSnapshot(api, everything(), blob.data(), size), size);
+  EXPECT_EQ(EncodeSnapshot(nullptr, everything(), blob.data(), size), 0u);
+}
+
+TEST(Snapshot, RejectsTruncatedBlobs) {
+  const std::vector<uint8_t> blob = encode(everything());
+  Snapshot snapshot;
+  for (size_t size = 0; size < blob.size(); ++size) {
+    ASSERT_TRUE(snapshot.decode(blob.data(), blob.size()));
+    EXPECT_FALSE(snapshot.decode(blob.data(), size)) << size;
+    // Left empty.
+    EXPECT_FALSE(snapshot.hourly().has(temperature_2m)) << size;
+    EXPECT_EQ(snapshot.model(), Model_undefined) << size;
+  }
+}
+
+TEST(Snapshot, RejectsBadHeaders) {
+  std::vector<uint8_t> blob = encode(everything());
+  Snapshot snapshot;
+  blob[0] = 'X';
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+  blob[0] = 'O';
+  blob[2] = 2;
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+
+  // Sections past minutely_15.
+  blob = hourly_header(0, 1);
+  blob[8] = 0x12;
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+}
+
+TEST(Snapshot, RejectsDuplicateParams) {
+  std::vector<uint8_t> blob = hourly_header(1, 2);
+  for (int i = 0; i < 2; ++i) {
+    blob.push_back(temperature_2m);
+    blob.push_back(1);
+    blob.push_back(0);
+  }
+  Snapshot snapshot;
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+  blob[blob.size() - 3] = precipitation;
+  EXPECT_TRUE(snapshot.decode(blob.data(), blob.size()));
+  EXPECT_TRUE(snapshot.hourly().has(precipitation));
+}
+
+TEST(Snapshot, RejectsStepCountsLargerThanTheBlob) {
+  // A step takes at least a byte per variable.
+  std::vector<uint8_t> blob = hourly_header(1000000, 1);
+  blob.push_back(temperature_2m);
+  blob.push_back(1);
+  blob.insert(blob.end(), 64, 0);
+  Snapshot snapshot;
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+
+  blob = hourly_header(UINT64_MAX, 2);
+  blob.insert(blob.end(), 64, 0);
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+
+  // No variables, or more than there are params.
+  blob = hourly_header(1, 0);
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+  blob = hourly_header(1, max_params);
+  blob.insert(blob.end(), 3 * max_params, 0);
+  EXPECT_FALSE(snapshot.decode(blob.data(), blob.size()));
+}
@@ -0,0 +1,182 @@
+#include "om_response.hpp"
+#include "om_store.hpp"
+#include "synthetic_response.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+const uint64_t key = 0x0123456789abcdefull;
+const time_t fetched = 1700000000;
+
+// A store in a fresh directory, removed with its files afterwards.
+class ForecastStoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    char directory[] = "/tmp/om_store_testXXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    _directory = directory;
+    backend.reset(new StdioFileBackend(_directory.c_str()));
+    store.reset(new ForecastStore(backend.get(), 3600));
+    body = synthetic_response(4096);
+    saved.reserve(body.size());
+    memcpy(saved.tail(), body.data(), body.size());
+    saved.commit(body.size());
+  }
+
+  void TearDown() override {
+    for (const char *suffix : {"", ".tmp"})
+      ::remove(path(suffix).c_str());
+    rmdir(_directory.c_str());
+  }
+
+  std::string path(const char *suffix = "") const {
+    return _directory + "/0123456789abcdef.omf" + suffix;
+  }
+
+  std::vector<uint8_t> read_file(const std::string &file) const {
+    std::vector<uint8_t> data;
+    FILE *f = fopen(file.c_str(), "rb");
+    if (!f)
+      return data;
+    uint8_t buffer[1024];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+      data.insert(data.end(), buffer, buffer + read);
+    fclose(f);
+    return data;
+  }
+
+  void write_file(const std::string &file, const std::vector<uint8_t> &data) {
+    FILE *f = fopen(file.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    ASSERT_EQ(fwrite(data.data(), 1, data.size(), f), data.size());
+    fclose(f);
+  }
+
+  // Loads `key` and checks it fails without leaving a response behind.
+  void expect_load_fails(const char *what) {
+    WeatherResponse loaded;
+    EXPECT_FALSE(store->load(key, fetched, &loaded, nullptr, true)) << what;
+    EXPECT_FALSE(loaded) << what;
+    EXPECT_EQ(loaded.size(), 0u) << what;
+  }
+
+  std::unique_ptr<StdioFileBackend> backend;
+  std::unique_ptr<ForecastStore> store;
+  std::vector<uint8_t> body;
+  WeatherResponse saved;
+
+private:
+  std::string _directory;
+};
+
+} // namespace
+
+TEST_F(ForecastStoreTest, LoadsWhatWasSaved) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  WeatherResponse loaded;
+  StoredForecastInfo info = {};
+  ASSERT_TRUE(store->load(key, fetched + 60, &loaded, &info));
+  ASSERT_EQ(loaded.size(), body.size());
+  EXPECT_EQ(memcmp(loaded.data(), body.data(), body.size()), 0);
+  EXPECT_EQ(info.key, key);
+  EXPECT_EQ(info.fetched, fetched);
+  EXPECT_GT(info.expires, fetched);
+  // Expired ones only when asked for.
+  EXPECT_FALSE(store->load(key, info.expires, &loaded));
+  EXPECT_TRUE(store->load(key, info.expires, &loaded, nullptr, true));
+  EXPECT_FALSE(store->load(key + 1, fetched, &loaded, nullptr, true));
+}
+
+TEST_F(ForecastStoreTest, RejectsABadCrc) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  const std::vector<uint8_t> file = read_file(path());
+  ASSERT_GT(file.size(), body.size());
+  const size_t header = file.size() - body.size();
+  // Every byte of the body, a bit each.
+  for (size_t at = header; at < file.size(); at += 97) {
+    std::vector<uint8_t> corrupt = file;
+    corrupt[at] ^= 1 << (at % 8);
+    write_file(path(), corrupt);
+    expect_load_fails("flipped body byte");
+  }
+  // The stored crc itself.
+  std::vector<uint8_t> corrupt = file;
+  corrupt[header - 1] ^= 0x80;
+  write_file(path(), corrupt);
+  expect_load_fails("flipped crc");
+}
+
+TEST_F(ForecastStoreTest, RejectsAForeignHeader) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  const std::vector<uint8_t> file = read_file(path());
+  std::vector<uint8_t> corrupt = file;
+  corrupt[0] ^= 0xff; // magic
+  write_file(path(), corrupt);
+  expect_load_fails("magic");
+  corrupt = file;
+  corrupt[4] += 1; // version
+  write_file(path(), corrupt);
+  expect_load_fails("version");
+  corrupt = file;
+  corrupt[8] ^= 0x01; // key
+  write_file(path(), corrupt);
+  expect_load_fails("key");
+}
+
+TEST_F(ForecastStoreTest, RejectsShortFiles) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  const std::vector<uint8_t> file = read_file(path());
+  const size_t header = file.size() - body.size();
+  for (const size_t kept : {size_t(0), size_t(1), header / 2, header - 1,
+                            header, header + 4, header + body.size() / 2,
+                            file.size() - 1}) {
+    write_file(path(), std::vector<uint8_t>(file.begin(), file.begin() + kept));
+    expect_load_fails(std::to_string(kept).c_str());
+  }
+  // Nothing there at all.
+  ::remove(path().c_str());
+  expect_load_fails("missing");
+}
+
+// A write cut off before the rename leaves a partial temporary file: the
+// last complete forecast is still the one loaded, and the next save
+// replaces both.
+TEST_F(ForecastStoreTest, IgnoresAHalfWrittenTemporaryFile) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  const std::vector<uint8_t> file = read_file(path());
+  const std::vector<uint8_t> half(file.begin(), file.begin() + file.size() / 2);
+  write_file(path(".tmp"), half);
+  WeatherResponse loaded;
+  ASSERT_TRUE(store->load(key, fetched, &loaded));
+  EXPECT_EQ(loaded.size(), body.size());
+
+  const std::vector<uint8_t> newer = synthetic_response(2048, 99);
+  WeatherResponse update;
+  update.reserve(newer.size());
+  memcpy(update.tail(), newer.data(), newer.size());
+  update.commit(newer.size());
+  ASSERT_TRUE(store->save(key, update, fetched + 600));
+  EXPECT_TRUE(read_file(path(".tmp")).empty());
+  ASSERT_TRUE(store->load(key, fetched + 600, &loaded));
+  ASSERT_EQ(loaded.size(), newer.size());
+  EXPECT_EQ(memcmp(loaded.data(), newer.data(), newer.size()), 0);
+}
+
+// Only a temporary file, the first save never completed.
+TEST_F(ForecastStoreTest, DoesNotLoadAnUnfinishedFirstSave) {
+  ASSERT_TRUE(store->save(key, saved, fetched));
+  const std::vector<uint8_t> file = read_file(path());
+  ASSERT_TRUE(store->remove(key));
+  write_file(path(".tmp"), file);
+  expect_load_fails("tmp only");
+}
@@ -0,0 +1,204 @@
+#include "om_client.hpp"
+#include "om_trace.hpp"
+#include "om_transport.hpp"
+#include "open_meteo.hpp"
+#include "synthetic_response.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace OM_SDK;
+
+namespace {
+
+// A fetched request through every phase, `us` apart.
+RequestTrace fetched(int64_t us) {
+  RequestTrace trace = {};
+  trace.start_us = 1000;
+  trace.connected_us = trace.start_us + us;
+  trace.sent_us = trace.connected_us + us;
+  trace.headers_us = trace.sent_us + us;
+  trace.body_us = trace.headers_us + us;
+  trace.end_us = trace.body_us + us;
+  trace.decode_us = us / 2;
+  trace.body_bytes = 4096;
+  trace.attempts = 1;
+  trace.outcome = outcome_fetched;
+  trace.status_code = 200;
+  return trace;
+}
+
+} // namespace
+
+TEST(LatencyHistogram, KeepsSmallValuesExact) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0);
+  EXPECT_EQ(histogram.count(), 0u);
+  for (int64_t value : {3, 3, 5, 7, -4})
+    histogram.add(value);
+  EXPECT_EQ(histogram.count(), 5u);
+  EXPECT_EQ(histogram.max(), 7);
+  // Negative values count as 0.
+  EXPECT_EQ(histogram.percentile(0), 0);
+  EXPECT_EQ(histogram.percentile(20), 0);
+  EXPECT_EQ(histogram.percentile(50), 3);
+  EXPECT_EQ(histogram.percentile(80), 5);
+  EXPECT_EQ(histogram.percentile(100), 7);
+  histogram.clear();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.percentile(99), 0);
+}
+
+TEST(LatencyHistogram, PercentilesAreWithinAQuarter) {
+  LatencyHistogram histogram;
+  std::vector<int64_t> values;
+  uint32_t random = 2024;
+  for (int i = 0; i < 10000; ++i) {
+    random = random * 1664525 + 1013904223;
+    // Log-uniform from 1 us to about 17 minutes.
+    const int64_t value = (int64_t)std::exp((random >> 8) / 16777216. * 21.);
+    values.push_back(value);
+    histogram.add(value);
+  }
+  std::sort(values.begin(), values.end());
+  for (double percent : {1., 25., 50., 90., 99., 99.9}) {
+    const int64_t exact =
+        values[(size_t)std::ceil(percent / 100 * values.size()) - 1];
+    const int64_t estimate = histogram.percentile(percent);
+    EXPECT_GE(estimate, exact) << percent;
+    EXPECT_LE(estimate, exact + exact / 4) << percent;
+  }
+  // Never past the largest value.
+  EXPECT_EQ(histogram.percentile(100), values.back());
+  EXPECT_EQ(histogram.max(), values.back());
+}
+
+TEST(LatencyHistogram, HoldsTheWholeRange) {
+  LatencyHistogram histogram;
+  histogram.add(INT64_MAX);
+  histogram.add(INT64_MAX / 3);
+  EXPECT_EQ(histogram.percentile(100), INT64_MAX);
+  EXPECT_GE(histogram.percentile(50), INT64_MAX / 3);
+}
+
+TEST(TraceRecorder, RecordsPhases) {
+  TraceRecorder recorder;
+  recorder.on_request(fetched(100));
+  recorder.on_request(fetched(300));
+  TraceRecorder::Stats stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 2u);
+  EXPECT_EQ(stats.failures, 0u);
+  EXPECT_EQ(stats.connect.count(), 2u);
+  EXPECT_EQ(stats.connect.max(), 300);
+  EXPECT_EQ(stats.first_byte.max(), 300);
+  EXPECT_EQ(stats.transfer.max(), 300);
+  EXPECT_EQ(stats.decode.max(), 150);
+  EXPECT_EQ(stats.total.max(), 1500);
+  EXPECT_GE(stats.total.percentile(50), 500);
+  EXPECT_LT(stats.total.percentile(50), 1500);
+  EXPECT_EQ(stats.body_bytes, 8192u);
+
+  // A reused connection, retried once, that failed before the body.
+  RequestTrace failed = fetched(100);
+  failed.connected_us = 0;
+  failed.body_us = 0;
+  failed.attempts = 2;
+  failed.outcome = outcome_failed;
+  failed.status_code = -1;
+  recorder.on_request(failed);
+  stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 3u);
+  EXPECT_EQ(stats.failures, 1u);
+  EXPECT_EQ(stats.reconnects, 1u);
+  EXPECT_EQ(stats.connect.count(), 2u);
+  EXPECT_EQ(stats.first_byte.count(), 3u);
+  EXPECT_EQ(stats.transfer.count(), 2u);
+  EXPECT_EQ(stats.total.count(), 3u);
+
+  recorder.clear();
+  stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 0u);
+  EXPECT_EQ(stats.total.count(), 0u);
+  EXPECT_EQ(stats.body_bytes, 0u);
+}
+
+TEST(TraceRecorder, CountsLocalHitsWithoutPhases) {
+  TraceRecorder recorder;
+  for (RequestOutcome outcome : {outcome_cache_hit, outcome_store_hit,
+                                 outcome_coalesced, outcome_stale}) {
+    RequestTrace trace = {};
+    trace.start_us = 1000;
+    trace.end_us = 1040;
+    trace.body_bytes = 4096;
+    trace.outcome = outcome;
+    recorder.on_request(trace);
+  }
+  const TraceRecorder::Stats stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 4u);
+  EXPECT_EQ(stats.served_locally, 4u);
+  EXPECT_EQ(stats.total.count(), 4u);
+  EXPECT_EQ(stats.total.max(), 40);
+  EXPECT_EQ(stats.first_byte.count(), 0u);
+  EXPECT_EQ(stats.body_bytes, 0u);
+}
+
+TEST(TraceRecorder, ObservesFromSeveralThreads) {
+  TraceRecorder recorder;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&recorder, t] {
+      for (int i = 0; i < 1000; ++i)
+        recorder.on_request(fetched(10 + t));
+    });
+  for (std::thread &thread : threads)
+    thread.join();
+  const TraceRecorder::Stats stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 4000u);
+  EXPECT_EQ(stats.total.count(), 4000u);
+  EXPECT_EQ(stats.body_bytes, 4000u * 4096);
+  EXPECT_EQ(stats.connect.max(), 13);
+}
+
+#if CONFIG_OPEN_METEO_INSTRUMENTATION
+TEST(TraceRecorder, ObservesClients) {
+  const std::vector<uint8_t> body = synthetic_response(8192);
+  ReplayTransport transport;
+  ReplayTransport::Response response;
+  response.status_code = 200;
+  response.body = body;
+  transport.push(response);
+  response.status_code = 500;
+  response.body.clear();
+  transport.push(response);
+
+  TraceRecorder recorder;
+  Client client(&transport);
+  client.set_observer(&recorder);
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = 13.41f;
+  params.hourly_set = {temperature_2m};
+  WeatherResponse output;
+  ASSERT_EQ(client.get_weather(&params, &output), 200);
+  const RequestTrace &trace = client.last_trace();
+  EXPECT_EQ(trace.outcome, outcome_fetched);
+  EXPECT_EQ(trace.status_code, 200);
+  EXPECT_EQ(trace.body_bytes, body.size());
+  EXPECT_EQ(trace.attempts, 1);
+  EXPECT_GT(trace.start_us, 0);
+  EXPECT_GE(trace.sent_us, trace.start_us);
+  EXPECT_GE(trace.headers_us, trace.sent_us);
+  EXPECT_GE(trace.body_us, trace.headers_us);
+  EXPECT_GE(trace.end_us, trace.body_us);
+
+  EXPECT_NE(client.get_weather(&params, &output), 200);
+  EXPECT_EQ(client.last_trace().outcome, outcome_failed);
+  const TraceRecorder::Stats stats = recorder.stats();
+  EXPECT_EQ(stats.requests, 2u);
+  EXPECT_EQ(stats.failures, 1u);
+  EXPECT_EQ(stats.body_bytes, body.size());
+}
+#endif
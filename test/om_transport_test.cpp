@@ -0,0 +1,95 @@
+#include "om_client.hpp"
+#include "om_endpoint.hpp"
+#include "open_meteo.hpp"
+#include "stand_in_server.hpp"
+#include "synthetic_response.hpp"
+#include <gtest/gtest.h>
+
+using namespace OM_SDK;
+
+namespace {
+
+OpenMeteoParams forecast_params() {
+  OpenMeteoParams params = {};
+  params.latitude = 52.52f;
+  params.longitude = 13.41f;
+  params.hourly_set = {temperature_2m};
+  return params;
+}
+
+} // namespace
+
+TEST(HostTransport, RefusesThePublicApiWithoutBaseUrl) {
+  Client client;
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  EXPECT_EQ(client.get_weather(&params, &response), -1);
+  EXPECT_FALSE(response);
+  EXPECT_EQ(client.connections_opened(), 0u);
+}
+
+TEST(HostTransport, EndpointsKeepHttps) {
+  for (const Endpoint *endpoint :
+       {&forecast_endpoint, &air_quality_endpoint, &marine_endpoint,
+        &archive_endpoint, &ensemble_endpoint})
+    EXPECT_STREQ(std::string(endpoint->host).substr(0, 8).c_str(), "https://")
+        << endpoint->host;
+}
+
+TEST(HostTransport, FetchesFromBaseUrl) {
+  const std::vector<uint8_t> body = synthetic_response(4096);
+  StandInServer server(body, 0);
+  ASSERT_NE(server.start(), 0);
+  const std::string base_url = server.base_url();
+  Client client;
+  client.set_base_url(base_url.c_str());
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  ASSERT_EQ(client.get_weather(&params, &response), 200);
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.size(), body.size());
+  EXPECT_EQ(memcmp(response.data(), body.data(), body.size()), 0);
+  EXPECT_FLOAT_EQ(response->latitude(), 52.52f);
+}
+
+TEST(HostTransport, KeepsOneConnectionAcrossRequests) {
+  const std::vector<uint8_t> body = synthetic_response(4096);
+  StandInServer server(body, 0);
+  ASSERT_NE(server.start(), 0);
+  const std::string base_url = server.base_url();
+  Client client;
+  client.set_base_url(base_url.c_str());
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(client.get_weather(&params, &response), 200) << i;
+    EXPECT_EQ(response.size(), body.size()) << i;
+  }
+  EXPECT_EQ(server.requests(), 20u);
+  EXPECT_EQ(server.connections_opened(), 1u);
+  EXPECT_EQ(client.connections_opened(), 1u);
+  EXPECT_EQ(client.requests(), 20u);
+}
+
+TEST(HostTransport, ReconnectsAfterConnectionClose) {
+  const std::vector<uint8_t> body = synthetic_response(1024);
+  size_t replies = 0;
+  // Every third reply closes the connection.
+  StandInServer server([&](const StandInRequest &) {
+    StandInReply reply;
+    reply.body.assign(body.begin(), body.end());
+    reply.close = ++replies % 3 == 0;
+    return reply;
+  });
+  ASSERT_NE(server.start(), 0);
+  const std::string base_url = server.base_url();
+  Client client;
+  client.set_base_url(base_url.c_str());
+  OpenMeteoParams params = forecast_params();
+  WeatherResponse response;
+  for (int i = 0; i < 9; ++i)
+    ASSERT_EQ(client.get_weather(&params, &response), 200) << i;
+  EXPECT_EQ(server.requests(), 9u);
+  EXPECT_EQ(server.connections_opened(), 3u);
+  EXPECT_EQ(client.connections_opened(), 3u);
+}
@@ -0,0 +1,205 @@
+#pragma once
+// Local stand-in for the API, shared by the tests and the benchmarks: a
+// loopback HTTP/1.1 server keeping connections alive, one thread per
+// connection.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace OM_SDK {
+
+struct StandInRequest {
+  std::string path;
+  std::vector<std::pair<std::string, std::string>> headers;
+
+  // Value of header `key`, empty when not sent.
+  std::string header(const char *key) const {
+    for (const auto &header : headers) {
+      if (!strcasecmp(header.first.c_str(), key))
+        return header.second;
+    }
+    return std::string();
+  }
+};
+
+struct StandInReply {
+  int status_code{200};
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+  // Closes the connection after the reply.
+  bool close{false};
+};
+
+class StandInServer {
+public:
+  // Called from the connection threads, at the same time for concurrent
+  // requests.
+  typedef std::function<StandInReply(const StandInRequest &request)> Handler;
+
+  explicit StandInServer(Handler handler, int latency_ms = 0)
+      : _handler(std::move(handler)), _latency_ms(latency_ms) {}
+  // Answers every GET with `body` after `latency_ms`.
+  StandInServer(const std::vector<uint8_t> &body, int latency_ms)
+      : _latency_ms(latency_ms) {
+    StandInReply reply;
+    reply.headers.emplace_back("Content-Type", "application/octet-stream");
+    reply.body.assign(body.begin(), body.end());
+    _handler = [reply](const StandInRequest &) { return reply; };
+  }
+  ~StandInServer() { stop(); }
+  StandInServer(const StandInServer &) = delete;
+  StandInServer &operator=(const StandInServer &) = delete;
+
+  // Listens on a free loopback port and returns it, 0 on failure.
+  int start() {
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0)
+      return 0;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(address);
+    if (bind(_fd, (sockaddr *)&address, sizeof(address)) ||
+        listen(_fd, 64) || getsockname(_fd, (sockaddr *)&address, &size)) {
+      ::close(_fd);
+      _fd = -1;
+      return 0;
+    }
+    _port = ntohs(address.sin_port);
+    _acceptor = std::thread(&StandInServer::accept_loop, this);
+    return _port;
+  }
+
+  void stop() {
+    if (_fd < 0)
+      return;
+    shutdown(_fd, SHUT_RDWR);
+    _acceptor.join();
+    ::close(_fd);
+    _fd = -1;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int connection : _connections)
+      shutdown(connection, SHUT_RDWR);
+    for (std::thread &thread : _threads)
+      thread.join();
+    for (int connection : _connections)
+      ::close(connection);
+    _threads.clear();
+    _connections.clear();
+  }
+
+  std::string base_url() const {
+    return "http://127.0.0.1:" + std::to_string(_port);
+  }
+  size_t connections_opened() const { return _opened; }
+  size_t requests() const { return _requests; }
+
+private:
+  void accept_loop() {
+    while (true) {
+      const int connection = accept(_fd, nullptr, nullptr);
+      if (connection < 0)
+        return;
+      ++_opened;
+      std::lock_guard<std::mutex> lock(_mutex);
+      _connections.push_back(connection);
+      _threads.emplace_back(&StandInServer::serve, this, connection);
+    }
+  }
+
+  static bool send_all(int fd, const void *data, size_t size) {
+    for (size_t sent = 0; sent < size;) {
+      const ssize_t n =
+          send(fd, (const char *)data + sent, size - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        return false;
+      sent += n;
+    }
+    return true;
+  }
+
+  static StandInRequest parse(const std::string &head) {
+    StandInRequest request;
+    size_t line_end = head.find("\r\n");
+    const std::string line = head.substr(0, line_end);
+    const size_t path = line.find(' ');
+    if (path != std::string::npos)
+      request.path = line.substr(path + 1, line.rfind(' ') - path - 1);
+    while (line_end != std::string::npos && line_end + 2 < head.size()) {
+      const size_t start = line_end + 2;
+      line_end = head.find("\r\n", start);
+      const std::string header = head.substr(start, line_end - start);
+      const size_t colon = header.find(':');
+      if (colon == std::string::npos)
+        continue;
+      size_t value = colon + 1;
+      while (value < header.size() && header[value] == ' ')
+        ++value;
+      request.headers.emplace_back(header.substr(0, colon),
+                                   header.substr(value));
+    }
+    return request;
+  }
+
+  void serve(int fd) {
+    std::string buffered;
+    char buffer[4096];
+    while (true) {
+      size_t end;
+      while ((end = buffered.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+          return;
+        buffered.append(buffer, n);
+      }
+      const StandInRequest request = parse(buffered.substr(0, end + 2));
+      buffered.erase(0, end + 4);
+      ++_requests;
+      if (_latency_ms)
+        std::this_thread::sleep_for(std::chrono::milliseconds(_latency_ms));
+      const StandInReply reply = _handler(request);
+      // One send per response, or Nagle holds the body back.
+      std::string response =
+          "HTTP/1.1 " + std::to_string(reply.status_code) + " Stand-in\r\n";
+      for (const auto &header : reply.headers)
+        response += header.first + ": " + header.second + "\r\n";
+      if (reply.status_code != 304)
+        response += "Content-Length: " + std::to_string(reply.body.size()) +
+                    "\r\n";
+      if (reply.close)
+        response += "Connection: close\r\n";
+      response += "\r\n";
+      if (reply.status_code != 304)
+        response += reply.body;
+      if (!send_all(fd, response.data(), response.size()))
+        return;
+      if (reply.close) {
+        shutdown(fd, SHUT_RDWR);
+        return;
+      }
+    }
+  }
+
+  Handler _handler;
+  const int _latency_ms;
+  int _fd{-1};
+  int _port{0};
+  std::atomic<size_t> _opened{0};
+  std::atomic<size_t> _requests{0};
+  std::thread _acceptor;
+  std::mutex _mutex;
+  std::vector<int> _connections;
+  std::vector<std::thread> _threads;
+};
+
+} // namespace OM_SDK
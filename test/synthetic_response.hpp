@@ -0,0 +1,177 @@
+#pragma once
+// Size-prefixed API responses built with the flatbuffers builders, shared
+// by the tests and the benchmarks.
+#include "open_meteo.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <weather_api_generated.h>
+
+namespace OM_SDK {
+
+struct SyntheticSeries {
+  openmeteo_sdk::Variable variable;
+  int16_t altitude;
+  TimeParam param;
+};
+
+// The hourly variables of the synthetic responses.
+const SyntheticSeries synthetic_hourly[] = {
+    {openmeteo_sdk::Variable_temperature, 2, temperature_2m},
+    {openmeteo_sdk::Variable_relative_humidity, 2, relative_humidity_2m},
+    {openmeteo_sdk::Variable_dew_point, 2, dew_point_2m},
+    {openmeteo_sdk::Variable_apparent_temperature, 0, apparent_temperature},
+    {openmeteo_sdk::Variable_precipitation, 0, precipitation},
+    {openmeteo_sdk::Variable_rain, 0, rain},
+    {openmeteo_sdk::Variable_showers, 0, showers},
+    {openmeteo_sdk::Variable_snowfall, 0, snowfall},
+    {openmeteo_sdk::Variable_weather_code, 0, weather_code},
+    {openmeteo_sdk::Variable_pressure_msl, 0, pressure_msl},
+    {openmeteo_sdk::Variable_surface_pressure, 0, surface_pressure},
+    {openmeteo_sdk::Variable_cloud_cover, 0, cloud_cover},
+    {openmeteo_sdk::Variable_visibility, 0, visibility},
+    {openmeteo_sdk::Variable_wind_speed, 10, wind_speed_10m},
+    {openmeteo_sdk::Variable_wind_direction, 10, wind_direction_10m},
+    {openmeteo_sdk::Variable_wind_gusts, 10, wind_gusts_10m},
+};
+
+// A response whose hourly section holds about `bytes` of values drifting
+// like weather, a few of them missing. `seed` varies the values,
+// `latitude`/`longitude` the place and `model` the one reported.
+inline std::vector<uint8_t> synthetic_response(
+    size_t bytes, uint32_t seed = 12345, float latitude = 52.52f,
+    float longitude = 13.41f,
+    openmeteo_sdk::Model model = openmeteo_sdk::Model_best_match) {
+  const size_t variables =
+      sizeof(synthetic_hourly) / sizeof(synthetic_hourly[0]);
+  size_t hours = bytes / (variables * sizeof(float));
+  if (hours < 1)
+    hours = 1;
+  flatbuffers::FlatBufferBuilder builder(bytes + 1024);
+  std::vector<flatbuffers::Offset<openmeteo_sdk::VariableWithValues>> series;
+  std::vector<float> values(hours);
+  uint32_t random = seed;
+  for (size_t v = 0; v < variables; ++v) {
+    float level = 10.f * v;
+    for (size_t h = 0; h < hours; ++h) {
+      random = random * 1664525 + 1013904223;
+      level += (float(random >> 16) / 65536.f - 0.5f) * 0.8f;
+      values[h] = random % 97 == 0 ? NAN : level;
+    }
+    const auto data = builder.CreateVector(values);
+    openmeteo_sdk::VariableWithValuesBuilder variable(builder);
+    variable.add_variable(synthetic_hourly[v].variable);
+    variable.add_altitude(synthetic_hourly[v].altitude);
+    variable.add_values(data);
+    series.push_back(variable.Finish());
+  }
+  const auto list = builder.CreateVector(series);
+  openmeteo_sdk::VariablesWithTimeBuilder hourly(builder);
+  hourly.add_time(1700000000);
+  hourly.add_time_end(1700000000 + int64_t(hours) * 3600);
+  hourly.add_interval(3600);
+  hourly.add_variables(list);
+  const auto section = hourly.Finish();
+  openmeteo_sdk::WeatherApiResponseBuilder response(builder);
+  response.add_latitude(latitude);
+  response.add_longitude(longitude);
+  response.add_model(model);
+  response.add_hourly(section);
+  openmeteo_sdk::FinishSizePrefixedWeatherApiResponseBuffer(builder,
+                                                            response.Finish());
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+// One variable of a hand written section: `values` and `values_int64` are
+// left out when empty, `value` is what current sections carry.
+struct SyntheticVariable {
+  openmeteo_sdk::Variable variable;
+  int16_t altitude;
+  openmeteo_sdk::Aggregation aggregation;
+  int16_t member;
+  std::vector<float> values;
+  std::vector<int64_t> values_int64;
+  float value;
+};
+
+// A section of `variables` from `time` to `time_end` every `interval`
+// seconds, to add to a response built with `builder`.
+inline flatbuffers::Offset<openmeteo_sdk::VariablesWithTime>
+synthetic_section(flatbuffers::FlatBufferBuilder &builder,
+                  const std::vector<SyntheticVariable> &variables,
+                  int64_t time, int64_t time_end, int32_t interval) {
+  std::vector<flatbuffers::Offset<openmeteo_sdk::VariableWithValues>> series;
+  for (const SyntheticVariable &v : variables) {
+    const auto values = v.values.empty() ? 0 : builder.CreateVector(v.values);
+    const auto values_int64 =
+        v.values_int64.empty() ? 0 : builder.CreateVector(v.values_int64);
+    openmeteo_sdk::VariableWithValuesBuilder variable(builder);
+    variable.add_variable(v.variable);
+    variable.add_altitude(v.altitude);
+    variable.add_aggregation(v.aggregation);
+    variable.add_ensemble_member(v.member);
+    variable.add_value(v.value);
+    if (!v.values.empty())
+      variable.add_values(values);
+    if (!v.values_int64.empty())
+      variable.add_values_int64(values_int64);
+    series.push_back(variable.Finish());
+  }
+  const auto list = builder.CreateVector(series);
+  openmeteo_sdk::VariablesWithTimeBuilder section(builder);
+  section.add_time(time);
+  section.add_time_end(time_end);
+  section.add_interval(interval);
+  section.add_variables(list);
+  return section.Finish();
+}
+
+// Copies of `body` with flipped bytes, overwritten offsets and truncations,
+// as a flaky link delivers them. Copy i gets mutation i % 4: a few flipped
+// bits, a garbage 32 bit word in the first 64 bytes, a cut, or a cut with
+// the size prefix patched to match.
+inline std::vector<std::vector<uint8_t>>
+mutations(const std::vector<uint8_t> &body, size_t count,
+          uint32_t seed = 0x9e3779b9) {
+  std::vector<std::vector<uint8_t>> output;
+  uint32_t random = seed ? seed : 1;
+  auto next = [&random] {
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return random;
+  };
+  for (size_t i = 0; i < count; ++i) {
+    std::vector<uint8_t> mutated = body;
+    switch (i % 4) {
+    case 0:
+      for (int flips = 1 + next() % 4; flips > 0; --flips)
+        mutated[next() % mutated.size()] ^= 1 << (next() % 8);
+      break;
+    case 1:
+      if (mutated.size() >= 8) {
+        const size_t at = next() % (std::min<size_t>(mutated.size(), 64) - 3);
+        const uint32_t garbage = next();
+        memcpy(mutated.data() + at, &garbage, sizeof(garbage));
+      }
+      break;
+    case 2:
+      mutated.resize(next() % mutated.size());
+      break;
+    default:
+      if (mutated.size() > 8) {
+        mutated.resize(4 + next() % (mutated.size() - 4));
+        const uint32_t size = mutated.size() - 4;
+        memcpy(mutated.data(), &size, sizeof(size));
+      }
+      break;
+    }
+    output.push_back(std::move(mutated));
+  }
+  return output;
+}
+
+} // namespace OM_SDK